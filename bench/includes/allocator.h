@@ -33,18 +33,31 @@
 #include <stdint.h>
 #include <bstrlib.h>
 #include <test_types.h>
+#include <allocator_types.h>
 
 #define LLU_CAST (unsigned long long)
 
 extern void allocator_init(int numVectors);
 extern void allocator_finalize();
 extern size_t allocator_dataTypeLength(DataType type);
+extern int allocator_placementFromString(const char* name);
+extern const char* allocator_placementName(Placement placement);
+extern void allocator_setPlacement(Placement placement);
+extern int allocator_pageTypeFromString(const char* name);
+extern const char* allocator_pageTypeName(PageType pages);
+extern int allocator_chainFromString(const char* name);
+extern const char* allocator_chainName(ChainRandomization random);
+extern void allocator_setChain(int stride, ChainRandomization random);
+extern void allocator_initChain(void* ptr, uint64_t size, int stride, int numThreads);
 extern void allocator_allocateVector(void** ptr,
                 int alignment,
                 uint64_t size,
                 int offset,
                 DataType type,
                 int stride,
-                bstring domain);
+                bstring domain,
+                PageType pages,
+                int numThreads,
+                const int* processorIds);
 
 #endif /*ALLOCATOR_H*/
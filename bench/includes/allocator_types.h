@@ -34,11 +34,45 @@
 #include <stdint.h>
 #include <test_types.h>
 
+typedef enum {
+    PAGES_DEFAULT = 0,
+    PAGES_THP,
+    PAGES_NOTHP,
+    PAGES_HUGE_2MB,
+    PAGES_HUGE_1GB,
+    NUM_PAGETYPES
+} PageType;
+
 typedef struct {
     void* ptr;
     size_t size;
     off_t offset;
     DataType type;
+    PageType pages;
 } allocation;
 
+typedef enum {
+    PLACEMENT_DOMAIN = 0,
+    PLACEMENT_LOCAL,
+    PLACEMENT_INTERLEAVE,
+    PLACEMENT_REMOTE,
+    NUM_PLACEMENTS
+} Placement;
+
+typedef enum {
+    CHAIN_LINE = 0,
+    CHAIN_PAGE,
+    NUM_CHAINS
+} ChainRandomization;
+
+typedef struct {
+    void* ptr;
+    uint64_t start;
+    uint64_t end;
+    DataType type;
+    int cpu;
+    Placement placement;
+    size_t pagesize;
+} allocationChunk;
+
 #endif
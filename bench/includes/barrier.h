@@ -38,11 +38,18 @@
  */
 extern void barrier_init(int numberOfGroups);
 
+/**
+ * @brief  Register a group of threads for a barrier
+ * @param  numThreads The number of threads in the group
+ * @param  processorIds The processor each thread is pinned to (may be NULL)
+ * @param  type The barrier algorithm used by the group
+ */
+extern int barrier_registerGroup(int numThreads, const int* processorIds, BarrierType type);
+
 /**
  * @brief  Register a thread for a barrier
  * @param  threadId The id of the thread to register
  */
-extern int barrier_registerGroup(int numThreads);
 extern void barrier_registerThread(BarrierData* barr, int groupsId, int threadId);
 
 /**
@@ -53,4 +60,17 @@ extern void barrier_registerThread(BarrierData* barr, int groupsId, int threadId
 extern void  barrier_synchronize(BarrierData* barr);
 extern void  barrier_destroy(BarrierData* barr);
 
+/**
+ * @brief  Free all registered groups and their barrier data
+ */
+extern void barrier_finalize(void);
+
+/**
+ * @brief  Convert between barrier types and their names
+ * @param  name One of flat, tree or dissemination
+ * @return The barrier type or -1 for unknown names
+ */
+extern int barrier_typeFromString(const char* name);
+extern const char* barrier_typeName(BarrierType type);
+
 #endif /*BARRIER_H*/
@@ -32,17 +32,40 @@
 
 #include <stdint.h>
 
+typedef enum {
+    BARRIER_FLAT = 0,
+    BARRIER_TREE,
+    BARRIER_DISSEMINATION,
+    NUM_BARRIER_TYPES
+} BarrierType;
+
 typedef struct {
     int        numberOfThreads;
     int        offset;
     int        val;
     int*       index;
     volatile int*  bval;
+    BarrierType type;
+    int        threadId;
+    int        episode;
+    int        numberOfChildren;
+    int*       children;
+    int        rounds;
+    volatile int*  arrive;
+    volatile int*  release;
+    volatile int*  flags;
 } BarrierData;
 
 typedef struct {
     int*       groupBval;
     int        numberOfThreads;
+    BarrierType type;
+    int*       childOffsets;
+    int*       children;
+    int*       arrive;
+    int*       release;
+    int        rounds;
+    int*       flags;
 } BarrierGroup;
 
 #endif /*BARRIER_TYPES_H*/
@@ -0,0 +1,59 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  c2c.h
+ *
+ *      Description:  Header File c2c Module
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:  Jan Treibig (jt), jan.treibig@gmail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef C2C_H
+#define C2C_H
+
+#include <c2c_types.h>
+
+/**
+ * @brief  Measure the cache line transfer between all pairs of HW threads
+ *
+ * For every pair one thread is pinned to each HW thread and they either
+ * pass a cache line back and forth (pingpong) or increment a counter in the
+ * same cache line with atomic instructions (atomic). The matrix of the
+ * cycles per transfer and a summary per topology level are printed.
+ *
+ * @param  type The transfer type
+ * @param  numCpus Number of HW threads in cpus
+ * @param  cpus The HW threads, the matrix is sorted by topology
+ * @param  rounds Transfers per pair, 0 for the default
+ * @param  cyclesClock Clock of the cycle counter to convert to ns
+ */
+extern void c2c_runMatrix(C2cType type, int numCpus, const int* cpus, uint64_t rounds, uint64_t cyclesClock);
+
+/**
+ * @brief  Convert between transfer types and their names
+ * @param  name One of pingpong or atomic
+ * @return The transfer type or -1 for unknown names
+ */
+extern int c2c_typeFromString(const char* name);
+extern const char* c2c_typeName(C2cType type);
+
+#endif /*C2C_H*/
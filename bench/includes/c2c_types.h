@@ -0,0 +1,60 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  c2c_types.h
+ *
+ *      Description:  Type Definitions for c2c Module
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:  Jan Treibig (jt), jan.treibig@gmail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef C2C_TYPES_H
+#define C2C_TYPES_H
+
+#include <stdint.h>
+
+typedef enum {
+    C2C_PINGPONG = 0,
+    C2C_ATOMIC,
+    NUM_C2C_TYPES
+} C2cType;
+
+/* Closest common level of two HW threads */
+typedef enum {
+    C2C_SMT = 0,
+    C2C_CACHE,
+    C2C_NUMA,
+    C2C_SOCKET,
+    C2C_REMOTE,
+    NUM_C2C_RELATIONS
+} C2cRelation;
+
+typedef struct {
+    C2cType type;
+    int cpus[2];
+    uint64_t rounds;
+    volatile uint64_t* line;
+    volatile uint64_t* start;
+    uint64_t cycles;
+} C2cPair;
+
+#endif /*C2C_TYPES_H*/
@@ -0,0 +1,54 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  ptt.h
+ *
+ *      Description:  Header File ptt Module
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:  Jan Treibig (jt), jan.treibig@gmail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef PTT_H
+#define PTT_H
+
+#include <test_types.h>
+
+/**
+ * @brief  Load a benchmark kernel from a ptt file at runtime
+ *
+ * The ptt file is parsed and its loop is assembled into executable memory
+ * by a built-in encoder for the x86-64 instructions used by the shipped
+ * kernels.
+ *
+ * @param  filename Path to the ptt file
+ * @param  test Pointer to the created test case
+ * @return 0 on success, -EINVAL for syntax errors, other negative error codes
+ */
+extern int ptt_loadKernel(const char* filename, TestCase** test);
+
+/**
+ * @brief  Free a test case created by ptt_loadKernel()
+ * @param  test The test case
+ */
+extern void ptt_freeKernel(TestCase* test);
+
+#endif /*PTT_H*/
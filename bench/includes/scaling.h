@@ -0,0 +1,58 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  scaling.h
+ *
+ *      Description:  Header File scaling Module
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:  Jan Treibig (jt), jan.treibig@gmail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef SCALING_H
+#define SCALING_H
+
+#include <scaling_types.h>
+
+/**
+ * @brief  Sort HW threads in the order they are added in a scaling study
+ *
+ * compact fills the HW threads in topology order, all HW threads of a core
+ * and all cores of a socket before the next one. scatter takes one HW
+ * thread per core and alternates between the sockets, smtlast takes one HW
+ * thread per core socket by socket. With both, the SMT siblings are added
+ * after all cores are used.
+ *
+ * @param  order The fill order
+ * @param  numCpus Number of HW threads in cpus
+ * @param  cpus The HW threads, sorted in place
+ */
+extern void scaling_sortProcessors(ScalingOrder order, int numCpus, int* cpus);
+
+/**
+ * @brief  Convert between fill orders and their names
+ * @param  name One of compact, scatter or smtlast
+ * @return The fill order or -1 for unknown names
+ */
+extern int scaling_orderFromString(const char* name);
+extern const char* scaling_orderName(ScalingOrder order);
+
+#endif /*SCALING_H*/
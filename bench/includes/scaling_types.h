@@ -0,0 +1,50 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  scaling_types.h
+ *
+ *      Description:  Type Definitions for scaling Module
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:  Jan Treibig (jt), jan.treibig@gmail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef SCALING_TYPES_H
+#define SCALING_TYPES_H
+
+/* Order in which the HW threads of a workgroup are added */
+typedef enum {
+    SCALING_COMPACT = 0,
+    SCALING_SCATTER,
+    SCALING_SMTLAST,
+    NUM_SCALING_ORDERS
+} ScalingOrder;
+
+/* Position of a HW thread among the selected HW threads */
+typedef struct {
+    int cpu;
+    int socket;
+    int core;
+    int coreRank;
+    int smtRank;
+} ScalingCpu;
+
+#endif /*SCALING_TYPES_H*/
@@ -39,10 +39,12 @@
 #include <likwid.h>
 
 #include <test_types.h>
+#include <allocator_types.h>
 
 typedef struct {
     bstring domain;
     int offset;
+    PageType pages;
     void* ptr;
 } Stream;
 
@@ -51,9 +53,12 @@ typedef struct {
     int* processorIds;
     uint64_t size;
     Stream* streams;
+    int numberOfStreams;
+    const TestCase* test;
 } Workgroup;
 
+extern uint64_t bstr_to_doubleSize(const_bstring str, DataType type);
 extern int bstr_to_workgroup(Workgroup* group, const_bstring str, DataType type, int numberOfStreams);
-extern void workgroups_destroy(Workgroup** groupList, int numberOfGroups, int numberOfStreams);
+extern void workgroups_destroy(Workgroup** groupList, int numberOfGroups);
 
 #endif
@@ -38,7 +38,8 @@ typedef void (*FuncPrototype)();
 typedef enum {
     SINGLE = 0,
     DOUBLE,
-    INT} DataType;
+    INT,
+    POINTER} DataType;
 
 typedef enum {
     STREAM_1 = 1,
@@ -107,6 +108,12 @@ typedef struct {
     uint32_t numberOfThreads;
     int* processors;
     void** streams;
+    int quiet;
+    int barrierGroup;
+    uint64_t delay;
+    int probe;
+    volatile int* probes;
+    uint64_t processed;
 } ThreadUserData;
 
 #endif /*TEST_TYPES_H*/
@@ -59,6 +59,23 @@ extern void threads_init(int numberOfThreads);
  */
 extern void threads_create(void *(*startRoutine)(void*));
 
+/**
+ * @brief  Create all threads as a pool that stays alive between runs
+ * @param  startRoutine thread entry function pointer, called once per run
+ */
+extern void threads_createPool(void *(*startRoutine)(void*));
+
+/**
+ * @brief  Run the pool routine on the first threads and wait for them
+ * @param  numberOfThreads  The number of threads taking part in this run
+ */
+extern void threads_runPool(int numberOfThreads);
+
+/**
+ * @brief  Stop and join the threads of the pool
+ */
+extern void threads_destroyPool(void);
+
 /**
  * @brief  Register User thread data for all threads
  * @param  data  Reference to the user data structo
@@ -107,7 +124,8 @@ extern void threads_destroy(int numberOfGroups, int numberOfStreams);
 /**
  * @brief  Create Thread groups
  * @param  numberOfGroups The number of groups to create
+ * @param  groupSizes Number of threads per group, NULL for equally sized groups
  */
-extern void threads_createGroups(int numberOfGroups);
+extern void threads_createGroups(int numberOfGroups, const int* groupSizes);
 
 #endif /* THREADS_H */
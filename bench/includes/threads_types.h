@@ -42,6 +42,8 @@ typedef struct {
     int        groupId;
     double     time;
     uint64_t   cycles;
+    uint64_t   loopCycles;
+    uint64_t   barrierCycles;
     ThreadUserData data;
 } ThreadData;
 
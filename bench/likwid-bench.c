@@ -47,6 +47,9 @@
 #include <testcases.h>
 #include <strUtil.h>
 #include <allocator.h>
+#include <ptt.h>
+#include <c2c.h>
+#include <scaling.h>
 
 #include <likwid.h>
 
@@ -67,9 +70,30 @@ extern void* getIterSingle(void* arg);
     printf("\t\t If resulting iteration count is below 10, it is normalized to 10.\n");\
     printf("-i <ITERS>\t Specify the number of iterations per thread manually. \n"); \
     printf("-l <TEST>\t list properties of benchmark \n"); \
+    printf("\t\t <TEST> for -t and -l can also be a ptt file that is assembled at runtime\n"); \
+    printf("-b <TYPE>\t Barrier used to synchronize the threads (default flat)\n"); \
+    printf("\t\t <TYPE> is one of flat, tree (SMT threads, cores, sockets) or dissemination\n"); \
+    printf("-m <PLACEMENT>\t Placement of the vector pages (default domain)\n"); \
+    printf("\t\t <PLACEMENT> is one of domain, local, interleave or remote\n"); \
+    printf("-L <STRIDE>[:<RANDOM>] Pointer chain of the latency tests (default 64:line)\n"); \
+    printf("\t\t <STRIDE> is the distance of the chain elements in bytes\n"); \
+    printf("\t\t <RANDOM> is line (all elements shuffled) or page (shuffled within a page)\n"); \
+    printf("-S <MIN>[:<POINTS>] Sweep the working set from <MIN> to the workgroup size\n"); \
+    printf("\t\t <MIN> in kB, MB or GB, <POINTS> sizes per doubling (default 2)\n"); \
     printf("-t <TEST>\t type of test \n"); \
-    printf("-w\t\t <thread_domain>:<size>[:<num_threads>[:<chunk size>:<stride>]-<streamId>:<domain_id>[:<offset>]\n"); \
+    printf("\t\t Multiple -t apply to the following -w, each workgroup reports its own result\n"); \
+    printf("-x <TYPE>\t Cache line transfer matrix between all HW threads of the workgroups\n"); \
+    printf("\t\t <TYPE> is pingpong (latency) or atomic (contended atomic increments)\n"); \
+    printf("\t\t -i sets the transfers per pair, the workgroup sizes are ignored\n"); \
+    printf("-T <ORDER>\t Thread scaling study from 1 to all threads of the workgroup\n"); \
+    printf("\t\t <ORDER> is compact, scatter (alternating sockets) or smtlast\n"); \
+    printf("-I <DELAYS>\t Loaded latency, comma separated injection delays in cycles\n"); \
+    printf("\t\t Workgroups with a latency test probe while the others run throttled\n"); \
+    printf("-w\t\t <thread_domain>:<size>[:<num_threads>[:<chunk size>:<stride>]-<streamId>:<domain_id>[:<offset>][:<pages>]\n"); \
     printf("\t\t <size> in kB, MB or GB  (mandatory)\n"); \
+    printf("\t\t P:<policy>:<size>:<num_threads>[-<streamId>:<domain_id>[:<offset>][:<pages>]]\n"); \
+    printf("\t\t <policy> is one of compact_llc, spread_mem, cores_first or numa_balanced\n"); \
+    printf("\t\t <pages> is one of thp, nothp, 2MB or 1GB (default: system setting)\n"); \
     printf("\n"); \
     printf("Usage: \n"); \
     printf("# Run the store benchmark on all CPUs of the system with a vector size of 1 GB\n"); \
@@ -78,6 +102,25 @@ extern void* getIterSingle(void* arg);
     printf("likwid-bench -t copy -w S0:100kB:1\n"); \
     printf("# Run the copy benchmark on one CPU at CPU socket 0 with a vector size of 100MB but place one stream on CPU socket 1\n"); \
     printf("likwid-bench -t copy -w S0:100MB:1-0:S0,1:S1\n"); \
+    printf("# Run the copy benchmark on 4 CPUs spread over the NUMA domains with a vector size of 1GB\n"); \
+    printf("likwid-bench -t copy -w P:spread_mem:1GB:4\n"); \
+    printf("# Measure the latency of CPU socket 0 accessing memory of CPU socket 1 with 2MB huge pages\n"); \
+    printf("likwid-bench -t latency -w S0:1GB:1-0:S1:2MB\n"); \
+    printf("# Run the load benchmark on one CPU for working sets from 4kB to 1GB\n"); \
+    printf("likwid-bench -t load -w S0:1GB:1 -S 4kB:4\n"); \
+    printf("# Measure the latency on CPU socket 0 while CPU socket 1 copies data in the memory of socket 0\n"); \
+    printf("likwid-bench -t latency -w S0:1GB:1 -t copy -w S1:4GB-0:S0,1:S0\n"); \
+    printf("# Measure the cache line transfer latency between all HW threads of the node\n"); \
+    printf("likwid-bench -x pingpong -w N:1kB\n"); \
+    printf("# Run the copy benchmark with 1 to all CPUs of the node, one CPU per core first\n"); \
+    printf("likwid-bench -t copy -w N:4GB -T smtlast\n"); \
+    printf("# Measure the latency on CPU socket 0 while CPU socket 1 copies data in the memory of socket 0 at increasing load\n"); \
+    printf("likwid-bench -t latency -w S0:1GB:1 -t copy -w S1:4GB-0:S0,1:S0 -I 20000,5000,2000,1000,500,200,0\n"); \
+
+#define SWEEP_TOLERANCE 0.1
+#define SWEEP_MIN_POINTS 3
+/* Fraction of the maximum bandwidth that marks the saturation point */
+#define SCALING_SATURATION 0.95
 
 #define VERSION_MSG \
     printf("likwid-bench   %d.%d \n\n",VERSION,RELEASE)
@@ -106,6 +149,453 @@ copyThreadData(ThreadUserData* src,ThreadUserData* dst)
 
 
 
+static int
+isKernelFile(const char* name)
+{
+    size_t len = strlen(name);
+
+    return ((len > 4) && (strcmp(name + len - 4, ".ptt") == 0));
+}
+
+/* Consecutive sweep points within SWEEP_TOLERANCE of the mean of the current
+ * plateau belong to it, plateaus need at least SWEEP_MIN_POINTS points */
+static void
+printPlateaus(int numPoints, const uint64_t* sizes, const double* values, const char* unit)
+{
+    int start = 0;
+    int plateaus = 0;
+    double sum = values[0];
+
+    for (int i = 1; i <= numPoints; i++)
+    {
+        double mean = sum / (i - start);
+        if ((i < numPoints) && (fabs(values[i] - mean) <= SWEEP_TOLERANCE * mean))
+        {
+            sum += values[i];
+            continue;
+        }
+        if (i - start >= SWEEP_MIN_POINTS)
+        {
+            printf("Plateau %d:\t\t%" PRIu64 " - %" PRIu64 " Byte: %.2f %s\n",
+                    plateaus++, sizes[start], sizes[i-1], mean, unit);
+        }
+        if (i < numPoints)
+        {
+            start = i;
+            sum = values[i];
+        }
+    }
+    if (plateaus == 0)
+    {
+        printf("No plateaus detected\n");
+    }
+}
+
+/* Run the test for a geometric series of sizes per workgroup from minSize up
+ * to the allocated size. The vectors, the timer and the barrier are set up
+ * once, for each point only the thread sizes and iterations change. */
+static void
+runSweep(Workgroup* groups, int numberOfWorkgroups, const TestCase* test,
+         uint64_t minSize, int pointsPerDoubling, uint64_t demandIter, uint64_t cyclesClock)
+{
+    uint64_t maxSize = groups[0].size;
+    int numPoints = 0;
+    int maxPoints = 0;
+    uint64_t* sizes = NULL;
+    double* values = NULL;
+    double factor = pow(2.0, 1.0 / pointsPerDoubling);
+    double current = 0;
+
+    for (int g = 1; g < numberOfWorkgroups; g++)
+    {
+        if (groups[g].size < maxSize)
+        {
+            maxSize = groups[g].size;
+        }
+    }
+    if (minSize == 0 || minSize > maxSize)
+    {
+        minSize = maxSize;
+    }
+    maxPoints = (int) ceil(log((double) maxSize / minSize) / log(factor)) + 2;
+    sizes = (uint64_t*) malloc(maxPoints * sizeof(uint64_t));
+    values = (double*) malloc(maxPoints * sizeof(double));
+    if (!sizes || !values)
+    {
+        fprintf(stderr, "Error: Cannot allocate sweep results\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-16s%-14s%-14s%-14s%-14s%s\n", "Size (Byte)", "Iterations", "MByte/s", "MFlops/s",
+            "Cycles/CL", (test->type == POINTER ? "Cycles/access" : ""));
+    for (current = minSize; numPoints < maxPoints; current *= factor)
+    {
+        uint64_t realSize = 0;
+        uint64_t maxCycles = 0;
+        uint64_t point = (current < maxSize ? (uint64_t) current : maxSize);
+        double time = 0;
+        double cycPerCL = 0;
+
+        for (int g = 0; g < numberOfWorkgroups; g++)
+        {
+            int nrThreads = threads_groups[g].numberOfThreads;
+            uint64_t size = point - (point % (test->stride * nrThreads));
+            if (size == 0)
+            {
+                size = test->stride * nrThreads;
+            }
+            for (int t = 0; t < nrThreads; t++)
+            {
+                ThreadUserData* data = &threads_data[threads_groups[g].threadIds[t]].data;
+                data->size = size;
+                data->quiet = (numPoints > 0);
+                for (int k = 0; k < test->streams; k++)
+                {
+                    data->streams[k] = groups[g].streams[k].ptr;
+                }
+            }
+            if (test->type == POINTER)
+            {
+                for (int k = 0; k < test->streams; k++)
+                {
+                    allocator_initChain(groups[g].streams[k].ptr, size, test->stride, nrThreads);
+                }
+            }
+        }
+        if (demandIter == 0)
+        {
+            getIterSingle((void*) &threads_data[0]);
+        }
+        for (int g = 0; g < numberOfWorkgroups; g++)
+        {
+            threads_updateIterations(g, demandIter);
+        }
+
+        threads_create(runTest);
+        threads_join();
+
+        for (int i = 0; i < threads_data[0].globalNumberOfThreads; i++)
+        {
+            realSize += threads_data[i].data.size;
+            if (threads_data[i].cycles > maxCycles)
+            {
+                maxCycles = threads_data[i].cycles;
+            }
+        }
+        time = (double) maxCycles / (double) cyclesClock;
+        cycPerCL = ((double) maxCycles / (double) (threads_data[0].data.iter*(realSize/test->streams)* 8 / 64.0));
+        sizes[numPoints] = realSize * test->bytes;
+        printf("%-16" PRIu64 "%-14" PRIu64 "%-14.2f%-14.2f%-14.2f",
+                sizes[numPoints],
+                threads_data[0].data.iter,
+                1.0E-06 * ((double) threads_data[0].data.iter * realSize * test->bytes / time),
+                1.0E-06 * ((double) threads_data[0].data.iter * realSize * test->flops / time),
+                cycPerCL);
+        if ((test->type == POINTER) && (test->loads > 0))
+        {
+            values[numPoints] = (double) maxCycles / ((double) threads_data[0].data.iter *
+                            ((double) threads_data[0].data.size / test->stride) * test->loads);
+            printf("%.2f", values[numPoints]);
+        }
+        else
+        {
+            values[numPoints] = 1.0E-06 * ((double) threads_data[0].data.iter * realSize * test->bytes / time);
+        }
+        printf("\n");
+        numPoints++;
+        if (point == maxSize)
+        {
+            break;
+        }
+    }
+    printPlateaus(numPoints, sizes, values,
+                  ((test->type == POINTER) && (test->loads > 0) ? "cycles per access" : "MByte/s"));
+    free(sizes);
+    free(values);
+}
+
+/* Run the test with the first 1 to all threads of the workgroup. The threads
+ * and vectors stay alive between the steps, each step splits the whole
+ * vectors among its threads and uses its own barrier group. */
+static void
+runScaling(const Workgroup* group, const TestCase* test, uint64_t demandIter, uint64_t cyclesClock)
+{
+    int maxThreads = group->numberOfThreads;
+    int saturation = maxThreads;
+    double maxBandwidth = 0;
+    double* bandwidth = (double*) malloc(maxThreads * sizeof(double));
+
+    if (!bandwidth)
+    {
+        fprintf(stderr, "Error: Cannot allocate scaling results\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%-10s%-10s%-14s%-14s%-14s%-14s%s\n", "Threads", "HWThread", "Iterations", "MByte/s",
+            "MFlops/s", "Cycles/CL", (test->type == POINTER ? "Cycles/access" : ""));
+    threads_createPool(runTest);
+    for (int k = 1; k <= maxThreads; k++)
+    {
+        uint64_t realSize = 0;
+        uint64_t maxCycles = 0;
+        double time = 0;
+
+        for (int t = 0; t < k; t++)
+        {
+            ThreadUserData* data = &threads_data[t].data;
+            threads_data[t].numberOfThreads = k;
+            data->size = group->size;
+            data->quiet = 1;
+            data->barrierGroup = k - 1;
+            for (int s = 0; s < test->streams; s++)
+            {
+                data->streams[s] = group->streams[s].ptr;
+            }
+        }
+        if (test->type == POINTER)
+        {
+            for (int s = 0; s < test->streams; s++)
+            {
+                allocator_initChain(group->streams[s].ptr, group->size, test->stride, k);
+            }
+        }
+        if (demandIter == 0)
+        {
+            getIterSingle((void*) &threads_data[0]);
+        }
+        threads_updateIterations(0, demandIter);
+
+        threads_runPool(k);
+
+        for (int t = 0; t < k; t++)
+        {
+            realSize += threads_data[t].data.size;
+            if (threads_data[t].cycles > maxCycles)
+            {
+                maxCycles = threads_data[t].cycles;
+            }
+        }
+        time = (double) maxCycles / (double) cyclesClock;
+        bandwidth[k-1] = 1.0E-06 * ((double) threads_data[0].data.iter * realSize * test->bytes / time);
+        if (bandwidth[k-1] > maxBandwidth)
+        {
+            maxBandwidth = bandwidth[k-1];
+        }
+        printf("%-10d%-10d%-14" PRIu64 "%-14.2f%-14.2f%-14.2f", k,
+                group->processorIds[k-1],
+                threads_data[0].data.iter,
+                bandwidth[k-1],
+                1.0E-06 * ((double) threads_data[0].data.iter * realSize * test->flops / time),
+                ((double) maxCycles / (double) (threads_data[0].data.iter*(realSize/test->streams)* 8 / 64.0)));
+        if ((test->type == POINTER) && (test->loads > 0))
+        {
+            printf("%.2f", (double) maxCycles / ((double) threads_data[0].data.iter *
+                            ((double) threads_data[0].data.size / test->stride) * test->loads));
+        }
+        printf("\n");
+    }
+    threads_destroyPool();
+
+    for (int k = 1; k <= maxThreads; k++)
+    {
+        if (bandwidth[k-1] >= SCALING_SATURATION * maxBandwidth)
+        {
+            saturation = k;
+            break;
+        }
+    }
+    if (saturation < maxThreads)
+    {
+        printf("Saturation:\t\t%d threads, %.2f MByte/s (%.0f%% of the maximum %.2f MByte/s)\n",
+                saturation, bandwidth[saturation-1], 100.0 * bandwidth[saturation-1] / maxBandwidth, maxBandwidth);
+    }
+    else
+    {
+        printf("Saturation:\t\tnot reached with %d threads, %.2f MByte/s\n",
+                maxThreads, bandwidth[maxThreads-1]);
+    }
+    free(bandwidth);
+}
+
+static int
+isProbe(const TestCase* test)
+{
+    return ((test->type == POINTER) && (test->loads > 0));
+}
+
+/* Run the latency tests of the probe workgroups while the other workgroups
+ * load the memory system, once idle and once for every injection delay. The
+ * load threads run until the probes are done, so every access of the
+ * probes sees the load. */
+static void
+runLoadedLatency(const Workgroup* groups, int numberOfWorkgroups, const uint64_t* delays,
+                 int numberOfDelays, uint64_t demandIter, uint64_t cyclesClock)
+{
+    volatile int probes = 0;
+    int numberOfProbes = 0;
+    int numberOfLoads = 0;
+    uint64_t* probeIter = (uint64_t*) malloc(numberOfWorkgroups * sizeof(uint64_t));
+
+    if (!probeIter)
+    {
+        fprintf(stderr, "Error: Cannot allocate loaded latency iterations\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int g = 0; g < numberOfWorkgroups; g++)
+    {
+        if (isProbe(groups[g].test))
+        {
+            numberOfProbes += threads_groups[g].numberOfThreads;
+        }
+        else
+        {
+            numberOfLoads += threads_groups[g].numberOfThreads;
+        }
+    }
+    if ((numberOfProbes == 0) || (numberOfLoads == 0))
+    {
+        fprintf(stderr, "Error: The loaded latency mode (-I) requires workgroups with a latency test and with a bandwidth test\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("Probe threads:\t\t%d\n", numberOfProbes);
+    printf("Load threads:\t\t%d\n", numberOfLoads);
+    printf("%-16s%-14s%-14s%s\n", "Delay (cycles)", "MByte/s", "Cycles/access", "Latency (ns)");
+
+    /* Step -1 is the idle system */
+    for (int d = -1; d < numberOfDelays; d++)
+    {
+        uint64_t loadBytes = 0;
+        uint64_t loadCycles = 0;
+        double cycPerAccess = 0;
+        double bandwidth = 0;
+
+        probes = numberOfProbes;
+        for (int g = 0; g < numberOfWorkgroups; g++)
+        {
+            int probe = isProbe(groups[g].test);
+            for (int t = 0; t < threads_groups[g].numberOfThreads; t++)
+            {
+                ThreadUserData* data = &threads_data[threads_groups[g].threadIds[t]].data;
+                data->size = groups[g].size;
+                data->quiet = (d >= 0);
+                data->probe = probe;
+                data->probes = &probes;
+                data->delay = ((probe || d < 0) ? 0 : delays[d]);
+                for (int s = 0; s < groups[g].test->streams; s++)
+                {
+                    data->streams[s] = groups[g].streams[s].ptr;
+                }
+            }
+            if (probe)
+            {
+                /* The probes are calibrated on the idle system */
+                if (d < 0)
+                {
+                    int first = threads_groups[g].threadIds[0];
+                    if (demandIter == 0)
+                    {
+                        getIterSingle((void*) &threads_data[first]);
+                    }
+                    probeIter[g] = threads_updateIterations(g, demandIter);
+                }
+                threads_updateIterations(g, probeIter[g]);
+            }
+            else
+            {
+                threads_updateIterations(g, 0);
+                for (int t = 0; t < threads_groups[g].numberOfThreads; t++)
+                {
+                    threads_data[threads_groups[g].threadIds[t]].data.iter = (d < 0 ? 0 : UINT64_MAX);
+                }
+            }
+        }
+
+        threads_create(runTest);
+        threads_join();
+
+        for (int g = 0; g < numberOfWorkgroups; g++)
+        {
+            for (int t = 0; t < threads_groups[g].numberOfThreads; t++)
+            {
+                const ThreadData* thread = &threads_data[threads_groups[g].threadIds[t]];
+                if (isProbe(groups[g].test))
+                {
+                    cycPerAccess += (double) thread->loopCycles / ((double) thread->data.iter *
+                                    ((double) thread->data.size / groups[g].test->stride) * groups[g].test->loads);
+                }
+                else
+                {
+                    loadBytes += thread->data.processed * groups[g].test->bytes;
+                    if (thread->loopCycles > loadCycles)
+                    {
+                        loadCycles = thread->loopCycles;
+                    }
+                }
+            }
+        }
+        cycPerAccess /= numberOfProbes;
+        if (loadBytes > 0)
+        {
+            bandwidth = 1.0E-06 * (double) loadBytes / ((double) loadCycles / (double) cyclesClock);
+        }
+        if (d < 0)
+        {
+            printf("%-16s", "idle");
+        }
+        else
+        {
+            printf("%-16" PRIu64, delays[d]);
+        }
+        printf("%-14.2f%-14.2f%.2f\n", bandwidth, cycPerAccess, 1.0E09 * cycPerAccess / (double) cyclesClock);
+    }
+    free(probeIter);
+}
+
+/* Result of one workgroup running its own test next to the others. The
+ * cycles of a group end with its own kernel loop, not with the barrier that
+ * waits for the slowest group. */
+static void
+printGroupResult(int groupId, const Workgroup* group, uint64_t cyclesClock)
+{
+    const TestCase* test = group->test;
+    const ThreadGroup* threadGroup = &threads_groups[groupId];
+    const ThreadData* first = &threads_data[threadGroup->threadIds[0]];
+    uint64_t realSize = 0;
+    uint64_t maxCycles = 0;
+    double time = 0;
+
+    for (int i = 0; i < threadGroup->numberOfThreads; i++)
+    {
+        const ThreadData* data = &threads_data[threadGroup->threadIds[i]];
+        realSize += data->data.size;
+        if (data->loopCycles > maxCycles)
+        {
+            maxCycles = data->loopCycles;
+        }
+    }
+    time = (double) maxCycles / (double) cyclesClock;
+    printf("Group:\t\t\t%d\n", groupId);
+    printf("Test:\t\t\t%s\n", test->name);
+    printf("Threads:\t\t%d\n", threadGroup->numberOfThreads);
+    printf("Cycles:\t\t\t%" PRIu64 "\n", maxCycles);
+    printf("Time:\t\t\t%e sec\n", time);
+    printf("Iterations per thread:\t%" PRIu64 "\n", first->data.iter);
+    printf("Size (Byte):\t\t%" PRIu64 "\n", realSize * test->bytes);
+    printf("MFlops/s:\t\t%.2f\n",
+            1.0E-06 * ((double) first->data.iter * realSize * test->flops / time));
+    printf("MByte/s:\t\t%.2f\n",
+            1.0E-06 * ((double) first->data.iter * realSize * test->bytes / time));
+    printf("Cycles per cacheline:\t%f\n",
+            (double) maxCycles / (double) (first->data.iter * (realSize / test->streams) * 8 / 64.0));
+    if ((test->type == POINTER) && (test->loads > 0))
+    {
+        double cycPerAccess = (double) maxCycles / ((double) first->data.iter *
+                              ((double) first->data.size / test->stride) * test->loads);
+        printf("Cycles per access:\t%f\n", cycPerAccess);
+        printf("Latency (ns):\t\t%f\n", 1.0E09 * cycPerAccess / (double) cyclesClock);
+    }
+}
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 int main(int argc, char** argv)
@@ -124,6 +614,12 @@ int main(int argc, char** argv)
     double cycPerUp = 0.0;
     double cycPerCL = 0.0;
     const TestCase* test = NULL;
+    TestCase* loadedTest = NULL;
+    const TestCase** tests = NULL;
+    TestCase** loadedTests = NULL;
+    int numberOfTests = 0;
+    int numberOfLoadedTests = 0;
+    int heterogeneous = 0;
     uint64_t realSize = 0;
     uint64_t realIter = 0;
     uint64_t maxCycles = 0;
@@ -134,6 +630,21 @@ int main(int argc, char** argv)
     Workgroup* currentWorkgroup = NULL;
     Workgroup* groups = NULL;
     uint32_t min_runtime = 1; /* 1s */
+    int barrierType = BARRIER_FLAT;
+    uint64_t barrierCycles = 0;
+    int* processorIds = NULL;
+    int* groupSizes = NULL;
+    int chainStride = 64;
+    int chainRandom = CHAIN_LINE;
+    char* chainEnd = NULL;
+    bstring sweepString = NULL;
+    uint64_t sweepMin = 0;
+    int sweepPoints = 2;
+    int c2cType = -1;
+    int scalingOrder = -1;
+    bstring injectString = NULL;
+    uint64_t* delays = NULL;
+    int numberOfDelays = 0;
     bstring HLINE = bfromcstr("");
     binsertch(HLINE, 0, 80, '-');
     binsertch(HLINE, 80, 1, '\n');
@@ -147,7 +658,9 @@ int main(int argc, char** argv)
         exit(EXIT_SUCCESS);
     }
 
-    while ((c = getopt (argc, argv, "w:t:s:l:aphvi:")) != -1) {
+    tests = (const TestCase**) malloc(argc * sizeof(TestCase*));
+    loadedTests = (TestCase**) malloc(argc * sizeof(TestCase*));
+    while ((c = getopt (argc, argv, "w:t:s:l:b:m:L:S:x:T:I:aphvi:")) != -1) {
         switch (c)
         {
             case 'h':
@@ -165,6 +678,69 @@ int main(int argc, char** argv)
             case 's':
                 min_runtime = atoi(optarg);
                 break;
+            case 'b':
+                barrierType = barrier_typeFromString(optarg);
+                if (barrierType < 0)
+                {
+                    fprintf (stderr, "Error: Unknown barrier type %s\n",optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'm':
+                tmp = allocator_placementFromString(optarg);
+                if (tmp < 0)
+                {
+                    fprintf (stderr, "Error: Unknown placement %s\n",optarg);
+                    return EXIT_FAILURE;
+                }
+                allocator_setPlacement(tmp);
+                break;
+            case 'L':
+                chainStride = (int) strtol(optarg, &chainEnd, 10);
+                if (chainStride < (int) sizeof(void*) || (chainStride % sizeof(void*)))
+                {
+                    fprintf (stderr, "Error: Pointer chain stride must be a multiple of %d bytes\n", (int) sizeof(void*));
+                    return EXIT_FAILURE;
+                }
+                if (*chainEnd == ':')
+                {
+                    chainRandom = allocator_chainFromString(chainEnd + 1);
+                }
+                else if (*chainEnd != '\0')
+                {
+                    chainRandom = -1;
+                }
+                if (chainRandom < 0)
+                {
+                    fprintf (stderr, "Error: Unknown pointer chain %s\n",optarg);
+                    return EXIT_FAILURE;
+                }
+                allocator_setChain(chainStride, chainRandom);
+                break;
+            case 'x':
+                c2cType = c2c_typeFromString(optarg);
+                if (c2cType < 0)
+                {
+                    fprintf (stderr, "Error: Unknown cache line transfer type %s\n",optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'T':
+                scalingOrder = scaling_orderFromString(optarg);
+                if (scalingOrder < 0)
+                {
+                    fprintf (stderr, "Error: Unknown fill order %s\n",optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'I':
+                bdestroy(injectString);
+                injectString = bfromcstr(optarg);
+                break;
+            case 'S':
+                bdestroy(sweepString);
+                sweepString = bfromcstr(optarg);
+                break;
             case 'i':
                 demandIter = strtoul(optarg, NULL, 10);
                 if (demandIter <= 0)
@@ -185,6 +761,12 @@ int main(int argc, char** argv)
                     }
                 }
 
+                if ((test == NULL) && isKernelFile(optarg) &&
+                    (ptt_loadKernel(optarg, &loadedTest) == 0))
+                {
+                    test = loadedTest;
+                }
+
                 if (test == NULL)
                 {
                     fprintf (stderr, "Error: Unknown test case %s\n",optarg);
@@ -207,6 +789,9 @@ int main(int argc, char** argv)
                         case DOUBLE:
                             ownprintf("Data Type: Double precision float\n");
                             break;
+                        case POINTER:
+                            ownprintf("Data Type: Pointer chain\n");
+                            break;
                     }
                     ownprintf("Flops per element: %d\n",test->flops);
                     ownprintf("Bytes per element: %d\n",test->bytes);
@@ -266,6 +851,8 @@ int main(int argc, char** argv)
             case 't':
                 bdestroy(testcase);
                 testcase = bfromcstr(optarg);
+                test = NULL;
+                loadedTest = NULL;
 
                 for (i=0; i<NUMKERNELS; i++)
                 {
@@ -276,12 +863,22 @@ int main(int argc, char** argv)
                     }
                 }
 
+                if ((test == NULL) && isKernelFile(optarg) &&
+                    (ptt_loadKernel(optarg, &loadedTest) == 0))
+                {
+                    test = loadedTest;
+                    loadedTests[numberOfLoadedTests++] = loadedTest;
+                }
+
                 if (test == NULL)
                 {
                     fprintf (stderr, "Error: Unknown test case %s\n",optarg);
                     return EXIT_FAILURE;
                 }
+                /* Every -t applies to the following workgroups */
+                tests[numberOfTests++] = test;
                 bdestroy(testcase);
+                testcase = NULL;
                 break;
             case '?':
                 if (isprint (optopt))
@@ -307,13 +904,81 @@ int main(int argc, char** argv)
         exit(EXIT_FAILURE);
     }
 
-    if ((test == NULL) && (!optPrintDomains))
+    if ((test == NULL) && (!optPrintDomains) && (c2cType < 0))
     {
         fprintf(stderr, "Unknown test case. Please check likwid-bench -a for available tests\n");
         fprintf(stderr, "and select one using the -t commandline option\n");
         exit(EXIT_FAILURE);
     }
 
+    if ((sweepString != NULL) && (numberOfTests > 1))
+    {
+        fprintf(stderr, "Error: The working-set sweep (-S) supports only a single test\n");
+        exit(EXIT_FAILURE);
+    }
+    if ((scalingOrder >= 0) && ((numberOfWorkgroups != 1) || (numberOfTests > 1) || (sweepString != NULL)))
+    {
+        fprintf(stderr, "Error: The thread scaling study (-T) supports only a single workgroup and test\n");
+        exit(EXIT_FAILURE);
+    }
+    if (injectString != NULL)
+    {
+        struct bstrList* tokens = bsplit(injectString, ',');
+        char* end = NULL;
+        if ((sweepString != NULL) || (scalingOrder >= 0))
+        {
+            fprintf(stderr, "Error: The loaded latency mode (-I) cannot be combined with -S or -T\n");
+            exit(EXIT_FAILURE);
+        }
+        delays = (uint64_t*) malloc(tokens->qty * sizeof(uint64_t));
+        for (i=0; i<tokens->qty; i++)
+        {
+            if ((blength(tokens->entry[i]) == 0) || (!isdigit(tokens->entry[i]->data[0])))
+            {
+                end = NULL;
+            }
+            else
+            {
+                delays[numberOfDelays++] = strtoull((const char*) tokens->entry[i]->data, &end, 10);
+            }
+            if ((end == NULL) || (*end != '\0'))
+            {
+                fprintf(stderr, "Error: Invalid injection delays %s, use <DELAY>[,<DELAY>...]\n", bdata(injectString));
+                exit(EXIT_FAILURE);
+            }
+        }
+        bstrListDestroy(tokens);
+        if (numberOfDelays == 0)
+        {
+            fprintf(stderr, "Error: Invalid injection delays %s, use <DELAY>[,<DELAY>...]\n", bdata(injectString));
+            exit(EXIT_FAILURE);
+        }
+    }
+    if ((sweepString != NULL) && (test != NULL))
+    {
+        struct bstrList* tokens = bsplit(sweepString, ':');
+        char* end = NULL;
+        sweepMin = bstr_to_doubleSize(tokens->entry[0], test->type) / test->streams;
+        if ((tokens->qty == 2) && (blength(tokens->entry[1]) > 0))
+        {
+            sweepPoints = (int) strtol((const char*) tokens->entry[1]->data, &end, 10);
+            if (*end != '\0')
+            {
+                sweepPoints = 0;
+            }
+        }
+        else if (tokens->qty != 1)
+        {
+            sweepPoints = 0;
+        }
+        bstrListDestroy(tokens);
+        if ((sweepMin == 0) || (sweepPoints < 1))
+        {
+            fprintf(stderr, "Error: Invalid sweep %s, use <MIN>[:<POINTS>]\n", bdata(sweepString));
+            exit(EXIT_FAILURE);
+        }
+    }
+
     numa_init();
     affinity_init();
     timer_init();
@@ -337,17 +1002,74 @@ int main(int argc, char** argv)
         exit (EXIT_SUCCESS);
     }
 
+    if (c2cType >= 0)
+    {
+        /* Only the HW threads of the workgroups are used, no vectors */
+        groups = (Workgroup*) malloc(numberOfWorkgroups*sizeof(Workgroup));
+        processorIds = NULL;
+        tmp = 0;
+        optind = 0;
+        while ((c = getopt (argc, argv, "w:t:s:l:b:m:L:S:x:T:I:i:aphv")) != -1)
+        {
+            if (c == 'w')
+            {
+                bstring groupstr = bfromcstr(optarg);
+                if (bstr_to_workgroup(groups+tmp, groupstr, DOUBLE, 1) != 0)
+                {
+                    exit(EXIT_FAILURE);
+                }
+                bdestroy(groupstr);
+                processorIds = (int*) realloc(processorIds,
+                            (globalNumberOfThreads + groups[tmp].numberOfThreads) * sizeof(int));
+                for (j=0; j<groups[tmp].numberOfThreads; j++)
+                {
+                    int k;
+                    for (k=0; (k<globalNumberOfThreads) && (processorIds[k] != groups[tmp].processorIds[j]); k++);
+                    if (k == globalNumberOfThreads)
+                    {
+                        processorIds[globalNumberOfThreads++] = groups[tmp].processorIds[j];
+                    }
+                }
+                tmp++;
+            }
+        }
+        if (globalNumberOfThreads < 2)
+        {
+            fprintf(stderr, "Error: The cache line transfer requires at least 2 HW threads\n");
+            exit(EXIT_FAILURE);
+        }
+        ownprintf(bdata(HLINE));
+        ownprintf("LIKWID MICRO BENCHMARK\n");
+        ownprintf("Test: %s\n", c2c_typeName(c2cType));
+        ownprintf(bdata(HLINE));
+        ownprintf("Using %d HW threads\n", globalNumberOfThreads);
+        ownprintf(bdata(HLINE));
+        c2c_runMatrix(c2cType, globalNumberOfThreads, processorIds, demandIter, timer_getCycleClock());
+        ownprintf(bdata(HLINE));
+        free(processorIds);
+        workgroups_destroy(&groups, numberOfWorkgroups);
+        bdestroy(testcase);
+        bdestroy(HLINE);
+        return EXIT_SUCCESS;
+    }
+
     allocator_init(numberOfWorkgroups * MAX_STREAMS);
     groups = (Workgroup*) malloc(numberOfWorkgroups*sizeof(Workgroup));
     tmp = 0;
+    test = tests[0];
+    j = 0;
 
     optind = 0;
-    while ((c = getopt (argc, argv, "w:t:s:l:i:aphv")) != -1)
+    while ((c = getopt (argc, argv, "w:t:s:l:b:m:L:S:x:T:I:i:aphv")) != -1)
     {
         switch (c)
         {
+            case 't':
+                test = tests[j++];
+                break;
             case 'w':
                 currentWorkgroup = groups+tmp;
+                currentWorkgroup->test = test;
                 bstring groupstr = bfromcstr(optarg);
                 i = bstr_to_workgroup(currentWorkgroup, groupstr, test->type, test->streams);
                 bdestroy(groupstr);
@@ -384,7 +1106,10 @@ int main(int argc, char** argv)
                                                     currentWorkgroup->streams[i].offset,
                                                     test->type,
                                                     test->stride,
-                                                    currentWorkgroup->streams[i].domain);
+                                                    currentWorkgroup->streams[i].domain,
+                                                    currentWorkgroup->streams[i].pages,
+                                                    currentWorkgroup->numberOfThreads,
+                                                    currentWorkgroup->processorIds);
                     }
                     tmp++;
                 }
@@ -401,16 +1126,31 @@ int main(int argc, char** argv)
         }
     }
 
-    /* :WARNING:05/04/2010 08:58:05 AM:jt: At the moment the thread
-     * module only allows equally sized thread groups*/
+    test = groups[0].test;
+    if (scalingOrder >= 0)
+    {
+        /* Thread i of every step runs on the i-th HW thread of the fill order */
+        scaling_sortProcessors(scalingOrder, groups[0].numberOfThreads, groups[0].processorIds);
+    }
+    groupSizes = (int*) malloc(numberOfWorkgroups * sizeof(int));
     for (i=0; i<numberOfWorkgroups; i++)
     {
         globalNumberOfThreads += groups[i].numberOfThreads;
+        groupSizes[i] = groups[i].numberOfThreads;
+        if (groups[i].test != test)
+        {
+            heterogeneous = 1;
+        }
     }
 
     ownprintf(bdata(HLINE));
     ownprintf("LIKWID MICRO BENCHMARK\n");
-    ownprintf("Test: %s\n",test->name);
+    ownprintf("Test: %s",test->name);
+    for (i=1; heterogeneous && (i<numberOfWorkgroups); i++)
+    {
+        ownprintf(", %s", groups[i].test->name);
+    }
+    ownprintf("\n");
     ownprintf(bdata(HLINE));
     ownprintf("Using %" PRIu64 " work groups\n",numberOfWorkgroups);
     ownprintf("Using %d threads\n",globalNumberOfThreads);
@@ -418,11 +1158,34 @@ int main(int argc, char** argv)
 
 
     threads_init(globalNumberOfThreads);
-    threads_createGroups(numberOfWorkgroups);
+    threads_createGroups(numberOfWorkgroups, groupSizes);
+    free(groupSizes);
 
     /* we configure global barriers only */
-    barrier_init(1);
-    barrier_registerGroup(globalNumberOfThreads);
+    processorIds = (int*) malloc(globalNumberOfThreads * sizeof(int));
+    tmp = 0;
+    for (i=0; i<numberOfWorkgroups; i++)
+    {
+        for (j=0; j<groups[i].numberOfThreads; j++)
+        {
+            processorIds[tmp++] = groups[i].processorIds[j];
+        }
+    }
+    if (scalingOrder >= 0)
+    {
+        /* One barrier per step of the scaling study, group i has i+1 threads */
+        barrier_init(globalNumberOfThreads);
+        for (i=0; i<globalNumberOfThreads; i++)
+        {
+            barrier_registerGroup(i+1, processorIds, barrierType);
+        }
+    }
+    else
+    {
+        barrier_init(1);
+        barrier_registerGroup(globalNumberOfThreads, processorIds, barrierType);
+    }
+    free(processorIds);
     cyclesClock = timer_getCycleClock();
 
 #ifdef LIKWID_PERFMON
@@ -445,18 +1208,23 @@ int main(int argc, char** argv)
         }
         myData.min_runtime = min_runtime;
         myData.size = groups[i].size;
-        myData.test = test;
+        myData.test = groups[i].test;
         myData.cycles = 0;
+        myData.quiet = 0;
+        myData.barrierGroup = 0;
+        myData.delay = 0;
+        myData.probe = 0;
+        myData.probes = NULL;
         myData.numberOfThreads = groups[i].numberOfThreads;
         myData.processors = (int*) malloc(myData.numberOfThreads * sizeof(int));
-        myData.streams = (void**) malloc(test->streams * sizeof(void*));
+        myData.streams = (void**) malloc(groups[i].test->streams * sizeof(void*));
 
         for (j=0; j<groups[i].numberOfThreads; j++)
         {
             myData.processors[j] = groups[i].processorIds[j];
         }
 
-        for (j=0; j<  test->streams; j++)
+        for (j=0; j<  groups[i].test->streams; j++)
         {
             myData.streams[j] = groups[i].streams[j].ptr;
         }
@@ -467,12 +1235,48 @@ int main(int argc, char** argv)
         free(myData.streams);
     }
 
+    if (sweepString != NULL)
+    {
+        runSweep(groups, numberOfWorkgroups, test, sweepMin, sweepPoints, demandIter, cyclesClock);
+        goto cleanup;
+    }
+    if (injectString != NULL)
+    {
+        runLoadedLatency(groups, numberOfWorkgroups, delays, numberOfDelays, demandIter, cyclesClock);
+        goto cleanup;
+    }
+    if (scalingOrder >= 0)
+    {
+        ownprintf("Fill order:\t\t%s:", scaling_orderName(scalingOrder));
+        for (i=0; i<groups[0].numberOfThreads; i++)
+        {
+            ownprintf(" %d", groups[0].processorIds[i]);
+        }
+        ownprintf("\n");
+        ownprintf(bdata(HLINE));
+        runScaling(&groups[0], test, demandIter, cyclesClock);
+        goto cleanup;
+    }
+
     if (demandIter == 0)
     {
         getIterSingle((void*) &threads_data[0]);
         for (i=0; i<numberOfWorkgroups; i++)
         {
-            iter = threads_updateIterations(i, demandIter);
+            if (heterogeneous)
+            {
+                /* Each group runs its own test for about the same time */
+                int first = threads_groups[i].threadIds[0];
+                if (i > 0)
+                {
+                    getIterSingle((void*) &threads_data[first]);
+                }
+                iter = threads_updateIterations(i, threads_data[first].data.iter);
+            }
+            else
+            {
+                iter = threads_updateIterations(i, demandIter);
+            }
         }
     }
 #ifdef DEBUG_LIKWID
@@ -497,6 +1301,10 @@ int main(int argc, char** argv)
         {
             minCycles = threads_data[i].cycles;
         }
+        if (threads_data[i].barrierCycles > barrierCycles)
+        {
+            barrierCycles = threads_data[i].barrierCycles;
+        }
     }
 
     time = (double) maxCycles / (double) cyclesClock;
@@ -505,6 +1313,17 @@ int main(int argc, char** argv)
     ownprintf("CPU Clock:\t\t%" PRIu64 "\n", timer_getCpuClock());
     ownprintf("Cycle Clock:\t\t%" PRIu64 "\n", cyclesClock);
     ownprintf("Time:\t\t\t%e sec\n", time);
+    ownprintf("Barrier:\t\t%s\n", barrier_typeName(barrierType));
+    ownprintf("Barrier cycles:\t\t%" PRIu64 "\n", barrierCycles);
+    if (heterogeneous)
+    {
+        for (i=0; i<numberOfWorkgroups; i++)
+        {
+            ownprintf(bdata(HLINE));
+            printGroupResult(i, &groups[i], cyclesClock);
+        }
+        goto cleanup;
+    }
     ownprintf("Iterations:\t\t%" PRIu64 "\n", realIter);
     ownprintf("Iterations per thread:\t%" PRIu64 "\n",threads_data[0].data.iter);
     ownprintf("Inner loop executions:\t%d\n", (int)(((double)realSize)/((double)test->stride*globalNumberOfThreads)));
@@ -526,11 +1345,22 @@ int main(int argc, char** argv)
             cycPerUp = cycPerCL/(16.0*test->streams);
             break;
         case DOUBLE:
+        case POINTER:
             cycPerUp = cycPerCL/(8.0*test->streams);
             break;
     }
     ownprintf("Cycles per update:\t%f\n", cycPerUp);
     ownprintf("Cycles per cacheline:\t%f\n", cycPerCL);
+    if ((test->type == POINTER) && (test->loads > 0))
+    {
+        /* Every load of the kernel depends on the previous one */
+        double accesses = (double) threads_data[0].data.iter *
+                          ((double) threads_data[0].data.size / test->stride) * test->loads;
+        double cycPerAccess = (double) maxCycles / accesses;
+        ownprintf("Pointer chain:\t\t%d byte stride, %s\n", chainStride, allocator_chainName(chainRandom));
+        ownprintf("Cycles per access:\t%f\n", cycPerAccess);
+        ownprintf("Latency (ns):\t\t%f\n", 1.0E09 * cycPerAccess / (double) cyclesClock);
+    }
     ownprintf("Loads per update:\t%ld\n", test->loads );
     ownprintf("Stores per update:\t%ld\n", test->stores );
     if (test->loads > 0 && test->stores > 0)
@@ -565,10 +1395,18 @@ int main(int argc, char** argv)
                 LLU_CAST ((double)realSize/test->stride)*test->uops*threads_data[0].data.iter);
     }
 
+cleanup:
     ownprintf(bdata(HLINE));
     threads_destroy(numberOfWorkgroups, test->streams);
     allocator_finalize();
-    workgroups_destroy(&groups, numberOfWorkgroups, test->streams);
+    workgroups_destroy(&groups, numberOfWorkgroups);
+    for (i=0; i<numberOfLoadedTests; i++)
+    {
+        ptt_freeKernel(loadedTests[i]);
+    }
+    free(loadedTests);
+    free(tests);
+    barrier_finalize();
 
 #ifdef LIKWID_PERFMON
     if (getenv("LIKWID_FILEPATH") != NULL)
@@ -579,6 +1417,9 @@ int main(int argc, char** argv)
 #endif
 
     bdestroy(HLINE);
+    bdestroy(sweepString);
+    bdestroy(injectString);
+    free(delays);
     return EXIT_SUCCESS;
 }
 
@@ -32,16 +32,317 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+#include <sys/mman.h>
 
 #include <allocator_types.h>
 #include <allocator.h>
 #include <likwid.h>
 
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+#define HUGEPAGE_2MB (2UL*1024*1024)
+#define HUGEPAGE_1GB (1024UL*1024*1024)
+#define BASEPAGE (4096UL)
+
 /* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
 
 static int numberOfAllocatedVectors = 0;
 static allocation* allocList;
 static AffinityDomains_t domains = NULL;
+static Placement placement = PLACEMENT_DOMAIN;
+static const AffinityDomain* nodeDomain = NULL;
+static int chainStride = 64;
+static ChainRandomization chainRandom = CHAIN_LINE;
+
+static const char* placementNames[NUM_PLACEMENTS] = {
+    [PLACEMENT_DOMAIN] = "domain",
+    [PLACEMENT_LOCAL] = "local",
+    [PLACEMENT_INTERLEAVE] = "interleave",
+    [PLACEMENT_REMOTE] = "remote",
+};
+
+static const char* pageTypeNames[NUM_PAGETYPES] = {
+    [PAGES_DEFAULT] = "default",
+    [PAGES_THP] = "thp",
+    [PAGES_NOTHP] = "nothp",
+    [PAGES_HUGE_2MB] = "2MB",
+    [PAGES_HUGE_1GB] = "1GB",
+};
+
+static const char* chainNames[NUM_CHAINS] = {
+    [CHAIN_LINE] = "line",
+    [CHAIN_PAGE] = "page",
+};
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static void
+printPagePlacement(void* ptr, size_t size)
+{
+    NumaTopology_t numa = get_numaTopology();
+    uint64_t* counts = (uint64_t*) malloc(numa->numberOfNodes * sizeof(uint64_t));
+    int pages = 0;
+    if (!counts)
+    {
+        return;
+    }
+    pages = numa_getPagePlacement(ptr, size, counts);
+    if (pages > 0)
+    {
+        printf("Placement: %d pages", pages);
+        for (int i = 0; i < numa->numberOfNodes; i++)
+        {
+            if (counts[i] > 0)
+            {
+                printf(" - M%d %.1f%%", i, (100.0 * counts[i]) / pages);
+            }
+        }
+        printf("\n");
+    }
+    free(counts);
+}
+
+/* Report the page size of the mapping containing the vector. For transparent
+ * huge pages the share of the mapping backed by huge pages is printed. */
+static void
+printPageSize(void* ptr)
+{
+    FILE* fp = NULL;
+    char line[512];
+    int found = 0;
+    unsigned long start = 0, end = 0;
+    unsigned long mapsize = 0;
+    unsigned long kernelPageSize = 0;
+    unsigned long anonHugePages = 0;
+    unsigned long value = 0;
+
+    fp = fopen("/proc/self/smaps", "r");
+    if (!fp)
+    {
+        return;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2)
+        {
+            if (found)
+            {
+                break;
+            }
+            found = ((uintptr_t)ptr >= start && (uintptr_t)ptr < end);
+            mapsize = end - start;
+            continue;
+        }
+        if (!found)
+        {
+            continue;
+        }
+        if (sscanf(line, "KernelPageSize: %lu kB", &value) == 1)
+        {
+            kernelPageSize = value;
+        }
+        else if (sscanf(line, "AnonHugePages: %lu kB", &value) == 1)
+        {
+            anonHugePages = value;
+        }
+    }
+    fclose(fp);
+    if (!found || kernelPageSize == 0)
+    {
+        return;
+    }
+    if (anonHugePages > 0)
+    {
+        double share = (100.0 * anonHugePages * 1024) / mapsize;
+        printf("Pages: %lu kB, %lu kB (%.1f%%) in transparent huge pages\n",
+                kernelPageSize, anonHugePages, (share > 100.0 ? 100.0 : share));
+    }
+    else
+    {
+        printf("Pages: %lu kB\n", kernelPageSize);
+    }
+}
+
+static size_t
+pageTypeSize(PageType pages)
+{
+    switch (pages)
+    {
+        case PAGES_HUGE_1GB:
+            return HUGEPAGE_1GB;
+        case PAGES_HUGE_2MB:
+        case PAGES_THP:
+            return HUGEPAGE_2MB;
+        default:
+            return BASEPAGE;
+    }
+    return BASEPAGE;
+}
+
+static int
+domainContains(const AffinityDomain* domain, int cpu)
+{
+    for (uint32_t i = 0; i < domain->numberOfProcessors; i++)
+    {
+        if (domain->processorList[i] == cpu)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t
+chainRandomNumber(uint64_t* state)
+{
+    /* xorshift64*, good enough to defeat the hardware prefetchers */
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+/* Link the nodes of a chunk, one node every chainStride bytes, into a single
+ * random cycle. For CHAIN_LINE all nodes are shuffled, for CHAIN_PAGE the
+ * nodes are shuffled only inside each page and the pages are visited in
+ * order, which keeps the TLB out of the measured latency. */
+static void
+initChain(allocationChunk* chunk)
+{
+    void** vec = (void**) chunk->ptr;
+    uint64_t step = chainStride / sizeof(void*);
+    uint64_t nodes = 0;
+    uint64_t group = 0;
+    uint64_t seed = 0x9E3779B97F4A7C15ULL ^ (chunk->start + 1);
+
+    if (step == 0)
+    {
+        step = 1;
+    }
+    nodes = (chunk->end - chunk->start) / step;
+    if (nodes == 0)
+    {
+        return;
+    }
+    group = nodes;
+    if (chainRandom == CHAIN_PAGE)
+    {
+        group = chunk->pagesize / (step * sizeof(void*));
+        if (group == 0)
+        {
+            group = 1;
+        }
+    }
+
+    /* Sattolo's algorithm on node indices creates one cycle per group */
+    for (uint64_t g = 0; g < nodes; g += group)
+    {
+        uint64_t count = (nodes - g < group ? nodes - g : group);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            vec[chunk->start + (g + i) * step] = (void*) (g + i);
+        }
+        for (uint64_t i = count - 1; i > 0; i--)
+        {
+            uint64_t j = chainRandomNumber(&seed) % i;
+            void** a = &vec[chunk->start + (g + i) * step];
+            void** b = &vec[chunk->start + (g + j) * step];
+            void* tmp = *a;
+            *a = *b;
+            *b = tmp;
+        }
+    }
+    /* Splice the cycles of the groups into one: the last node of each group
+     * cycle continues with the first node of the next group */
+    for (uint64_t g = 0; g < nodes; g += group)
+    {
+        uint64_t next = (g + group < nodes ? g + group : 0);
+        uint64_t cur = g;
+        if (next == g)
+        {
+            break;
+        }
+        while ((uint64_t) vec[chunk->start + cur * step] != g)
+        {
+            cur = (uint64_t) vec[chunk->start + cur * step];
+        }
+        vec[chunk->start + cur * step] = (void*) next;
+    }
+    /* Translate node indices into addresses */
+    for (uint64_t i = 0; i < nodes; i++)
+    {
+        uint64_t next = (uint64_t) vec[chunk->start + i * step];
+        vec[chunk->start + i * step] = &vec[chunk->start + next * step];
+    }
+}
+
+static void*
+initChunk(void* arg)
+{
+    allocationChunk* chunk = (allocationChunk*) arg;
+
+    likwid_pinThread(chunk->cpu);
+    if (chunk->placement == PLACEMENT_INTERLEAVE && nodeDomain)
+    {
+        /* The memory policy is per thread and ends with this thread */
+        numa_setInterleaved(nodeDomain->processorList, nodeDomain->numberOfProcessors);
+    }
+
+    switch ( chunk->type )
+    {
+        case INT:
+            {
+                int* sptr = (int*) chunk->ptr;
+                for ( uint64_t i=chunk->start; i < chunk->end; i++ )
+                {
+                    sptr[i] = 1;
+                }
+            }
+            break;
+        case SINGLE:
+            {
+                float* sptr = (float*) chunk->ptr;
+                for ( uint64_t i=chunk->start; i < chunk->end; i++ )
+                {
+                    sptr[i] = 1.0;
+                }
+            }
+            break;
+        case DOUBLE:
+            {
+                double* dptr = (double*) chunk->ptr;
+                for ( uint64_t i=chunk->start; i < chunk->end; i++ )
+                {
+                    dptr[i] = 1.0;
+                }
+            }
+            break;
+        case POINTER:
+            {
+                void** pptr = (void**) chunk->ptr;
+                for ( uint64_t i=chunk->start; i < chunk->end; i++ )
+                {
+                    pptr[i] = NULL;
+                }
+                initChain(chunk);
+            }
+            break;
+    }
+    return NULL;
+}
 
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
@@ -50,8 +351,127 @@ allocator_init(int numVectors)
 {
     allocList = (allocation*) malloc(numVectors * sizeof(allocation));
     domains = get_affinityDomains();
+    for (int i = 0; i < domains->numberOfAffinityDomains; i++)
+    {
+        if (biseqcstr(domains->domains[i].tag, "N"))
+        {
+            nodeDomain = domains->domains + i;
+        }
+    }
 }
 
+int
+allocator_placementFromString(const char* name)
+{
+    for (int i = 0; i < NUM_PLACEMENTS; i++)
+    {
+        if (strcmp(name, placementNames[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char*
+allocator_placementName(Placement p)
+{
+    if (p < 0 || p >= NUM_PLACEMENTS)
+    {
+        return "unknown";
+    }
+    return placementNames[p];
+}
+
+void
+allocator_setPlacement(Placement p)
+{
+    placement = p;
+}
+
+int
+allocator_pageTypeFromString(const char* name)
+{
+    for (int i = 0; i < NUM_PAGETYPES; i++)
+    {
+        if (strcmp(name, pageTypeNames[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char*
+allocator_pageTypeName(PageType pages)
+{
+    if (pages < 0 || pages >= NUM_PAGETYPES)
+    {
+        return "unknown";
+    }
+    return pageTypeNames[pages];
+}
+
+int
+allocator_chainFromString(const char* name)
+{
+    for (int i = 0; i < NUM_CHAINS; i++)
+    {
+        if (strcmp(name, chainNames[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char*
+allocator_chainName(ChainRandomization random)
+{
+    if (random < 0 || random >= NUM_CHAINS)
+    {
+        return "unknown";
+    }
+    return chainNames[random];
+}
+
+void
+allocator_setChain(int stride, ChainRandomization random)
+{
+    chainStride = stride;
+    chainRandom = random;
+}
+
+/* Rebuild the pointer chains of a vector for the first size elements with the
+ * partitioning of runTest. The pages keep their placement. */
+void
+allocator_initChain(void* ptr, uint64_t size, int stride, int numThreads)
+{
+    allocationChunk chunk;
+    uint64_t chunksize = size / numThreads;
+    PageType pages = PAGES_DEFAULT;
+
+    chunksize -= (chunksize % stride);
+    for (int i = 0; i < numberOfAllocatedVectors; i++)
+    {
+        if (((char*) ptr >= (char*) allocList[i].ptr) &&
+            ((char*) ptr < (char*) allocList[i].ptr + allocList[i].size))
+        {
+            pages = allocList[i].pages;
+            break;
+        }
+    }
+    memset(&chunk, 0, sizeof(allocationChunk));
+    chunk.ptr = ptr;
+    chunk.type = POINTER;
+    chunk.pagesize = pageTypeSize(pages);
+    for (int i = 0; i < numThreads; i++)
+    {
+        chunk.start = i * chunksize;
+        chunk.end = (i + 1) * chunksize;
+        initChain(&chunk);
+    }
+}
 
 void
 allocator_finalize()
@@ -60,7 +480,14 @@ allocator_finalize()
 
     for (i=0; i<numberOfAllocatedVectors; i++)
     {
-        free(allocList[i].ptr);
+        if (allocList[i].pages == PAGES_HUGE_2MB || allocList[i].pages == PAGES_HUGE_1GB)
+        {
+            munmap(allocList[i].ptr, allocList[i].size);
+        }
+        else
+        {
+            free(allocList[i].ptr);
+        }
         allocList[i].ptr = NULL;
         allocList[i].size = 0;
         allocList[i].offset = 0;
@@ -82,6 +509,9 @@ allocator_dataTypeLength(DataType type)
         case DOUBLE:
             return sizeof(double);
             break;
+        case POINTER:
+            return sizeof(void*);
+            break;
         default:
             return 0;
     }
@@ -96,13 +526,22 @@ allocator_allocateVector(
         int offset,
         DataType type,
         int stride,
-        bstring domainString)
+        bstring domainString,
+        PageType pages,
+        int numThreads,
+        const int* processorIds)
 {
     int i;
     size_t bytesize = 0;
     const AffinityDomain* domain = NULL;
     int errorCode;
     int elements = 0;
+    uint64_t chunksize = 0;
+    pthread_t* threads = NULL;
+    int* started = NULL;
+    allocationChunk* chunks = NULL;
+    cpu_set_t callerSet;
+    Placement usedPlacement = placement;
 
     size_t typesize = allocator_dataTypeLength(type);
     bytesize = (size+offset) * typesize;
@@ -122,87 +561,166 @@ allocator_allocateVector(
         exit(EXIT_FAILURE);
     }
 
-    errorCode =  posix_memalign(ptr, alignment, bytesize);
-
-    if (errorCode)
+    if (pages == PAGES_HUGE_2MB || pages == PAGES_HUGE_1GB)
     {
-        if (errorCode == EINVAL)
+        /* Explicit huge pages from the hugetlbfs pool */
+        size_t hugesize = (pages == PAGES_HUGE_2MB ? HUGEPAGE_2MB : HUGEPAGE_1GB);
+        bytesize = ((bytesize + hugesize - 1) / hugesize) * hugesize;
+        *ptr = mmap(NULL, bytesize, PROT_READ|PROT_WRITE,
+                    MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB|
+                    (pages == PAGES_HUGE_2MB ? MAP_HUGE_2MB : MAP_HUGE_1GB), -1, 0);
+        if (*ptr == MAP_FAILED)
         {
-            fprintf(stderr,
-                    "Error: Alignment parameter is not a power of two\n");
+            fprintf(stderr, "Error: Cannot allocate %llu bytes with %s pages - %s\n",
+                            LLU_CAST bytesize, pageTypeNames[pages], strerror(errno));
+            fprintf(stderr, "Error: Reserve huge pages in /sys/kernel/mm/hugepages/hugepages-%lukB/nr_hugepages\n",
+                            hugesize / 1024);
             exit(EXIT_FAILURE);
         }
-        if (errorCode == ENOMEM)
+    }
+    else
+    {
+        if (pages == PAGES_THP && alignment < HUGEPAGE_2MB)
+        {
+            /* Huge pages can only back 2MB aligned parts of the vector */
+            alignment = HUGEPAGE_2MB;
+            elements = alignment / typesize;
+        }
+        errorCode =  posix_memalign(ptr, alignment, bytesize);
+
+        if (errorCode)
+        {
+            if (errorCode == EINVAL)
+            {
+                fprintf(stderr,
+                        "Error: Alignment parameter is not a power of two\n");
+                exit(EXIT_FAILURE);
+            }
+            if (errorCode == ENOMEM)
+            {
+                fprintf(stderr,
+                        "Error: Insufficient memory to fulfill the request\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        if ((*ptr) == NULL)
         {
-            fprintf(stderr,
-                    "Error: Insufficient memory to fulfill the request\n");
+            fprintf(stderr, "Error: posix_memalign failed!\n");
             exit(EXIT_FAILURE);
         }
-    }
 
-    if ((*ptr) == NULL)
-    {
-        fprintf(stderr, "Error: posix_memalign failed!\n");
-        exit(EXIT_FAILURE);
+#ifdef MADV_HUGEPAGE
+        if (pages == PAGES_THP || pages == PAGES_NOTHP)
+        {
+            if (madvise(*ptr, bytesize, (pages == PAGES_THP ? MADV_HUGEPAGE : MADV_NOHUGEPAGE)) != 0)
+            {
+                fprintf(stderr, "Warning: Cannot set %s for vector - %s\n",
+                                pageTypeNames[pages], strerror(errno));
+            }
+        }
+#else
+        if (pages == PAGES_THP || pages == PAGES_NOTHP)
+        {
+            fprintf(stderr, "Warning: Transparent huge pages not supported, ignoring %s\n",
+                            pageTypeNames[pages]);
+        }
+#endif
     }
 
     allocList[numberOfAllocatedVectors].ptr = *ptr;
     allocList[numberOfAllocatedVectors].size = bytesize;
     allocList[numberOfAllocatedVectors].offset = offset;
     allocList[numberOfAllocatedVectors].type = type;
+    allocList[numberOfAllocatedVectors].pages = pages;
     numberOfAllocatedVectors++;
 
-    affinity_pinProcess(domain->processorList[0]);
-    printf("Allocate: Process running on core %d (Domain %s) - Vector length %llu/%llu Offset %d Alignment %llu\n",
-            affinity_processGetProcessorId(),
+    if ((numThreads < 1) || (processorIds == NULL))
+    {
+        numThreads = 1;
+        processorIds = domain->processorList;
+    }
+
+    if (usedPlacement == PLACEMENT_REMOTE)
+    {
+        TopologyLookup_t lookup = get_topologyLookup();
+        NumaTopology_t numa = get_numaTopology();
+        int node = (lookup ? lookup->hwthread2numa[domain->processorList[0]] : -1);
+        /* The lookup counts the M domains in the order of the NUMA nodes,
+         * mbind needs the node ID */
+        if ((node < 0) || (lookup->numberOfNumaDomains < 2) ||
+            (numa == NULL) || (numa->numberOfNodes != lookup->numberOfNumaDomains) ||
+            (numa_membind(*ptr, bytesize, numa->nodes[(node + 1) % numa->numberOfNodes].id) < 0))
+        {
+            fprintf(stderr, "Warning: No remote NUMA domain for domain %s, using domain placement\n",
+                            bdata(domain->tag));
+            usedPlacement = PLACEMENT_DOMAIN;
+        }
+    }
+
+    printf("Allocate: Domain %s - Vector length %llu/%llu Offset %d Alignment %llu - Initialized by %d threads, placement %s\n",
             bdata(domain->tag),
             LLU_CAST size,
             LLU_CAST bytesize,
             offset,
-            LLU_CAST elements);
+            LLU_CAST elements,
+            numThreads,
+            allocator_placementName(usedPlacement));
 
-    switch ( type )
+    /* Each thread initializes the part of the vector it works on later,
+     * using the same partitioning as runTest */
+    threads = (pthread_t*) malloc(numThreads * sizeof(pthread_t));
+    chunks = (allocationChunk*) malloc(numThreads * sizeof(allocationChunk));
+    started = (int*) malloc(numThreads * sizeof(int));
+    if (!threads || !chunks || !started)
     {
-        case INT:
-            {
-                int* sptr = (int*) (*ptr);
-                sptr += offset;
-
-                for ( uint64_t i=0; i < size; i++ )
-                {
-                    sptr[i] = 1;
-                }
-                *ptr = (void*) sptr;
-
-            }
-            break;
-
-        case SINGLE:
-            {
-                float* sptr = (float*) (*ptr);
-                sptr += offset;
-
-                for ( uint64_t i=0; i < size; i++ )
-                {
-                    sptr[i] = 1.0;
-                }
-                *ptr = (void*) sptr;
-
-            }
-            break;
+        fprintf(stderr, "Error: Cannot allocate initialization threads\n");
+        exit(EXIT_FAILURE);
+    }
+    chunksize = size / numThreads;
+    chunksize -= (chunksize % stride);
+    *ptr = (void*) (((char*) (*ptr)) + offset * typesize);
 
-        case DOUBLE:
+    for (i = 0; i < numThreads; i++)
+    {
+        chunks[i].ptr = *ptr;
+        chunks[i].type = type;
+        chunks[i].placement = usedPlacement;
+        chunks[i].start = i * chunksize;
+        chunks[i].end = (i == numThreads - 1 ? size : (i + 1) * chunksize);
+        chunks[i].cpu = processorIds[i];
+        chunks[i].pagesize = pageTypeSize(pages);
+        if ((usedPlacement != PLACEMENT_LOCAL) && (!domainContains(domain, chunks[i].cpu)))
+        {
+            chunks[i].cpu = domain->processorList[i % domain->numberOfProcessors];
+        }
+        started[i] = (pthread_create(&threads[i], NULL, initChunk, (void*) &chunks[i]) == 0);
+        if (!started[i])
+        {
+            /* Touch the chunk from its CPU in this thread. The interleave
+             * policy would outlive the chunk here, so it is skipped. */
+            fprintf(stderr, "Warning: Cannot create initialization thread %d, initializing its chunk in the calling thread\n", i);
+            if (chunks[i].placement == PLACEMENT_INTERLEAVE)
             {
-                double* dptr = (double*) (*ptr);
-                dptr += offset;
-
-                for ( uint64_t i=0; i < size; i++ )
-                {
-                    dptr[i] = 1.0;
-                }
-                *ptr = (void*) dptr;
+                chunks[i].placement = PLACEMENT_DOMAIN;
             }
-            break;
+            sched_getaffinity(0, sizeof(cpu_set_t), &callerSet);
+            initChunk((void*) &chunks[i]);
+            sched_setaffinity(0, sizeof(cpu_set_t), &callerSet);
+        }
     }
+    for (i = 0; i < numThreads; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    free(started);
+    free(threads);
+    free(chunks);
+
+    printPageSize(*ptr);
+    printPagePlacement(*ptr, size * typesize);
 }
 
@@ -36,10 +36,13 @@
 
 #include <errno.h>
 #include <barrier.h>
+#include <likwid.h>
 
 /* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
 
 #define CACHELINE_SIZE 64
+/* one flag per cache line */
+#define PADDING ((int)(CACHELINE_SIZE / sizeof(int)))
 
 /* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
 
@@ -47,19 +50,222 @@ static BarrierGroup* groups;
 static int currentGroupId = 0;
 static int maxGroupId = 0;
 
+static const char* barrierTypeNames[NUM_BARRIER_TYPES] = {
+    [BARRIER_FLAT] = "flat",
+    [BARRIER_TREE] = "tree",
+    [BARRIER_DISSEMINATION] = "dissemination",
+};
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static void*
+barrier_allocFlags(int numFlags)
+{
+    void* ptr = NULL;
+
+    if (posix_memalign(&ptr, CACHELINE_SIZE, numFlags * PADDING * sizeof(int)) != 0)
+    {
+        fprintf(stderr, "ERROR: Cannot allocate barrier flags - %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    memset(ptr, 0, numFlags * PADDING * sizeof(int));
+    return ptr;
+}
+
+/* Build the gather tree of the hierarchical barrier. SMT siblings report
+ * to the first thread of their core, the core leaders report to the first
+ * core leader of their socket and the socket leaders report to thread 0.
+ * The children of each thread are stored in the order it waits for them,
+ * innermost level first, so the release can walk them in reverse order and
+ * wake up the remote sockets first. */
+static void
+barrier_buildTree(BarrierGroup* group, const int* processorIds)
+{
+    int i, j, k, l;
+    int numThreads = group->numberOfThreads;
+    int* core = (int*) malloc(numThreads * sizeof(int));
+    int* socket = (int*) malloc(numThreads * sizeof(int));
+    int* parent = (int*) malloc(numThreads * sizeof(int));
+    int* level = (int*) malloc(numThreads * sizeof(int));
+    TopologyLookup_t lookup = get_topologyLookup();
+
+    group->childOffsets = (int*) malloc((numThreads + 1) * sizeof(int));
+    group->children = (int*) malloc(numThreads * sizeof(int));
+    if (!core || !socket || !parent || !level ||
+        !group->childOffsets || !group->children)
+    {
+        fprintf(stderr, "ERROR: Cannot allocate barrier tree - %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < numThreads; i++)
+    {
+        int cpu = (processorIds ? processorIds[i] : -1);
+        if (lookup && cpu >= 0 && cpu < (int)lookup->numberOfHWThreads &&
+            lookup->hwthread2core[cpu] >= 0)
+        {
+            core[i] = lookup->hwthread2core[cpu];
+            socket[i] = lookup->hwthread2socket[cpu];
+        }
+        else
+        {
+            /* Unknown placement, every thread is its own core */
+            core[i] = -1 - i;
+            socket[i] = -1;
+        }
+    }
+
+    parent[0] = -1;
+    level[0] = -1;
+    for (i = 1; i < numThreads; i++)
+    {
+        for (j = 0; core[j] != core[i]; j++);
+        if (j != i)
+        {
+            /* SMT sibling of an earlier thread */
+            parent[i] = j;
+            level[i] = 0;
+            continue;
+        }
+        for (j = 0; j < i; j++)
+        {
+            if (socket[j] == socket[i] && (j == 0 || level[j] != 0))
+            {
+                break;
+            }
+        }
+        if (j != i)
+        {
+            /* First thread of its core but not of its socket */
+            parent[i] = j;
+            level[i] = 1;
+        }
+        else
+        {
+            parent[i] = 0;
+            level[i] = 2;
+        }
+    }
+
+    k = 0;
+    for (i = 0; i < numThreads; i++)
+    {
+        group->childOffsets[i] = k;
+        for (l = 0; l < 3; l++)
+        {
+            for (j = 1; j < numThreads; j++)
+            {
+                if (parent[j] == i && level[j] == l)
+                {
+                    group->children[k++] = j;
+                }
+            }
+        }
+    }
+    group->childOffsets[numThreads] = k;
+
+    free(core);
+    free(socket);
+    free(parent);
+    free(level);
+}
+
+static void
+barrier_synchronizeFlat(BarrierData* barr)
+{
+    int i;
+
+    barr->bval[barr->index[0] * 32 +  barr->offset * 16] = barr->val;
+
+    for (i = 1; i < barr->numberOfThreads; i++)
+    {
+        while (barr->bval[barr->index[i] * 32 + barr->offset * 16] != barr->val)
+        {
+            __asm__ ("pause");
+        }
+    }
+
+    if (barr->offset)
+    {
+        barr->val = !barr->val;
+    }
+    barr->offset = !barr->offset;
+}
+
+static void
+barrier_synchronizeTree(BarrierData* barr)
+{
+    int i;
+    int episode = ++barr->episode;
+
+    for (i = 0; i < barr->numberOfChildren; i++)
+    {
+        while (barr->arrive[barr->children[i] * PADDING] != episode)
+        {
+            __asm__ ("pause");
+        }
+    }
+
+    if (barr->threadId != 0)
+    {
+        barr->arrive[barr->threadId * PADDING] = episode;
+        while (barr->release[barr->threadId * PADDING] != episode)
+        {
+            __asm__ ("pause");
+        }
+    }
+
+    for (i = barr->numberOfChildren - 1; i >= 0; i--)
+    {
+        barr->release[barr->children[i] * PADDING] = episode;
+    }
+}
+
+/* Dissemination barrier: in round k every thread signals the thread 2^k
+ * positions ahead and waits for the one 2^k positions behind. Two flag sets
+ * are used alternately so a fast thread cannot overwrite a flag of the
+ * previous episode that has not been seen yet. */
+static void
+barrier_synchronizeDissemination(BarrierData* barr)
+{
+    int k;
+    int episode = ++barr->episode;
+    int parity = episode & 1;
+    int numThreads = barr->numberOfThreads;
+
+    for (k = 0; k < barr->rounds; k++)
+    {
+        int partner = (barr->threadId + (1 << k)) % numThreads;
+        barr->flags[((partner * 2 + parity) * barr->rounds + k) * PADDING] = episode;
+        while (barr->flags[((barr->threadId * 2 + parity) * barr->rounds + k) * PADDING] != episode)
+        {
+            __asm__ ("pause");
+        }
+    }
+}
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 int
-barrier_registerGroup(int numThreads)
+barrier_registerGroup(int numThreads, const int* processorIds, BarrierType type)
 {
     int ret;
+    BarrierGroup* group;
 
     if (currentGroupId > maxGroupId)
     {
         fprintf(stderr, "ERROR: Group ID %d larger than maxGroupID %d\n",currentGroupId,maxGroupId);
     }
 
-    groups[currentGroupId].numberOfThreads = numThreads;
+    group = &groups[currentGroupId];
+    group->numberOfThreads = numThreads;
+    group->type = type;
+    group->childOffsets = NULL;
+    group->children = NULL;
+    group->arrive = NULL;
+    group->release = NULL;
+    group->flags = NULL;
+    group->rounds = 0;
     ret = posix_memalign(
             (void**) &groups[currentGroupId].groupBval,
             CACHELINE_SIZE,
@@ -71,6 +277,24 @@ barrier_registerGroup(int numThreads)
         exit(EXIT_FAILURE);
     }
 
+    switch (type)
+    {
+        case BARRIER_TREE:
+            barrier_buildTree(group, processorIds);
+            group->arrive = barrier_allocFlags(numThreads);
+            group->release = barrier_allocFlags(numThreads);
+            break;
+        case BARRIER_DISSEMINATION:
+            while ((1 << group->rounds) < numThreads)
+            {
+                group->rounds++;
+            }
+            group->flags = barrier_allocFlags(numThreads * 2 * (group->rounds > 0 ? group->rounds : 1));
+            break;
+        default:
+            break;
+    }
+
     return currentGroupId++;
 }
 
@@ -93,6 +317,21 @@ barrier_registerThread(BarrierData* barr, int groupId, int threadId)
     barr->offset = 0;
     barr->val = 1;
     barr->bval =  groups[groupId].groupBval;
+    barr->type = groups[groupId].type;
+    barr->threadId = threadId;
+    barr->episode = 0;
+    barr->numberOfChildren = 0;
+    barr->children = NULL;
+    barr->rounds = groups[groupId].rounds;
+    barr->arrive = groups[groupId].arrive;
+    barr->release = groups[groupId].release;
+    barr->flags = groups[groupId].flags;
+    if (barr->type == BARRIER_TREE)
+    {
+        barr->children = groups[groupId].children + groups[groupId].childOffsets[threadId];
+        barr->numberOfChildren = groups[groupId].childOffsets[threadId+1] -
+                                 groups[groupId].childOffsets[threadId];
+    }
     ret = posix_memalign(
             (void**) &(barr->index),
             CACHELINE_SIZE, 
@@ -131,32 +370,72 @@ barrier_init(int numberOfGroups)
 void
 barrier_synchronize(BarrierData* barr)
 {
-    int i;
+    switch (barr->type)
+    {
+        case BARRIER_TREE:
+            barrier_synchronizeTree(barr);
+            break;
+        case BARRIER_DISSEMINATION:
+            barrier_synchronizeDissemination(barr);
+            break;
+        default:
+            barrier_synchronizeFlat(barr);
+            break;
+    }
+}
 
-    barr->bval[barr->index[0] * 32 +  barr->offset * 16] = barr->val;
+void barrier_destroy(BarrierData* barr)
+{
+    free(barr->index);
+    barr->index = NULL;
+}
 
-    for (i = 1; i < barr->numberOfThreads; i++)
+void
+barrier_finalize(void)
+{
+    int i;
+
+    if (!groups)
     {
-        while (barr->bval[barr->index[i] * 32 + barr->offset * 16] != barr->val)
-        {
-            __asm__ ("pause");
-        }
+        return;
     }
+    for (i = 0; i < currentGroupId; i++)
+    {
+        free(groups[i].groupBval);
+        free(groups[i].childOffsets);
+        free(groups[i].children);
+        free(groups[i].arrive);
+        free(groups[i].release);
+        free(groups[i].flags);
+    }
+    free(groups);
+    groups = NULL;
+    currentGroupId = 0;
+    maxGroupId = 0;
+}
 
-    if (barr->offset)
+int
+barrier_typeFromString(const char* name)
+{
+    int i;
+
+    for (i = 0; i < NUM_BARRIER_TYPES; i++)
     {
-        barr->val = !barr->val;
+        if (strcmp(name, barrierTypeNames[i]) == 0)
+        {
+            return i;
+        }
     }
-    barr->offset = !barr->offset;
+    return -1;
 }
 
-void barrier_destroy(BarrierData* barr)
+const char*
+barrier_typeName(BarrierType type)
 {
-    if (currentGroupId > maxGroupId)
+    if (type < 0 || type >= NUM_BARRIER_TYPES)
     {
-        fprintf(stderr, "ERROR: Group ID %d larger than maxGroupID %d\n",currentGroupId,maxGroupId);
+        return "unknown";
     }
-    free(barr->index);
-    free(groups[currentGroupId].groupBval);
+    return barrierTypeNames[type];
 }
 
@@ -48,13 +48,71 @@
 
 #define BARRIER   barrier_synchronize(&barr)
 
+/* Number of barrier calls timed to determine the cost of a single barrier */
+#define BARRIER_CALIBRATION 1000
+
+/* Bytes per stream a throttled kernel processes between two delays */
+#define THROTTLE_CHUNK 4096
+
+/* Run the kernel on chunks of the vectors with the injection delay after
+ * each chunk, load threads stop early once all probe threads are done */
+#define THROTTLE(func) \
+    for (chunk=0; chunk<fullSize; chunk+=chunkLength) \
+    { \
+        size = (fullSize - chunk < chunkLength ? fullSize - chunk : chunkLength); \
+        for (j=0; j<myData->test->streams; j++) \
+        { \
+            myData->streams[j] = (char*) base[j] + chunk * typeLength; \
+        } \
+        func; \
+        processed += size; \
+        throttleDelay(myData->delay); \
+        if ((myData->probes != NULL) && (!myData->probe) && (*myData->probes == 0)) \
+        { \
+            break; \
+        } \
+    } \
+    size = fullSize
+
+/* In the loaded latency mode the load threads repeat the kernel until all
+ * probe threads are done, the number of elements they managed is stored.
+ * A throttled load thread may stop within an iteration, so whole
+ * iterations would overstate its traffic. */
 #define EXECUTE(func)   \
     BARRIER; \
     LIKWID_MARKER_START("bench");  \
     timer_start(&time); \
+    processed = 0; \
     for (i=0; i<myData->iter; i++) \
     {   \
-        func; \
+        if (myData->delay > 0) \
+        { \
+            THROTTLE(func); \
+        } \
+        else \
+        { \
+            func; \
+            processed += size; \
+        } \
+        if ((myData->probes != NULL) && (!myData->probe) && (*myData->probes == 0)) \
+        { \
+            i++; \
+            break; \
+        } \
+    } \
+    timer_stop(&time); \
+    data->loopCycles = timer_printCycles(&time); \
+    if (myData->probes != NULL) \
+    { \
+        if (myData->probe) \
+        { \
+            __sync_fetch_and_sub(myData->probes, 1); \
+        } \
+        else \
+        { \
+            myData->iter = i; \
+            myData->processed = processed; \
+        } \
     } \
     BARRIER; \
     timer_stop(&time); \
@@ -63,6 +121,25 @@
     BARRIER
 
 
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE  ############ */
+
+static inline uint64_t
+readTsc(void)
+{
+    uint32_t lo, hi;
+
+    __asm__ volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((uint64_t) hi << 32) | lo;
+}
+
+static inline void
+throttleDelay(uint64_t cycles)
+{
+    uint64_t start = readTsc();
+
+    while (readTsc() - start < cycles);
+}
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 void*
@@ -73,6 +150,13 @@ runTest(void* arg)
     size_t size;
     size_t vecsize;
     size_t i;
+    size_t j;
+    size_t chunk;
+    size_t chunkLength = 0;
+    size_t fullSize = 0;
+    size_t typeLength = 0;
+    uint64_t processed = 0;
+    void** base = NULL;
     BarrierData barr;
     ThreadData* data;
     ThreadUserData* myData;
@@ -83,7 +167,7 @@ runTest(void* arg)
     myData = &(data->data);
     func = myData->test->kernel;
     threadId = data->threadId;
-    barrier_registerThread(&barr, 0, data->globalThreadId);
+    barrier_registerThread(&barr, myData->barrierGroup, data->globalThreadId);
 
     /* Prepare ptrs for thread */
     vecsize = myData->size / data->numberOfThreads;
@@ -93,7 +177,7 @@ runTest(void* arg)
     myData->size = size;
     offset = data->threadId * size;
     //printf("Orig size %lu Size %lu\n", myData->size / data->numberOfThreads, size);
-    if (size != vecsize && data->threadId == 0)
+    if (size != vecsize && data->threadId == 0 && !myData->quiet)
         printf("Sanitizing vector length to a multiple of the loop stride from %d elements (%d bytes) to %d elements (%d bytes)\n", vecsize, vecsize*myData->test->bytes, size, size*myData->test->bytes);
 
     switch ( myData->test->type )
@@ -131,19 +215,60 @@ runTest(void* arg)
                 }
             }
             break;
+        case POINTER:
+            {
+                void** pptr;
+                for (i=0; i <  myData->test->streams; i++)
+                {
+                    pptr = (void**) myData->streams[i];
+                    pptr +=  offset;
+                    myData->streams[i] = (void**) pptr;
+                }
+            }
+            break;
+    }
+
+    if (myData->delay > 0)
+    {
+        fullSize = size;
+        typeLength = allocator_dataTypeLength(myData->test->type);
+        chunkLength = THROTTLE_CHUNK / typeLength;
+        chunkLength -= (chunkLength % myData->test->stride);
+        if (chunkLength == 0)
+        {
+            chunkLength = myData->test->stride;
+        }
+        base = (void**) malloc(myData->test->streams * sizeof(void*));
+        for (j=0; j<myData->test->streams; j++)
+        {
+            base[j] = myData->streams[j];
+        }
     }
 
     /* pin the thread */
     likwid_pinThread(myData->processors[threadId]);
-    printf("Group: %d Thread %d Global Thread %d running on core %d - Vector length %llu Offset %d\n",
-            data->groupId,
-            threadId,
-            data->globalThreadId,
-            affinity_threadGetProcessorId(),
-            LLU_CAST size,
-            offset);
+    if (!myData->quiet)
+    {
+        printf("Group: %d Thread %d Global Thread %d running on core %d - Vector length %llu Offset %d\n",
+                data->groupId,
+                threadId,
+                data->globalThreadId,
+                affinity_threadGetProcessorId(),
+                LLU_CAST size,
+                offset);
+    }
     BARRIER;
 
+    /* Measure the cost of a single barrier, the timed region of each test
+     * includes one barrier */
+    timer_start(&time);
+    for (i=0; i<BARRIER_CALIBRATION; i++)
+    {
+        BARRIER;
+    }
+    timer_stop(&time);
+    data->barrierCycles = timer_printCycles(&time) / BARRIER_CALIBRATION;
+
     /* Up to 10 streams the following registers are used for Array ptr:
      * Size rdi
      * in Registers: rsi  rdx  rcx  r8  r9
@@ -433,7 +558,8 @@ runTest(void* arg)
             break;
     }
     free(barr.index);
-    pthread_exit(NULL);
+    free(base);
+    return NULL;
 }
 
 #define MEASURE(func) \
@@ -0,0 +1,342 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  c2c.c
+ *
+ *      Description:  Core-to-core cache line transfer latency and contended atomics
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:  Jan Treibig (jt), jan.treibig@gmail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include <c2c.h>
+#include <likwid.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define CACHELINE_SIZE 64
+#define C2C_DEFAULT_ROUNDS 10000
+/* Transfers before the timed rounds */
+#define C2C_WARMUP(rounds) ((rounds) / 10 > 10 ? (rounds) / 10 : 10)
+#define C2C_PAGE 4096
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+static TopologyLookup_t lookup = NULL;
+
+static const char* c2cTypeNames[NUM_C2C_TYPES] = {
+    [C2C_PINGPONG] = "pingpong",
+    [C2C_ATOMIC] = "atomic",
+};
+
+static const char* c2cRelationNames[NUM_C2C_RELATIONS] = {
+    [C2C_SMT] = "Same core (SMT)",
+    [C2C_CACHE] = "Same LLC",
+    [C2C_NUMA] = "Same NUMA node",
+    [C2C_SOCKET] = "Same socket",
+    [C2C_REMOTE] = "Other socket",
+};
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static int
+knownCpu(int cpu)
+{
+    return (lookup && cpu >= 0 && cpu < (int)lookup->numberOfHWThreads &&
+            lookup->hwthread2core[cpu] >= 0);
+}
+
+static C2cRelation
+c2cRelation(int a, int b)
+{
+    if (!knownCpu(a) || !knownCpu(b))
+    {
+        return C2C_REMOTE;
+    }
+    if (lookup->hwthread2core[a] == lookup->hwthread2core[b])
+        return C2C_SMT;
+    if (lookup->hwthread2cache[a] == lookup->hwthread2cache[b])
+        return C2C_CACHE;
+    if (lookup->hwthread2numa[a] == lookup->hwthread2numa[b])
+        return C2C_NUMA;
+    if (lookup->hwthread2socket[a] == lookup->hwthread2socket[b])
+        return C2C_SOCKET;
+    return C2C_REMOTE;
+}
+
+/* Order the HW threads by socket, NUMA node, LLC, core and SMT thread so that
+ * the levels form blocks in the matrix */
+static int
+compareCpus(const void* pa, const void* pb)
+{
+    int a = *(const int*) pa;
+    int b = *(const int*) pb;
+
+    if (knownCpu(a) && knownCpu(b))
+    {
+        int keyA[5] = {lookup->hwthread2socket[a], lookup->hwthread2numa[a],
+                       lookup->hwthread2cache[a], lookup->hwthread2core[a],
+                       lookup->hwthread2smt[a]};
+        int keyB[5] = {lookup->hwthread2socket[b], lookup->hwthread2numa[b],
+                       lookup->hwthread2cache[b], lookup->hwthread2core[b],
+                       lookup->hwthread2smt[b]};
+        for (int i = 0; i < 5; i++)
+        {
+            if (keyA[i] != keyB[i])
+            {
+                return keyA[i] - keyB[i];
+            }
+        }
+    }
+    return a - b;
+}
+
+/* The initiator owns the cache line at the start and takes the time */
+static void*
+c2cInitiator(void* arg)
+{
+    C2cPair* pair = (C2cPair*) arg;
+    volatile uint64_t* line = pair->line;
+    uint64_t warmup = C2C_WARMUP(pair->rounds);
+    TimerData time;
+
+    likwid_pinThread(pair->cpus[0]);
+    *line = 0;
+    if (pair->type == C2C_PINGPONG)
+    {
+        *pair->start = 1;
+        for (uint64_t r = 0; r < warmup + pair->rounds; r++)
+        {
+            if (r == warmup)
+            {
+                timer_start(&time);
+            }
+            *line = 2 * r + 1;
+            while (*line != 2 * r + 2);
+        }
+        timer_stop(&time);
+        /* one round trip are two transfers */
+        pair->cycles = timer_printCycles(&time) / 2;
+    }
+    else
+    {
+        *pair->start = 1;
+        while (*pair->start != 2);
+        timer_start(&time);
+        for (uint64_t r = 0; r < pair->rounds; r++)
+        {
+            __sync_fetch_and_add(line, 1);
+        }
+        while (*line != 2 * pair->rounds);
+        timer_stop(&time);
+        /* both threads increment the counter */
+        pair->cycles = timer_printCycles(&time) / 2;
+    }
+    return NULL;
+}
+
+static void*
+c2cPartner(void* arg)
+{
+    C2cPair* pair = (C2cPair*) arg;
+    volatile uint64_t* line = pair->line;
+    uint64_t warmup = C2C_WARMUP(pair->rounds);
+
+    likwid_pinThread(pair->cpus[1]);
+    while (*pair->start == 0);
+    if (pair->type == C2C_PINGPONG)
+    {
+        for (uint64_t r = 0; r < warmup + pair->rounds; r++)
+        {
+            while (*line != 2 * r + 1);
+            *line = 2 * r + 2;
+        }
+    }
+    else
+    {
+        *pair->start = 2;
+        for (uint64_t r = 0; r < pair->rounds; r++)
+        {
+            __sync_fetch_and_add(line, 1);
+        }
+    }
+    return NULL;
+}
+
+static double
+c2cMeasure(C2cType type, int cpuA, int cpuB, uint64_t rounds)
+{
+    C2cPair pair;
+    pthread_t threads[2];
+    void* page = NULL;
+
+    /* A fresh page per pair, it is first touched by the initiator */
+    page = mmap(NULL, C2C_PAGE, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (page == MAP_FAILED)
+    {
+        fprintf(stderr, "Error: Cannot allocate cache line - %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    pair.type = type;
+    pair.cpus[0] = cpuA;
+    pair.cpus[1] = cpuB;
+    pair.rounds = rounds;
+    pair.line = (volatile uint64_t*) page;
+    pair.start = (volatile uint64_t*) ((char*) page + CACHELINE_SIZE);
+    pair.cycles = 0;
+
+    pthread_create(&threads[1], NULL, c2cPartner, (void*) &pair);
+    pthread_create(&threads[0], NULL, c2cInitiator, (void*) &pair);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    munmap(page, C2C_PAGE);
+    return (double) pair.cycles / rounds;
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+c2c_typeFromString(const char* name)
+{
+    for (int i = 0; i < NUM_C2C_TYPES; i++)
+    {
+        if (strcmp(name, c2cTypeNames[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char*
+c2c_typeName(C2cType type)
+{
+    if (type < 0 || type >= NUM_C2C_TYPES)
+    {
+        return "unknown";
+    }
+    return c2cTypeNames[type];
+}
+
+void
+c2c_runMatrix(C2cType type, int numCpus, const int* cpus, uint64_t rounds, uint64_t cyclesClock)
+{
+    int* sorted = (int*) malloc(numCpus * sizeof(int));
+    double* matrix = (double*) malloc(numCpus * numCpus * sizeof(double));
+    int count[NUM_C2C_RELATIONS];
+    double min[NUM_C2C_RELATIONS];
+    double max[NUM_C2C_RELATIONS];
+    double sum[NUM_C2C_RELATIONS];
+
+    if (!sorted || !matrix)
+    {
+        fprintf(stderr, "Error: Cannot allocate transfer matrix\n");
+        exit(EXIT_FAILURE);
+    }
+    if (rounds == 0)
+    {
+        rounds = C2C_DEFAULT_ROUNDS;
+    }
+    lookup = get_topologyLookup();
+    memcpy(sorted, cpus, numCpus * sizeof(int));
+    qsort(sorted, numCpus, sizeof(int), compareCpus);
+    for (int i = 0; i < NUM_C2C_RELATIONS; i++)
+    {
+        count[i] = 0;
+        min[i] = 0;
+        max[i] = 0;
+        sum[i] = 0;
+    }
+
+    /* The transfer is symmetric, every pair is measured once */
+    for (int i = 0; i < numCpus; i++)
+    {
+        matrix[i * numCpus + i] = 0;
+        for (int j = i + 1; j < numCpus; j++)
+        {
+            double cycles = c2cMeasure(type, sorted[i], sorted[j], rounds);
+            C2cRelation rel = c2cRelation(sorted[i], sorted[j]);
+            matrix[i * numCpus + j] = cycles;
+            matrix[j * numCpus + i] = cycles;
+            if (count[rel] == 0 || cycles < min[rel])
+                min[rel] = cycles;
+            if (count[rel] == 0 || cycles > max[rel])
+                max[rel] = cycles;
+            sum[rel] += cycles;
+            count[rel]++;
+        }
+    }
+
+    printf("Cache line transfer:\t%s\n", c2c_typeName(type));
+    printf("Rounds per pair:\t%" PRIu64 "\n", rounds);
+    printf("Cycles per %s between HW threads:\n",
+            (type == C2C_PINGPONG ? "one-way transfer" : "atomic increment"));
+    printf("HWThread");
+    for (int j = 0; j < numCpus; j++)
+    {
+        printf(" %8d", sorted[j]);
+    }
+    printf("\n");
+    for (int i = 0; i < numCpus; i++)
+    {
+        printf("%-8d", sorted[i]);
+        for (int j = 0; j < numCpus; j++)
+        {
+            if (i == j)
+                printf(" %8s", "-");
+            else
+                printf(" %8.1f", matrix[i * numCpus + j]);
+        }
+        printf("\n");
+    }
+    printf("\n");
+    printf("%-18s%8s%10s%10s%10s%10s%s\n", "Level", "Pairs", "Min", "Avg", "Max", "Avg ns",
+            (type == C2C_ATOMIC ? "    MOps/s" : ""));
+    for (int i = 0; i < NUM_C2C_RELATIONS; i++)
+    {
+        double avg = 0;
+        if (count[i] == 0)
+        {
+            continue;
+        }
+        avg = sum[i] / count[i];
+        printf("%-18s%8d%10.1f%10.1f%10.1f%10.1f", c2cRelationNames[i], count[i],
+                min[i], avg, max[i], 1.0E09 * avg / (double) cyclesClock);
+        if (type == C2C_ATOMIC)
+        {
+            printf("%10.1f", 1.0E-06 * (double) cyclesClock / avg);
+        }
+        printf("\n");
+    }
+    free(sorted);
+    free(matrix);
+}
@@ -0,0 +1,1036 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  ptt.c
+ *
+ *      Description:  Runtime loader and x86-64 encoder for ptt benchmark kernels.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:  Jan Treibig (jt), jan.treibig@gmail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include <ptt.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define PTT_CODE_SIZE (256*1024)
+#define PTT_MAX_LINE 1024
+#define PTT_MAX_STREAMS 10
+#define PTT_MAX_OPERANDS 3
+#define PTT_MAX_FIXUPS 4096
+/* Longest x86-64 instruction */
+#define PTT_MAX_INSTR 15
+/* Loop start: xor rax, rax and the alignment to 16 bytes */
+#define PTT_LOOP_START_SIZE (3 + 15)
+/* Loop end: add rax, imm32, cmp rax, rdi and jl rel32 */
+#define PTT_LOOP_END_SIZE (6 + 3 + 6)
+#define PTT_EPILOGUE_SIZE 14
+/* Space emitted after the last instruction: loop end, epilogue, alignment
+ * to 64 bytes and 64 bytes per scalar constant */
+#define PTT_TAIL_SIZE (PTT_LOOP_END_SIZE + PTT_EPILOGUE_SIZE + 63 + NUM_SCALARS * 64)
+
+#define PTT_RIP -2
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+typedef enum {
+    OP_NONE = 0,
+    OP_XMM,
+    OP_YMM,
+    OP_ZMM,
+    OP_MMX,
+    OP_GPR,
+    OP_MEM
+} PttOperandType;
+
+typedef enum {
+    SCALAR_DOUBLE = 0,
+    SCALAR_SINGLE,
+    SCALAR_INT,
+    NUM_SCALARS
+} PttScalar;
+
+typedef struct {
+    PttOperandType type;
+    int reg;
+    int base;
+    int index;
+    int scale;
+    int32_t disp;
+    int scalar;
+} PttOperand;
+
+typedef enum {
+    ENC_SSE = 0,
+    ENC_MMX,
+    ENC_AVX,
+    ENC_GPR
+} PttEncoding;
+
+typedef struct {
+    const char* name;
+    PttEncoding enc;
+    uint8_t prefix; /* mandatory prefix 0x66, 0xF2, 0xF3 or 0 */
+    uint8_t map; /* opcode map 0: none, 1: 0F, 2: 0F38 */
+    uint8_t load; /* opcode of the reg <- r/m form, 0 if not available */
+    uint8_t store; /* opcode of the r/m <- reg form, 0 if not available */
+    uint8_t vexW; /* VEX.W, REX.W for the general purpose registers */
+    uint8_t evexW;
+    int nds; /* AVX three operand form dst, src1, src2 */
+} PttInstruction;
+
+typedef struct {
+    uint8_t* code;
+    size_t pos;
+    int numFixups;
+    size_t fixupPos[PTT_MAX_FIXUPS];
+    /* rip-relative displacements count from the end of the instruction,
+     * which differs from fixupPos + 4 if an immediate follows */
+    size_t fixupEnd[PTT_MAX_FIXUPS];
+    PttScalar fixupScalar[PTT_MAX_FIXUPS];
+} PttBuffer;
+
+/* The instructions used by the kernels in bench/x86-64 */
+static const PttInstruction pttInstructions[] = {
+    {"movaps",      ENC_SSE, 0x00, 1, 0x28, 0x29, 0, 0, 0},
+    {"movapd",      ENC_SSE, 0x66, 1, 0x28, 0x29, 0, 0, 0},
+    {"movsd",       ENC_SSE, 0xF2, 1, 0x10, 0x11, 0, 0, 0},
+    {"movss",       ENC_SSE, 0xF3, 1, 0x10, 0x11, 0, 0, 0},
+    {"movntps",     ENC_SSE, 0x00, 1, 0x00, 0x2B, 0, 0, 0},
+    {"movntpd",     ENC_SSE, 0x66, 1, 0x00, 0x2B, 0, 0, 0},
+    {"movntdq",     ENC_SSE, 0x66, 1, 0x00, 0xE7, 0, 0, 0},
+    {"movntdqa",    ENC_SSE, 0x66, 2, 0x2A, 0x00, 0, 0, 0},
+    {"addps",       ENC_SSE, 0x00, 1, 0x58, 0x00, 0, 0, 0},
+    {"addpd",       ENC_SSE, 0x66, 1, 0x58, 0x00, 0, 0, 0},
+    {"addss",       ENC_SSE, 0xF3, 1, 0x58, 0x00, 0, 0, 0},
+    {"addsd",       ENC_SSE, 0xF2, 1, 0x58, 0x00, 0, 0, 0},
+    {"mulps",       ENC_SSE, 0x00, 1, 0x59, 0x00, 0, 0, 0},
+    {"mulpd",       ENC_SSE, 0x66, 1, 0x59, 0x00, 0, 0, 0},
+    {"mulss",       ENC_SSE, 0xF3, 1, 0x59, 0x00, 0, 0, 0},
+    {"mulsd",       ENC_SSE, 0xF2, 1, 0x59, 0x00, 0, 0, 0},
+    {"xorps",       ENC_SSE, 0x00, 1, 0x57, 0x00, 0, 0, 0},
+    {"xorpd",       ENC_SSE, 0x66, 1, 0x57, 0x00, 0, 0, 0},
+    {"movq",        ENC_MMX, 0x00, 1, 0x6F, 0x7F, 0, 0, 0},
+    {"movntq",      ENC_MMX, 0x00, 1, 0x00, 0xE7, 0, 0, 0},
+    {"mov",         ENC_GPR, 0x00, 0, 0x8B, 0x89, 1, 0, 0},
+    {"vmovaps",     ENC_AVX, 0x00, 1, 0x28, 0x29, 0, 0, 0},
+    {"vmovapd",     ENC_AVX, 0x66, 1, 0x28, 0x29, 0, 1, 0},
+    {"vmovntps",    ENC_AVX, 0x00, 1, 0x00, 0x2B, 0, 0, 0},
+    {"vmovntpd",    ENC_AVX, 0x66, 1, 0x00, 0x2B, 0, 1, 0},
+    {"vaddps",      ENC_AVX, 0x00, 1, 0x58, 0x00, 0, 0, 1},
+    {"vaddpd",      ENC_AVX, 0x66, 1, 0x58, 0x00, 0, 1, 1},
+    {"vmulps",      ENC_AVX, 0x00, 1, 0x59, 0x00, 0, 0, 1},
+    {"vmulpd",      ENC_AVX, 0x66, 1, 0x59, 0x00, 0, 1, 1},
+    {"vxorps",      ENC_AVX, 0x00, 1, 0x57, 0x00, 0, 0, 1},
+    {"vxorpd",      ENC_AVX, 0x66, 1, 0x57, 0x00, 0, 1, 1},
+    {"vfmadd213ps", ENC_AVX, 0x66, 2, 0xA8, 0x00, 0, 0, 1},
+    {"vfmadd213pd", ENC_AVX, 0x66, 2, 0xA8, 0x00, 1, 1, 1},
+};
+
+/* Registers of the GPRx names and the stream pointers as in perl/isax86_64.pm
+ * and perl/templates/bench.tt. STR0-STR4 are the argument registers, STR5-STR9
+ * are loaded from the stack into r10-r14 */
+static const int gprRegs[] = {0, 3, 1, 2, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+static const int streamRegs[PTT_MAX_STREAMS] = {6, 2, 1, 8, 9, 10, 11, 12, 13, 14};
+
+static const char* scalarNames[NUM_SCALARS] = {
+    [SCALAR_DOUBLE] = "SCALAR",
+    [SCALAR_SINGLE] = "SSCALAR",
+    [SCALAR_INT] = "ISCALAR",
+};
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static char*
+trim(char* str)
+{
+    char* end;
+
+    while (isspace((unsigned char)*str))
+    {
+        str++;
+    }
+    end = str + strlen(str);
+    while (end > str && isspace((unsigned char)end[-1]))
+    {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+static int
+parseNumberedName(const char* str, const char* prefix, int* num)
+{
+    size_t len = strlen(prefix);
+    char* end = NULL;
+    long val;
+
+    if (strncasecmp(str, prefix, len) != 0 || !isdigit((unsigned char)str[len]))
+    {
+        return 0;
+    }
+    val = strtol(str + len, &end, 10);
+    if (*end != '\0')
+    {
+        return 0;
+    }
+    *num = (int) val;
+    return 1;
+}
+
+static int
+parseMemory(char* str, PttOperand* op, int numStreams)
+{
+    char* term;
+    char* next;
+    int sign = 1;
+    int num = 0;
+
+    op->type = OP_MEM;
+    op->base = -1;
+    op->index = -1;
+    op->scale = 1;
+    op->disp = 0;
+    op->scalar = -1;
+
+    term = str;
+    while (term)
+    {
+        int nextSign = 1;
+        char* star;
+
+        next = strpbrk(term, "+-");
+        if (next)
+        {
+            nextSign = (*next == '-' ? -1 : 1);
+            *next = '\0';
+            next++;
+        }
+        term = trim(term);
+        star = strchr(term, '*');
+        if (star)
+        {
+            *star = '\0';
+            char* reg = trim(term);
+            char* scale = trim(star + 1);
+            op->scale = atoi(scale);
+            if (!parseNumberedName(reg, "GPR", &num) || num < 1 || num > 14 || sign < 0 ||
+                (op->scale != 1 && op->scale != 2 && op->scale != 4 && op->scale != 8))
+            {
+                return -EINVAL;
+            }
+            op->index = gprRegs[num-1];
+        }
+        else if (strcasecmp(term, "rip") == 0)
+        {
+            op->base = PTT_RIP;
+        }
+        else if (parseNumberedName(term, "STR", &num))
+        {
+            if (num >= numStreams || op->base != -1 || sign < 0)
+            {
+                return -EINVAL;
+            }
+            op->base = streamRegs[num];
+        }
+        else if (parseNumberedName(term, "GPR", &num))
+        {
+            if (num < 1 || num > 14 || sign < 0)
+            {
+                return -EINVAL;
+            }
+            if (op->base == -1)
+            {
+                op->base = gprRegs[num-1];
+            }
+            else if (op->index == -1)
+            {
+                op->index = gprRegs[num-1];
+            }
+            else
+            {
+                return -EINVAL;
+            }
+        }
+        else if (isdigit((unsigned char)term[0]))
+        {
+            char* end = NULL;
+            long val = strtol(term, &end, 0);
+            if (*end != '\0')
+            {
+                return -EINVAL;
+            }
+            op->disp += sign * val;
+        }
+        else
+        {
+            int i;
+            for (i = 0; i < NUM_SCALARS; i++)
+            {
+                if (strcmp(term, scalarNames[i]) == 0)
+                {
+                    op->scalar = i;
+                    break;
+                }
+            }
+            if (i == NUM_SCALARS || sign < 0)
+            {
+                return -EINVAL;
+            }
+        }
+        sign = nextSign;
+        term = next;
+    }
+
+    if ((op->base == PTT_RIP) != (op->scalar >= 0))
+    {
+        /* rip-relative addressing is only possible for the scalar constants */
+        return -EINVAL;
+    }
+    if (op->base == -1 || (op->base == PTT_RIP && op->index != -1) || op->index == 4)
+    {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+static int
+parseOperand(char* str, PttOperand* op, int numStreams)
+{
+    int num = 0;
+    size_t len = strlen(str);
+
+    memset(op, 0, sizeof(PttOperand));
+    if (str[0] == '[')
+    {
+        if (str[len-1] != ']')
+        {
+            return -EINVAL;
+        }
+        str[len-1] = '\0';
+        return parseMemory(str + 1, op, numStreams);
+    }
+    if (parseNumberedName(str, "FPR", &num) && num >= 1 && num <= 16)
+    {
+        op->type = OP_XMM;
+        op->reg = num - 1;
+    }
+    else if (parseNumberedName(str, "xmm", &num) && num < 16)
+    {
+        op->type = OP_XMM;
+        op->reg = num;
+    }
+    else if (parseNumberedName(str, "ymm", &num) && num < 16)
+    {
+        op->type = OP_YMM;
+        op->reg = num;
+    }
+    else if (parseNumberedName(str, "zmm", &num) && num < 32)
+    {
+        op->type = OP_ZMM;
+        op->reg = num;
+    }
+    else if (parseNumberedName(str, "mm", &num) && num < 8)
+    {
+        op->type = OP_MMX;
+        op->reg = num;
+    }
+    else if (parseNumberedName(str, "GPR", &num) && num >= 1 && num <= 14)
+    {
+        op->type = OP_GPR;
+        op->reg = gprRegs[num-1];
+    }
+    else if (parseNumberedName(str, "STR", &num) && num < numStreams)
+    {
+        op->type = OP_GPR;
+        op->reg = streamRegs[num];
+    }
+    else
+    {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+static void
+emit8(PttBuffer* buf, uint8_t val)
+{
+    buf->code[buf->pos++] = val;
+}
+
+static void
+emit32(PttBuffer* buf, int32_t val)
+{
+    memcpy(buf->code + buf->pos, &val, sizeof(int32_t));
+    buf->pos += sizeof(int32_t);
+}
+
+/* Emit ModRM, SIB and displacement. dispScale is the factor of compressed
+ * 8 bit displacements (EVEX), 1 otherwise */
+static int
+emitModRM(PttBuffer* buf, int reg, const PttOperand* rm, int dispScale)
+{
+    int mod = 2;
+    static const uint8_t scaleBits[9] = {0, 0, 1, 0, 2, 0, 0, 0, 3};
+
+    if (rm->type != OP_MEM)
+    {
+        emit8(buf, 0xC0 | ((reg & 7) << 3) | (rm->reg & 7));
+        return 0;
+    }
+    if (rm->base == PTT_RIP)
+    {
+        if (buf->numFixups >= PTT_MAX_FIXUPS)
+        {
+            return -E2BIG;
+        }
+        emit8(buf, 0x05 | ((reg & 7) << 3));
+        buf->fixupPos[buf->numFixups] = buf->pos;
+        buf->fixupScalar[buf->numFixups] = rm->scalar;
+        buf->numFixups++;
+        emit32(buf, 0);
+        return 0;
+    }
+
+    if (rm->disp == 0 && (rm->base & 7) != 5)
+    {
+        mod = 0;
+    }
+    else if ((rm->disp % dispScale) == 0 && (rm->disp / dispScale) >= -128 && (rm->disp / dispScale) <= 127)
+    {
+        mod = 1;
+    }
+    if (rm->index >= 0 || (rm->base & 7) == 4)
+    {
+        int index = (rm->index >= 0 ? rm->index : 4);
+        emit8(buf, (mod << 6) | ((reg & 7) << 3) | 4);
+        emit8(buf, (scaleBits[rm->scale] << 6) | ((index & 7) << 3) | (rm->base & 7));
+    }
+    else
+    {
+        emit8(buf, (mod << 6) | ((reg & 7) << 3) | (rm->base & 7));
+    }
+    if (mod == 1)
+    {
+        emit8(buf, (uint8_t)(rm->disp / dispScale));
+    }
+    else if (mod == 2)
+    {
+        emit32(buf, rm->disp);
+    }
+    return 0;
+}
+
+static int
+encodeInstruction(PttBuffer* buf, const PttInstruction* instr, PttOperand* ops, int numOps)
+{
+    const PttOperand* regOp = NULL;
+    const PttOperand* rmOp = NULL;
+    const PttOperand* srcOp = NULL;
+    uint8_t opcode = 0;
+    uint8_t pp = 0;
+    int rmReg = 0;
+    int rmIndex = 0;
+    PttOperandType regType;
+
+    if (instr->enc == ENC_AVX && instr->nds)
+    {
+        if (numOps != 3 || ops[0].type == OP_MEM || ops[1].type == OP_MEM)
+        {
+            return -EINVAL;
+        }
+        regOp = &ops[0];
+        srcOp = &ops[1];
+        rmOp = &ops[2];
+        opcode = instr->load;
+    }
+    else if (instr->enc == ENC_GPR && numOps == 2 && ops[0].type != OP_MEM && ops[1].type != OP_MEM)
+    {
+        /* gas picks the r/m <- reg form for register moves */
+        regOp = &ops[1];
+        rmOp = &ops[0];
+        opcode = instr->store;
+    }
+    else if (numOps == 2 && ops[0].type != OP_MEM && instr->load)
+    {
+        regOp = &ops[0];
+        rmOp = &ops[1];
+        opcode = instr->load;
+    }
+    else if (numOps == 2 && ops[0].type == OP_MEM && ops[1].type != OP_MEM && instr->store)
+    {
+        regOp = &ops[1];
+        rmOp = &ops[0];
+        opcode = instr->store;
+    }
+    else
+    {
+        return -EINVAL;
+    }
+
+    /* All register operands must be of the same class */
+    regType = regOp->type;
+    if ((srcOp && srcOp->type != regType) || (rmOp->type != OP_MEM && rmOp->type != regType))
+    {
+        return -EINVAL;
+    }
+    if ((instr->enc == ENC_SSE && regType != OP_XMM) ||
+        (instr->enc == ENC_MMX && regType != OP_MMX) ||
+        (instr->enc == ENC_GPR && regType != OP_GPR) ||
+        (instr->enc == ENC_AVX && regType != OP_XMM && regType != OP_YMM && regType != OP_ZMM))
+    {
+        return -EINVAL;
+    }
+
+    if (rmOp->type == OP_MEM)
+    {
+        rmReg = (rmOp->base == PTT_RIP ? 0 : rmOp->base);
+        rmIndex = (rmOp->index >= 0 ? rmOp->index : 0);
+    }
+    else
+    {
+        rmReg = rmOp->reg;
+        rmIndex = 0;
+    }
+    switch (instr->prefix)
+    {
+        case 0x66: pp = 1; break;
+        case 0xF3: pp = 2; break;
+        case 0xF2: pp = 3; break;
+        default: pp = 0; break;
+    }
+
+    if (instr->enc != ENC_AVX)
+    {
+        uint8_t rex = 0x40 | (instr->vexW << 3) | (((regOp->reg >> 3) & 1) << 2) | (((rmIndex >> 3) & 1) << 1) | ((rmReg >> 3) & 1);
+        if (instr->prefix)
+        {
+            emit8(buf, instr->prefix);
+        }
+        if (rex != 0x40)
+        {
+            emit8(buf, rex);
+        }
+        if (instr->map >= 1)
+        {
+            emit8(buf, 0x0F);
+        }
+        if (instr->map == 2)
+        {
+            emit8(buf, 0x38);
+        }
+        emit8(buf, opcode);
+        return emitModRM(buf, regOp->reg, rmOp, 1);
+    }
+    else if (regType != OP_ZMM)
+    {
+        uint8_t r = !((regOp->reg >> 3) & 1);
+        uint8_t x = !((rmIndex >> 3) & 1);
+        uint8_t b = !((rmReg >> 3) & 1);
+        uint8_t vvvv = (srcOp ? (~srcOp->reg) & 0xF : 0xF);
+        uint8_t l = (regType == OP_YMM);
+        if (x && b && instr->vexW == 0 && instr->map == 1)
+        {
+            emit8(buf, 0xC5);
+            emit8(buf, (r << 7) | (vvvv << 3) | (l << 2) | pp);
+        }
+        else
+        {
+            emit8(buf, 0xC4);
+            emit8(buf, (r << 7) | (x << 6) | (b << 5) | instr->map);
+            emit8(buf, (instr->vexW << 7) | (vvvv << 3) | (l << 2) | pp);
+        }
+        emit8(buf, opcode);
+        return emitModRM(buf, regOp->reg, rmOp, 1);
+    }
+    else
+    {
+        /* EVEX for the 512 bit registers, the memory operands are full
+         * vectors so 8 bit displacements are scaled by 64 */
+        uint8_t r = !((regOp->reg >> 3) & 1);
+        uint8_t rr = !((regOp->reg >> 4) & 1);
+        uint8_t x = (rmOp->type == OP_MEM ? !((rmIndex >> 3) & 1) : !((rmOp->reg >> 4) & 1));
+        uint8_t b = !((rmReg >> 3) & 1);
+        uint8_t vvvv = (srcOp ? (~srcOp->reg) & 0xF : 0xF);
+        uint8_t vv = (srcOp ? !((srcOp->reg >> 4) & 1) : 1);
+        emit8(buf, 0x62);
+        emit8(buf, (r << 7) | (x << 6) | (b << 5) | (rr << 4) | instr->map);
+        emit8(buf, (instr->evexW << 7) | (vvvv << 3) | (1 << 2) | pp);
+        emit8(buf, (2 << 5) | (vv << 3));
+        emit8(buf, opcode);
+        return emitModRM(buf, regOp->reg, rmOp, 64);
+    }
+    return 0;
+}
+
+static int
+assembleLine(PttBuffer* buf, char* line, int numStreams)
+{
+    char* mnemonic = line;
+    char* args = line;
+    char* tok = NULL;
+    int numOps = 0;
+    int firstFixup = buf->numFixups;
+    int ret = 0;
+    const PttInstruction* instr = NULL;
+    PttOperand ops[PTT_MAX_OPERANDS];
+
+    while (*args && !isspace((unsigned char)*args))
+    {
+        args++;
+    }
+    if (*args)
+    {
+        *args = '\0';
+        args++;
+    }
+    for (size_t i = 0; i < sizeof(pttInstructions)/sizeof(PttInstruction); i++)
+    {
+        if (strcasecmp(mnemonic, pttInstructions[i].name) == 0)
+        {
+            instr = &pttInstructions[i];
+            break;
+        }
+    }
+    if (!instr)
+    {
+        return -ENOTSUP;
+    }
+    tok = strtok(args, ",");
+    while (tok)
+    {
+        if (numOps == PTT_MAX_OPERANDS || parseOperand(trim(tok), &ops[numOps], numStreams) < 0)
+        {
+            return -EINVAL;
+        }
+        numOps++;
+        tok = strtok(NULL, ",");
+    }
+    ret = encodeInstruction(buf, instr, ops, numOps);
+    for (int i = firstFixup; i < buf->numFixups; i++)
+    {
+        buf->fixupEnd[i] = buf->pos;
+    }
+    return ret;
+}
+
+static void
+emitPrologue(PttBuffer* buf, int numStreams)
+{
+    static const uint8_t prologue[] = {
+        0x55,             /* push rbp */
+        0x48, 0x89, 0xE5, /* mov rbp, rsp */
+        0x53,             /* push rbx */
+        0x41, 0x54,       /* push r12 */
+        0x41, 0x55,       /* push r13 */
+        0x41, 0x56,       /* push r14 */
+        0x41, 0x57,       /* push r15 */
+    };
+
+    memcpy(buf->code + buf->pos, prologue, sizeof(prologue));
+    buf->pos += sizeof(prologue);
+    /* Streams above STR4 are passed on the stack */
+    for (int i = 5; i < numStreams; i++)
+    {
+        emit8(buf, 0x4C);
+        emit8(buf, 0x8B);
+        emit8(buf, 0x45 | ((streamRegs[i] & 7) << 3));
+        emit8(buf, 16 + (i - 5) * 8);
+    }
+}
+
+static void
+emitEpilogue(PttBuffer* buf)
+{
+    static const uint8_t epilogue[PTT_EPILOGUE_SIZE] = {
+        0x41, 0x5F,       /* pop r15 */
+        0x41, 0x5E,       /* pop r14 */
+        0x41, 0x5D,       /* pop r13 */
+        0x41, 0x5C,       /* pop r12 */
+        0x5B,             /* pop rbx */
+        0x48, 0x89, 0xEC, /* mov rsp, rbp */
+        0x5D,             /* pop rbp */
+        0xC3,             /* ret */
+    };
+
+    memcpy(buf->code + buf->pos, epilogue, sizeof(epilogue));
+    buf->pos += sizeof(epilogue);
+}
+
+static void
+emitLoopEnd(PttBuffer* buf, size_t loopStart, int stride)
+{
+    int32_t rel;
+
+    /* add rax, stride */
+    emit8(buf, 0x48);
+    if (stride <= 127)
+    {
+        emit8(buf, 0x83);
+        emit8(buf, 0xC0);
+        emit8(buf, (uint8_t) stride);
+    }
+    else
+    {
+        emit8(buf, 0x05);
+        emit32(buf, stride);
+    }
+    /* cmp rax, rdi */
+    emit8(buf, 0x48);
+    emit8(buf, 0x39);
+    emit8(buf, 0xF8);
+    /* jl loopStart */
+    rel = (int32_t)loopStart - (int32_t)(buf->pos + 2);
+    if (rel >= -128)
+    {
+        emit8(buf, 0x7C);
+        emit8(buf, (uint8_t) rel);
+    }
+    else
+    {
+        rel = (int32_t)loopStart - (int32_t)(buf->pos + 6);
+        emit8(buf, 0x0F);
+        emit8(buf, 0x8C);
+        emit32(buf, rel);
+    }
+}
+
+/* Append the scalar constants after the code and resolve the rip-relative
+ * references to them */
+static void
+emitScalars(PttBuffer* buf)
+{
+    size_t offsets[NUM_SCALARS];
+
+    while (buf->pos % 64)
+    {
+        emit8(buf, 0xCC);
+    }
+    for (int i = 0; i < NUM_SCALARS; i++)
+    {
+        offsets[i] = buf->pos;
+        for (int j = 0; j < 16; j++)
+        {
+            if (i == SCALAR_DOUBLE && j < 8)
+            {
+                double d = 1.0;
+                memcpy(buf->code + buf->pos, &d, sizeof(double));
+                buf->pos += sizeof(double);
+            }
+            else if (i == SCALAR_SINGLE)
+            {
+                float f = 1.0;
+                memcpy(buf->code + buf->pos, &f, sizeof(float));
+                buf->pos += sizeof(float);
+            }
+            else if (i == SCALAR_INT)
+            {
+                emit32(buf, 1);
+            }
+        }
+    }
+    for (int i = 0; i < buf->numFixups; i++)
+    {
+        int32_t rel = (int32_t)(offsets[buf->fixupScalar[i]] - buf->fixupEnd[i]);
+        memcpy(buf->code + buf->fixupPos[i], &rel, sizeof(int32_t));
+    }
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+ptt_loadKernel(const char* filename, TestCase** test)
+{
+#if defined(__x86_64__)
+    FILE* fp = NULL;
+    char line[PTT_MAX_LINE];
+    int lineno = 0;
+    int ret = 0;
+    int isLoop = 0;
+    int hasStride = 0;
+    int hasType = 0;
+    size_t loopStart = 0;
+    TestCase* tc = NULL;
+    PttBuffer* buf = NULL;
+    char* name = NULL;
+    const char* base = NULL;
+
+    if (!filename || !test)
+    {
+        return -EINVAL;
+    }
+    fp = fopen(filename, "r");
+    if (!fp)
+    {
+        ret = -errno;
+        fprintf(stderr, "Error: Cannot open kernel file %s - %s\n", filename, strerror(errno));
+        return ret;
+    }
+    tc = (TestCase*) calloc(1, sizeof(TestCase));
+    buf = (PttBuffer*) calloc(1, sizeof(PttBuffer));
+    if (!tc || !buf)
+    {
+        fclose(fp);
+        free(tc);
+        free(buf);
+        return -ENOMEM;
+    }
+    buf->code = mmap(NULL, PTT_CODE_SIZE, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (buf->code == MAP_FAILED)
+    {
+        ret = -errno;
+        fclose(fp);
+        free(tc);
+        free(buf);
+        return ret;
+    }
+
+    tc->loads = -1;
+    tc->stores = -1;
+    tc->branches = -1;
+    tc->instr_const = -1;
+    tc->instr_loop = -1;
+    tc->uops = -1;
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        char* comment = strchr(line, '#');
+        char* str = NULL;
+        char key[32];
+        int value = 0;
+
+        lineno++;
+        if (comment)
+        {
+            *comment = '\0';
+        }
+        str = trim(line);
+        if (*str == '\0')
+        {
+            continue;
+        }
+        if (!isLoop && strncmp(str, "DESC", 4) == 0 && isspace((unsigned char)str[4]))
+        {
+            tc->desc = strdup(trim(str + 4));
+            continue;
+        }
+        if (!isLoop && strncmp(str, "TYPE", 4) == 0 && isspace((unsigned char)str[4]))
+        {
+            char* type = trim(str + 4);
+            hasType = 1;
+            if (strcmp(type, "DOUBLE") == 0)
+                tc->type = DOUBLE;
+            else if (strcmp(type, "SINGLE") == 0)
+                tc->type = SINGLE;
+            else if (strcmp(type, "INT") == 0)
+                tc->type = INT;
+            else if (strcmp(type, "POINTER") == 0)
+                tc->type = POINTER;
+            else
+            {
+                fprintf(stderr, "Error: %s:%d: Unknown type %s\n", filename, lineno, type);
+                ret = -EINVAL;
+                break;
+            }
+            continue;
+        }
+        if (!isLoop && sscanf(str, "%31s %d", key, &value) == 2 && isupper((unsigned char)key[0]))
+        {
+            if (strcmp(key, "STREAMS") == 0)
+            {
+                if (tc->streams != 0)
+                {
+                    fprintf(stderr, "Error: %s:%d: STREAMS given more than once\n", filename, lineno);
+                    ret = -EINVAL;
+                    break;
+                }
+                if (value < 1 || value > PTT_MAX_STREAMS)
+                {
+                    fprintf(stderr, "Error: %s:%d: Only 1 to %d streams are supported\n",
+                                    filename, lineno, PTT_MAX_STREAMS);
+                    ret = -EINVAL;
+                    break;
+                }
+                tc->streams = value;
+                emitPrologue(buf, value);
+            }
+            else if (strcmp(key, "FLOPS") == 0)
+                tc->flops = value;
+            else if (strcmp(key, "BYTES") == 0)
+                tc->bytes = value;
+            else if (strcmp(key, "LOADS") == 0)
+                tc->loads = value;
+            else if (strcmp(key, "STORES") == 0)
+                tc->stores = value;
+            else if (strcmp(key, "BRANCHES") == 0)
+                tc->branches = value;
+            else if (strcmp(key, "INSTR_CONST") == 0)
+                tc->instr_const = value;
+            else if (strcmp(key, "INSTR_LOOP") == 0)
+                tc->instr_loop = value;
+            else if (strcmp(key, "UOPS") == 0)
+                tc->uops = value;
+            else if (strcmp(key, "LOOP") == 0 || strcmp(key, "INC") == 0)
+            {
+                if (value < 1 || tc->streams == 0)
+                {
+                    fprintf(stderr, "Error: %s:%d: %s requires a positive stride after STREAMS\n",
+                                    filename, lineno, key);
+                    ret = -EINVAL;
+                    break;
+                }
+                tc->stride = value;
+                hasStride = 1;
+                if (strcmp(key, "LOOP") == 0)
+                {
+                    if (buf->pos + PTT_LOOP_START_SIZE + PTT_TAIL_SIZE > PTT_CODE_SIZE)
+                    {
+                        fprintf(stderr, "Error: %s:%d: Kernel too large\n", filename, lineno);
+                        ret = -E2BIG;
+                        break;
+                    }
+                    isLoop = 1;
+                    /* xor rax, rax and align the loop start to 16 bytes */
+                    emit8(buf, 0x48);
+                    emit8(buf, 0x31);
+                    emit8(buf, 0xC0);
+                    while (buf->pos % 16)
+                    {
+                        emit8(buf, 0x90);
+                    }
+                    loopStart = buf->pos;
+                }
+            }
+            else
+            {
+                fprintf(stderr, "Error: %s:%d: Unknown keyword %s\n", filename, lineno, key);
+                ret = -EINVAL;
+                break;
+            }
+            continue;
+        }
+        if (tc->streams == 0)
+        {
+            fprintf(stderr, "Error: %s:%d: Instructions before STREAMS\n", filename, lineno);
+            ret = -EINVAL;
+            break;
+        }
+        if (buf->pos + PTT_MAX_INSTR + PTT_TAIL_SIZE > PTT_CODE_SIZE)
+        {
+            fprintf(stderr, "Error: %s:%d: Kernel too large\n", filename, lineno);
+            ret = -E2BIG;
+            break;
+        }
+        ret = assembleLine(buf, str, tc->streams);
+        if (ret == -ENOTSUP)
+        {
+            fprintf(stderr, "Error: %s:%d: Unsupported instruction %s\n", filename, lineno, str);
+            break;
+        }
+        else if (ret < 0)
+        {
+            fprintf(stderr, "Error: %s:%d: Invalid operands for %s\n", filename, lineno, str);
+            break;
+        }
+    }
+    fclose(fp);
+
+    if (ret == 0 && (!hasType || !hasStride))
+    {
+        fprintf(stderr, "Error: %s: TYPE and LOOP are required\n", filename);
+        ret = -EINVAL;
+    }
+    if (ret < 0)
+    {
+        munmap(buf->code, PTT_CODE_SIZE);
+        free(buf);
+        free(tc->desc);
+        free(tc);
+        return ret;
+    }
+
+    if (isLoop)
+    {
+        emitLoopEnd(buf, loopStart, tc->stride);
+    }
+    emitEpilogue(buf);
+    emitScalars(buf);
+    if (mprotect(buf->code, PTT_CODE_SIZE, PROT_READ|PROT_EXEC) != 0)
+    {
+        ret = -errno;
+        fprintf(stderr, "Error: Cannot make kernel executable - %s\n", strerror(errno));
+        munmap(buf->code, PTT_CODE_SIZE);
+        free(buf);
+        free(tc->desc);
+        free(tc);
+        return ret;
+    }
+
+    base = strrchr(filename, '/');
+    base = (base ? base + 1 : filename);
+    name = strdup(base);
+    if (name && strrchr(name, '.'))
+    {
+        *strrchr(name, '.') = '\0';
+    }
+    tc->name = name;
+    if (!tc->desc)
+    {
+        tc->desc = strdup(filename);
+    }
+    tc->kernel = (FuncPrototype) buf->code;
+    free(buf);
+    *test = tc;
+    return 0;
+#else
+    fprintf(stderr, "Error: Loading kernels at runtime is only supported on x86-64\n");
+    return -ENOSYS;
+#endif
+}
+
+void
+ptt_freeKernel(TestCase* test)
+{
+    if (!test)
+    {
+        return;
+    }
+    if (test->kernel)
+    {
+        munmap((void*) test->kernel, PTT_CODE_SIZE);
+    }
+    free(test->name);
+    free(test->desc);
+    free(test);
+}
@@ -0,0 +1,189 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  scaling.c
+ *
+ *      Description:  Fill order of the HW threads in the thread scaling study
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:  Jan Treibig (jt), jan.treibig@gmail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <scaling.h>
+#include <likwid.h>
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+static const char* scalingOrderNames[NUM_SCALING_ORDERS] = {
+    [SCALING_COMPACT] = "compact",
+    [SCALING_SCATTER] = "scatter",
+    [SCALING_SMTLAST] = "smtlast",
+};
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static int
+compareKeys(const int* keyA, const int* keyB, int numKeys)
+{
+    for (int i = 0; i < numKeys; i++)
+    {
+        if (keyA[i] != keyB[i])
+        {
+            return keyA[i] - keyB[i];
+        }
+    }
+    return 0;
+}
+
+static int
+compareCompact(const void* pa, const void* pb)
+{
+    const ScalingCpu* a = (const ScalingCpu*) pa;
+    const ScalingCpu* b = (const ScalingCpu*) pb;
+    int keyA[3] = {a->socket, a->core, a->cpu};
+    int keyB[3] = {b->socket, b->core, b->cpu};
+
+    return compareKeys(keyA, keyB, 3);
+}
+
+static int
+compareScatter(const void* pa, const void* pb)
+{
+    const ScalingCpu* a = (const ScalingCpu*) pa;
+    const ScalingCpu* b = (const ScalingCpu*) pb;
+    int keyA[4] = {a->smtRank, a->coreRank, a->socket, a->cpu};
+    int keyB[4] = {b->smtRank, b->coreRank, b->socket, b->cpu};
+
+    return compareKeys(keyA, keyB, 4);
+}
+
+static int
+compareSmtLast(const void* pa, const void* pb)
+{
+    const ScalingCpu* a = (const ScalingCpu*) pa;
+    const ScalingCpu* b = (const ScalingCpu*) pb;
+    int keyA[4] = {a->smtRank, a->socket, a->coreRank, a->cpu};
+    int keyB[4] = {b->smtRank, b->socket, b->coreRank, b->cpu};
+
+    return compareKeys(keyA, keyB, 4);
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+scaling_orderFromString(const char* name)
+{
+    for (int i = 0; i < NUM_SCALING_ORDERS; i++)
+    {
+        if (strcmp(name, scalingOrderNames[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char*
+scaling_orderName(ScalingOrder order)
+{
+    if (order < 0 || order >= NUM_SCALING_ORDERS)
+    {
+        return "unknown";
+    }
+    return scalingOrderNames[order];
+}
+
+void
+scaling_sortProcessors(ScalingOrder order, int numCpus, int* cpus)
+{
+    TopologyLookup_t lookup = get_topologyLookup();
+    ScalingCpu* entries = (ScalingCpu*) malloc(numCpus * sizeof(ScalingCpu));
+
+    if (!entries)
+    {
+        fprintf(stderr, "Error: Cannot allocate fill order - %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < numCpus; i++)
+    {
+        int cpu = cpus[i];
+        entries[i].cpu = cpu;
+        if (lookup && cpu >= 0 && cpu < (int)lookup->numberOfHWThreads &&
+            lookup->hwthread2core[cpu] >= 0)
+        {
+            entries[i].socket = lookup->hwthread2socket[cpu];
+            entries[i].core = lookup->hwthread2core[cpu];
+        }
+        else
+        {
+            /* Unknown placement, every HW thread is its own core */
+            entries[i].socket = 0;
+            entries[i].core = -1 - cpu;
+        }
+    }
+    qsort(entries, numCpus, sizeof(ScalingCpu), compareCompact);
+
+    /* The ranks count only the selected HW threads, a workgroup with the
+     * second HW thread of each core uses it as the first one */
+    for (int i = 0; i < numCpus; i++)
+    {
+        entries[i].coreRank = 0;
+        entries[i].smtRank = 0;
+        if ((i > 0) && (entries[i].socket == entries[i-1].socket))
+        {
+            if (entries[i].core == entries[i-1].core)
+            {
+                entries[i].coreRank = entries[i-1].coreRank;
+                entries[i].smtRank = entries[i-1].smtRank + 1;
+            }
+            else
+            {
+                entries[i].coreRank = entries[i-1].coreRank + 1;
+            }
+        }
+    }
+    switch (order)
+    {
+        case SCALING_SCATTER:
+            qsort(entries, numCpus, sizeof(ScalingCpu), compareScatter);
+            break;
+        case SCALING_SMTLAST:
+            qsort(entries, numCpus, sizeof(ScalingCpu), compareSmtLast);
+            break;
+        default:
+            break;
+    }
+
+    for (int i = 0; i < numCpus; i++)
+    {
+        cpus[i] = entries[i].cpu;
+    }
+    free(entries);
+}
@@ -136,6 +136,23 @@ parse_workgroup(Workgroup* group, const_bstring str, DataType type)
             return NULL;
         }
     }
+    else if (tokens->qty == 4 && biseqcstr(tokens->entry[0], "P"))
+    {
+        /* placement policy P:<policy>:<size>:<num_threads>, the streams are
+         * placed in the node domain unless given explicitly */
+        cpustr = bformat("P:%s:%s", bdata(tokens->entry[1]), bdata(tokens->entry[3]));
+        numThreads = str2int(bdata(tokens->entry[3]));
+        if (numThreads < 0)
+        {
+            fprintf(stderr, "Cannot convert %s to integer\n", bdata(tokens->entry[3]));
+            bstrListDestroy(tokens);
+            return NULL;
+        }
+        bdestroy(tokens->entry[0]);
+        tokens->entry[0] = bformat("N");
+        bdestroy(tokens->entry[1]);
+        tokens->entry[1] = bstrcpy(tokens->entry[2]);
+    }
     else if (tokens->qty == 5)
     {
         cpustr = bformat("E:%s:%s:%s:%s", bdata(tokens->entry[0]),
@@ -207,7 +224,7 @@ parse_streams(Workgroup* group, const_bstring str, int numberOfStreams)
     for (int i=0; i<numberOfStreams; i++)
     {
         subtokens = bsplit(tokens->entry[i],':');
-        if (subtokens->qty >= 2)
+        if ((subtokens->qty >= 2) && (subtokens->qty <= 4))
         {
             int index = str2int(bdata(subtokens->entry[0]));
             if ((index < 0) && (index >= numberOfStreams))
@@ -219,9 +236,17 @@ parse_streams(Workgroup* group, const_bstring str, int numberOfStreams)
             }
             group->streams[index].domain = bstrcpy(subtokens->entry[1]);
             group->streams[index].offset = 0;
-            if (subtokens->qty == 3)
+            group->streams[index].pages = PAGES_DEFAULT;
+            for (int j = 2; j < subtokens->qty; j++)
             {
-                group->streams[index].offset = str2int(bdata(subtokens->entry[2]));
+                /* <streamId>:<domain>[:<offset>][:<pages>] */
+                int pages = allocator_pageTypeFromString(bdata(subtokens->entry[j]));
+                if (pages >= 0)
+                {
+                    group->streams[index].pages = pages;
+                    continue;
+                }
+                group->streams[index].offset = str2int(bdata(subtokens->entry[j]));
                 if (group->streams[index].offset < 0)
                 {
                 free(group->streams);
@@ -282,6 +307,7 @@ bstr_to_workgroup(Workgroup* group, const_bstring str, DataType type, int number
         {
             group->streams[i].domain = bstrcpy(domain);
             group->streams[i].offset = 0;
+            group->streams[i].pages = PAGES_DEFAULT;
         }
         bdestroy(domain);
     }
@@ -293,11 +319,12 @@ bstr_to_workgroup(Workgroup* group, const_bstring str, DataType type, int number
     }
     bstrListDestroy(tokens);
     group->size /= numberOfStreams;
+    group->numberOfStreams = numberOfStreams;
     return 0;
 }
 
 void
-workgroups_destroy(Workgroup** groupList, int numberOfGroups, int numberOfStreams)
+workgroups_destroy(Workgroup** groupList, int numberOfGroups)
 {
     int i = 0, j = 0;
     if (groupList == NULL)
@@ -308,7 +335,7 @@ workgroups_destroy(Workgroup** groupList, int numberOfGroups, int numberOfStream
     for (i = 0; i < numberOfGroups; i++)
     {
         free(list[i].processorIds);
-        for (j = 0; j < numberOfStreams; j++)
+        for (j = 0; j < list[i].numberOfStreams; j++)
         {
             bdestroy(list[i].streams[j].domain);
         }
@@ -49,6 +49,9 @@ ThreadGroup* threads_groups;
 static pthread_t* threads = NULL;
 static pthread_attr_t attr;
 static int numThreads = 0;
+static pthread_barrier_t poolBarrier;
+static void *(*poolRoutine)(void*) = NULL;
+static int poolThreads = 0;
 
 /* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE  ################## */
 
@@ -74,6 +77,29 @@ dummy_function(void* arg)
     return 0;
 }
 
+/* Pool threads wait for the next step, the first poolThreads of them run
+ * the routine. A step with zero threads ends the pool. */
+static void*
+threads_poolWorker(void* arg)
+{
+    ThreadData* data = (ThreadData*) arg;
+
+    while (1)
+    {
+        pthread_barrier_wait(&poolBarrier);
+        if (poolThreads == 0)
+        {
+            break;
+        }
+        if (data->globalThreadId < poolThreads)
+        {
+            poolRoutine(arg);
+        }
+        pthread_barrier_wait(&poolBarrier);
+    }
+    return NULL;
+}
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 int
@@ -135,20 +161,58 @@ threads_create(void *(*startRoutine)(void*))
 }
 
 void
-threads_createGroups(int numberOfGroups)
+threads_createPool(void *(*startRoutine)(void*))
 {
     int i;
-    int j;
-    int numThreadsPerGroup;
-    int globalId = 0;
 
-    if (numThreads % numberOfGroups)
+    poolRoutine = startRoutine;
+    poolThreads = 0;
+    pthread_barrier_init(&poolBarrier, NULL, numThreads + 1);
+    for(i = 0; i < numThreads; i++)
     {
-        fprintf(stderr, "ERROR: Not enough threads %d to create %d groups\n",numThreads,numberOfGroups);
+        pthread_create(&threads[i],
+                &attr,
+                threads_poolWorker,
+                (void*) &threads_data[i]);
     }
-    else
+}
+
+void
+threads_runPool(int numberOfThreads)
+{
+    poolThreads = numberOfThreads;
+    /* start and end of the step */
+    pthread_barrier_wait(&poolBarrier);
+    pthread_barrier_wait(&poolBarrier);
+}
+
+void
+threads_destroyPool(void)
+{
+    poolThreads = 0;
+    pthread_barrier_wait(&poolBarrier);
+    threads_join();
+    pthread_barrier_destroy(&poolBarrier);
+}
+
+void
+threads_createGroups(int numberOfGroups, const int* groupSizes)
+{
+    int i;
+    int j;
+    int numThreadsPerGroup = 0;
+    int globalId = 0;
+
+    if (groupSizes == NULL)
     {
-        numThreadsPerGroup = numThreads / numberOfGroups;
+        if (numThreads % numberOfGroups)
+        {
+            fprintf(stderr, "ERROR: Not enough threads %d to create %d groups\n",numThreads,numberOfGroups);
+        }
+        else
+        {
+            numThreadsPerGroup = numThreads / numberOfGroups;
+        }
     }
 
     threads_groups = (ThreadGroup*) malloc(numberOfGroups * sizeof(ThreadGroup));
@@ -160,6 +224,10 @@ threads_createGroups(int numberOfGroups)
 
     for (i = 0; i < numberOfGroups; i++)
     {
+        if (groupSizes != NULL)
+        {
+            numThreadsPerGroup = groupSizes[i];
+        }
         threads_groups[i].numberOfThreads = numThreadsPerGroup;
         threads_groups[i].threadIds = (int*) malloc(numThreadsPerGroup * sizeof(int));
         if (!threads_groups[i].threadIds)
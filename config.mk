@@ -84,6 +84,12 @@ MAX_NUM_THREADS = 263
 MAX_NUM_NODES = 64
 CFG_FILE_PATH = /etc/likwid.cfg
 TOPO_FILE_PATH = /etc/likwid_topo.cfg
+# Cache of the calibrated TSC frequency, the user ID is appended to
+# the path
+TSC_FILE_PATH = /var/tmp/likwid_tsc.cfg
+# Cached snapshot of topology, NUMA, PCI and affinity domains, the
+# user ID is appended to the path
+TOPO_CACHE_PATH = /var/tmp/likwid_topo.cache
 
 # Versioning Information
 VERSION = 4
@@ -2,6 +2,8 @@ DEFINES   += -DVERSION=$(VERSION)         \
 		 -DRELEASE=$(RELEASE)                 \
 		 -DCFGFILE=$(CFG_FILE_PATH)           \
 		 -DTOPOFILE=$(TOPO_FILE_PATH)           \
+		 -DTSCFILE=$(TSC_FILE_PATH)           \
+		 -DTOPOCACHE=$(TOPO_CACHE_PATH)           \
 		 -DINSTALL_PREFIX=$(INSTALLED_PREFIX) \
 		 -DMAX_NUM_THREADS=$(MAX_NUM_THREADS) \
 		 -DMAX_NUM_NODES=$(MAX_NUM_NODES)     \
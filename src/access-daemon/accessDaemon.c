@@ -96,8 +96,9 @@ static char* filepath;
 static const char* ident = "accessD";
 static AllowedPrototype allowed = NULL;
 static AllowedPciPrototype allowedPci = NULL;
-static int FD_MSR[MAX_NUM_THREADS];
-static int FD_PCI[MAX_NUM_NODES][MAX_NUM_PCI_DEVICES];
+static int* FD_MSR = NULL;
+static int num_msr_fds = 0;
+static int (*FD_PCI)[MAX_NUM_PCI_DEVICES] = NULL;
 static int isPCIUncore = 0;
 static PciDevice* pci_devices_daemon = NULL;
 static char pci_filepath[MAX_PATH_LENGTH];
@@ -110,11 +111,29 @@ static int num_pmc_counters = 0;
  *   1        0x7f      0x7f
  *   2                  0xbf
  *   3                  0xff
+ * The arrays are sized with the number of sockets found at startup.
  */
-static char* socket_bus[MAX_NUM_NODES] = { [0 ... (MAX_NUM_NODES-1)] = NULL};
+static char** socket_bus = NULL;
+static int num_sockets = 0;
 
 /* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
 
+static int
+allowed_readonly(uint32_t reg)
+{
+    /* TSC, MPERF and APERF are used for the effective clock on all vendors */
+    if ((reg == 0x10)  ||
+        (reg == 0xE7)  ||
+        (reg == 0xE8))
+    {
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+}
+
 static int
 allowed_intel(uint32_t reg)
 {
@@ -663,13 +682,13 @@ msr_read(AccessDataRecord * dRecord)
         return;
     }
 
-    if (FD_MSR[cpu] <= 0)
+    if ((cpu >= num_msr_fds) || (FD_MSR[cpu] <= 0))
     {
         dRecord->errorcode = ERR_NODEV;
         return;
     }
 
-    if (!allowed(reg))
+    if ((!allowed(reg)) && (!allowed_readonly(reg)))
     {
         syslog(LOG_ERR, "Access to register 0x%X not allowed\n", reg);
         dRecord->errorcode = ERR_RESTREG;
@@ -704,7 +723,7 @@ msr_write(AccessDataRecord * dRecord)
         return;
     }
 
-    if (FD_MSR[cpu] <= 0)
+    if ((cpu >= num_msr_fds) || (FD_MSR[cpu] <= 0))
     {
         dRecord->errorcode = ERR_NODEV;
         return;
@@ -734,7 +753,7 @@ msr_check(AccessDataRecord * dRecord)
     uint32_t cpu = dRecord->cpu;
     dRecord->errorcode = ERR_NOERROR;
 
-    if (FD_MSR[cpu] < 0)
+    if ((cpu >= num_msr_fds) || (FD_MSR[cpu] < 0))
     {
         dRecord->errorcode = ERR_NODEV;
         return;
@@ -760,7 +779,8 @@ pci_read(AccessDataRecord* dRecord)
         return;
     }
 
-    if (FD_PCI[socketId][device] == -2)
+    if ((socketId >= num_sockets) || (device >= MAX_NUM_PCI_DEVICES) ||
+        (FD_PCI[socketId][device] == -2))
     {
         dRecord->errorcode = ERR_NODEV;
         return;
@@ -820,7 +840,8 @@ pci_write(AccessDataRecord* dRecord)
         return;
     }
 
-    if (FD_PCI[socketId][device] == -2)
+    if ((socketId >= num_sockets) || (device >= MAX_NUM_PCI_DEVICES) ||
+        (FD_PCI[socketId][device] == -2))
     {
         dRecord->errorcode = ERR_NODEV;
         return;
@@ -870,7 +891,8 @@ pci_check(AccessDataRecord* dRecord)
     uint32_t device = dRecord->device;
     dRecord->errorcode = ERR_NOERROR;
 
-    if (FD_PCI[socketId][device] == -2)
+    if ((socketId >= num_sockets) || (device >= MAX_NUM_PCI_DEVICES) ||
+        (FD_PCI[socketId][device] == -2))
     {
         dRecord->errorcode = ERR_NODEV;
         return;
@@ -893,13 +915,30 @@ static void
 stop_daemon(void)
 {
     kill_client();
-    for (int i=0;i<MAX_NUM_NODES;i++)
+    for (int i=0;i<num_sockets;i++)
     {
         if (socket_bus[i] != NULL)
         {
             free(socket_bus[i]);
         }
     }
+    if (socket_bus != NULL)
+    {
+        free(socket_bus);
+        socket_bus = NULL;
+    }
+    if (FD_PCI != NULL)
+    {
+        free(FD_PCI);
+        FD_PCI = NULL;
+    }
+    num_sockets = 0;
+    if (FD_MSR != NULL)
+    {
+        free(FD_MSR);
+        FD_MSR = NULL;
+    }
+    num_msr_fds = 0;
 
     if (sockfd != -1)
     {
@@ -1027,7 +1066,13 @@ int main(void)
     mode_t oldumask;
     uint32_t numHWThreads = sysconf(_SC_NPROCESSORS_CONF);
     uint32_t model;
-    for (int i=0;i<MAX_NUM_THREADS;i++)
+    FD_MSR = (int*) malloc(numHWThreads * sizeof(int));
+    if (FD_MSR == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    num_msr_fds = numHWThreads;
+    for (int i=0;i<num_msr_fds;i++)
     {
         FD_MSR[i] = -1;
     }
@@ -1261,26 +1306,30 @@ int main(void)
                 goto LOOP;
             }
 
-            for (int j=0; j<MAX_NUM_NODES; j++)
+            /* determine number of sockets and PCI-BUSID mapping ... */
+            cntr = 0;
+            while (getBusFromSocket(cntr) != -1)
+            {
+                cntr++;
+            }
+            socket_bus = (char**)malloc(cntr * sizeof(char*));
+            FD_PCI = malloc(cntr * sizeof(*FD_PCI));
+            if ((cntr > 0) && ((socket_bus == NULL) || (FD_PCI == NULL)))
+            {
+                syslog(LOG_ERR, "Failed to allocate PCI device lists for %d sockets", cntr);
+                stop_daemon();
+                exit(EXIT_FAILURE);
+            }
+            for (int j=0; j<cntr; j++)
             {
                 socket_bus[j] = (char*)malloc(4);
-                sprintf(socket_bus[j], "N-A");
+                sprintf(socket_bus[j], "%02x/", getBusFromSocket(j));
                 for (int i=0; i<MAX_NUM_PCI_DEVICES; i++)
                 {
                     FD_PCI[j][i] = -2;
                 }
             }
-
-            /* determine PCI-BUSID mapping ... */
-            int sbus = -1;
-            cntr = 0;
-            sbus = getBusFromSocket(cntr);
-            while (sbus != -1)
-            {
-                sprintf(socket_bus[cntr], "%02x/", sbus);
-                cntr++;
-                sbus = getBusFromSocket(cntr);
-            }
+            num_sockets = cntr;
 
             if ( cntr == 0 )
             {
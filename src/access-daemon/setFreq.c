@@ -34,6 +34,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 
 char setfiles[3][100] = {"scaling_min_freq", "scaling_max_freq", "scaling_setspeed"};
 char getfiles[3][100] = {"cpuinfo_min_freq", "cpuinfo_max_freq", "cpuinfo_cur_freq"};
@@ -45,17 +46,25 @@ enum cmds {
     SET_GOV
 };
 
+typedef struct {
+    unsigned long freq[3];
+    char* gov;
+} Settings;
+
 /* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
 
 static void
 help(char *execname)
 {
-    fprintf(stderr, "Usage: %s <processorID> <cmd> <frequency|governor> \n",execname);
+    fprintf(stderr, "Usage: %s <processorList> <cmd> <frequency|governor> [<cmd> <frequency|governor> ...]\n",execname);
+    fprintf(stderr, "       <processorList> is a comma separated list of processor IDs and ranges, e.g. 0,2-5\n");
     fprintf(stderr, "       Valid values for <cmd>:\n");
     fprintf(stderr, "       - cur: change current frequency\n");
     fprintf(stderr, "       - min: change minimal frequency\n");
     fprintf(stderr, "       - max: change maximal frequency\n");
     fprintf(stderr, "       - gov: change governor\n");
+    fprintf(stderr, "       The settings are applied to all processors in the list. Minimal and maximal\n");
+    fprintf(stderr, "       frequency are applied first, then the current frequency and the governor.\n");
 }
 
 static int
@@ -78,6 +87,54 @@ get_numCPUs()
     return cpucount;
 }
 
+static int
+read_cpulist(char* str, int* cpus, int numCPUs)
+{
+    int count = 0;
+    char* ptr = str;
+    char* eptr = NULL;
+    long start = 0, end = 0, c = 0;
+
+    while (*ptr != '\0')
+    {
+        start = strtol(ptr, &eptr, 10);
+        if (eptr == ptr)
+        {
+            return -EINVAL;
+        }
+        end = start;
+        ptr = eptr;
+        if (*ptr == '-')
+        {
+            ptr++;
+            end = strtol(ptr, &eptr, 10);
+            if (eptr == ptr)
+            {
+                return -EINVAL;
+            }
+            ptr = eptr;
+        }
+        if (start < 0 || end < start || end >= numCPUs)
+        {
+            fprintf(stderr, "CPU range %ld-%ld not valid. Range from 0 to %d.\n", start, end, numCPUs-1);
+            return -ERANGE;
+        }
+        for (c = start; c <= end && count < numCPUs; c++)
+        {
+            cpus[count++] = (int)c;
+        }
+        if (*ptr == ',')
+        {
+            ptr++;
+        }
+        else if (*ptr != '\0')
+        {
+            return -EINVAL;
+        }
+    }
+    return count;
+}
+
 static unsigned long
 read_freq(char* fstr)
 {
@@ -90,6 +147,28 @@ read_freq(char* fstr)
     return freq;
 }
 
+static unsigned long
+read_sysfs_freq(int cpuid, const char* file)
+{
+    char fpath[200];
+    char buff[100];
+    unsigned long freq = 0;
+    FILE* f = NULL;
+
+    snprintf(fpath, 199, "/sys/devices/system/cpu/cpu%d/cpufreq/%s", cpuid, file);
+    f = fopen(fpath, "r");
+    if (f == NULL)
+    {
+        return 0;
+    }
+    if (fgets(buff, 100, f) != NULL)
+    {
+        freq = strtoul(buff, NULL, 10);
+    }
+    fclose(f);
+    return freq;
+}
+
 static int
 valid_freq(unsigned long freq)
 {
@@ -164,158 +243,206 @@ valid_gov(char* gov)
     return 0;
 }
 
-/* #####  MAIN FUNCTION DEFINITION   ################## */
-
-int
-main (int argn, char** argv)
+static int
+write_sysfs(int cpuid, const char* file, const char* value)
 {
-    int i = 0;
-    int cpuid = 0;
-    int set_id = -1;
-    unsigned long freq = 0;
-    int numCPUs = 0;
-    enum cmds cmd;
-    char* gov = NULL;
-    char* fpath = NULL;
+    char fpath[200];
     FILE* f = NULL;
 
-    if (argn < 3 || argn > 4)
+    snprintf(fpath, 199, "/sys/devices/system/cpu/cpu%d/cpufreq/%s", cpuid, file);
+    f = fopen(fpath, "w");
+    if (f == NULL)
     {
-        help(argv[0]);
-        exit(EXIT_FAILURE);
+        fprintf(stderr, "Unable to open path %s for writing\n", fpath);
+        return -errno;
     }
-
-    /* Check for valid CPU */
-    cpuid = atoi(argv[1]);
-    numCPUs = get_numCPUs();
-    if (cpuid < 0 || cpuid > numCPUs)
+    fprintf(f, "%s", value);
+    if (fclose(f) != 0)
     {
-        fprintf(stderr, "CPU %d not a valid CPU ID. Range from 0 to %d.\n", cpuid, numCPUs);
-        exit(EXIT_FAILURE);
+        fprintf(stderr, "Unable to write %s to path %s\n", value, fpath);
+        return -errno;
     }
+    return 0;
+}
+
+static int
+set_freq(int cpuid, enum cmds cmd, unsigned long freq)
+{
+    char value[25];
+    snprintf(value, 24, "%lu", freq);
+    /* The cmd is also used as index in the setfiles array */
+    return write_sysfs(cpuid, setfiles[cmd], value);
+}
 
-    /* Read in command and argument */
-    if (strncmp(argv[2], "cur", 3) == 0)
+static int
+apply_settings(int cpuid, Settings* set)
+{
+    int err = 0;
+    unsigned long curmax = 0;
+
+    /* The kernel rejects a minimal frequency above the current maximal frequency
+     * and vice versa, so raising both requires writing the maximum first.
+     */
+    if (set->freq[SET_MIN] > 0 && set->freq[SET_MAX] > 0)
     {
-        cmd = SET_CURRENT;
-        freq = read_freq(argv[3]);
-        if (!valid_freq(freq))
+        curmax = read_sysfs_freq(cpuid, setfiles[SET_MAX]);
+        if (set->freq[SET_MIN] > curmax)
         {
-            fprintf(stderr, "Invalid frequency %lu!\n\n",freq);
-            help(argv[0]);
-            exit(EXIT_FAILURE);
+            err = set_freq(cpuid, SET_MAX, set->freq[SET_MAX]);
+            if (!err) err = set_freq(cpuid, SET_MIN, set->freq[SET_MIN]);
         }
-    }
-    else if (strncmp(argv[2], "min", 3) == 0)
-    {
-        cmd = SET_MIN;
-        freq = read_freq(argv[3]);
-        if (!valid_freq(freq))
+        else
         {
-            fprintf(stderr, "Invalid frequency %lu!\n\n",freq);
-            help(argv[0]);
-            exit(EXIT_FAILURE);
+            err = set_freq(cpuid, SET_MIN, set->freq[SET_MIN]);
+            if (!err) err = set_freq(cpuid, SET_MAX, set->freq[SET_MAX]);
         }
     }
-    else if (strncmp(argv[2], "max", 3) == 0)
+    else if (set->freq[SET_MIN] > 0)
     {
-        cmd = SET_MAX;
-        freq = read_freq(argv[3]);
-        if (!valid_freq(freq))
-        {
-            fprintf(stderr, "Invalid frequency %lu!\n\n",freq);
-            help(argv[0]);
-            exit(EXIT_FAILURE);
-        }
+        err = set_freq(cpuid, SET_MIN, set->freq[SET_MIN]);
     }
-    else if (strncmp(argv[2], "gov", 3) == 0)
+    else if (set->freq[SET_MAX] > 0)
     {
-        cmd = SET_GOV;
-        gov = argv[3];
-        /* Only allow specific governors */
-        if (!valid_gov(gov))
-        {
-            fprintf(stderr, "Invalid governor %s!\n\n",gov);
-            help(argv[0]);
-            exit(EXIT_FAILURE);
-        }
+        err = set_freq(cpuid, SET_MAX, set->freq[SET_MAX]);
     }
-    else
+    if (err)
     {
-        fprintf(stderr, "Unknown command %s!\n\n", argv[2]);
-        help(argv[0]);
-        exit(EXIT_FAILURE);
-    }
-
-    fpath = malloc(100 * sizeof(char));
-    if (!fpath)
-    {
-        fprintf(stderr, "Unable to allocate space!\n\n");
-        exit(EXIT_FAILURE);
+        return err;
     }
 
     /* If the current frequency should be set we have to make sure that the governor is
      * 'userspace'. Minimal and maximal frequency are possible for other governors but
      * they dynamically adjust the current clock speed.
      */
-    if (cmd == SET_CURRENT)
+    if (set->freq[SET_CURRENT] > 0)
     {
-        int tmp = 0;
-        char testgov[1024];
-        snprintf(fpath, 99, "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpuid);
+        char testgov[100];
+        char fpath[200];
+        FILE* f = NULL;
+        snprintf(fpath, 199, "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpuid);
         f = fopen(fpath, "r");
         if (f == NULL) {
             fprintf(stderr, "Unable to open path %s for reading\n",fpath);
-            free(fpath);
-            return (EXIT_FAILURE);
+            return -errno;
+        }
+        memset(testgov, 0, sizeof(testgov));
+        if (fgets(testgov, 100, f) == NULL)
+        {
+            testgov[0] = '\0';
         }
-        tmp = fread(testgov, 100, sizeof(char), f);
+        fclose(f);
         if (strncmp(testgov, "userspace", 9) != 0)
         {
-            fclose(f);
-            snprintf(fpath, 99, "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpuid);
-            f = fopen(fpath, "w");
-            if (f == NULL) {
-                fprintf(stderr, "Unable to open path %s for writing\n", fpath);
-                free(fpath);
-                return (EXIT_FAILURE);
+            err = write_sysfs(cpuid, "scaling_governor", "userspace");
+            if (err)
+            {
+                return err;
             }
-            fprintf(f,"userspace");
         }
-        fclose(f);
+        err = set_freq(cpuid, SET_CURRENT, set->freq[SET_CURRENT]);
+        if (err)
+        {
+            return err;
+        }
     }
+    if (set->gov)
+    {
+        err = write_sysfs(cpuid, "scaling_governor", set->gov);
+    }
+    return err;
+}
+
+/* #####  MAIN FUNCTION DEFINITION   ################## */
+
+int
+main (int argn, char** argv)
+{
+    int i = 0;
+    int numCPUs = 0;
+    int numSelected = 0;
+    int failed = 0;
+    int* cpus = NULL;
+    enum cmds cmd;
+    Settings set;
 
-    switch(cmd)
+    if (argn < 4 || (argn % 2) != 0)
     {
-        case SET_CURRENT:
-        case SET_MIN:
-        case SET_MAX:
-            /* The cmd is also used as index in the setfiles array */
-            snprintf(fpath, 99, "/sys/devices/system/cpu/cpu%d/cpufreq/%s", cpuid, setfiles[cmd]);
-            f = fopen(fpath, "w");
-            if (f == NULL) {
-                fprintf(stderr, "Unable to open path %s for writing\n",fpath);
-                free(fpath);
-                return (EXIT_FAILURE);
-            }
-            fprintf(f,"%d",freq);
-            fclose(f);
-            break;
-        case SET_GOV:
-            snprintf(fpath, 99, "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpuid);
-            f = fopen(fpath, "w");
-            if (f == NULL) {
-                fprintf(stderr, "Unable to open path %s for writing\n", fpath);
-                free(fpath);
-                return (EXIT_FAILURE);
+        help(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    memset(&set, 0, sizeof(Settings));
+
+    /* Check for valid CPUs */
+    numCPUs = get_numCPUs();
+    cpus = malloc(numCPUs * sizeof(int));
+    if (!cpus)
+    {
+        fprintf(stderr, "Unable to allocate space!\n\n");
+        exit(EXIT_FAILURE);
+    }
+    numSelected = read_cpulist(argv[1], cpus, numCPUs);
+    if (numSelected <= 0)
+    {
+        fprintf(stderr, "Invalid processor list %s!\n\n", argv[1]);
+        help(argv[0]);
+        free(cpus);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Read in commands and arguments, all are validated before anything is changed */
+    for (i = 2; i < argn; i += 2)
+    {
+        if (strncmp(argv[i], "cur", 3) == 0)
+        {
+            cmd = SET_CURRENT;
+        }
+        else if (strncmp(argv[i], "min", 3) == 0)
+        {
+            cmd = SET_MIN;
+        }
+        else if (strncmp(argv[i], "max", 3) == 0)
+        {
+            cmd = SET_MAX;
+        }
+        else if (strncmp(argv[i], "gov", 3) == 0)
+        {
+            cmd = SET_GOV;
+            set.gov = argv[i+1];
+            /* Only allow specific governors */
+            if (!valid_gov(set.gov))
+            {
+                fprintf(stderr, "Invalid governor %s!\n\n",set.gov);
+                help(argv[0]);
+                free(cpus);
+                exit(EXIT_FAILURE);
             }
-            fprintf(f,"%s",gov);
-            fclose(f);
-            break;
+            continue;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown command %s!\n\n", argv[i]);
+            help(argv[0]);
+            free(cpus);
+            exit(EXIT_FAILURE);
+        }
+        set.freq[cmd] = read_freq(argv[i+1]);
+        if (!valid_freq(set.freq[cmd]))
+        {
+            fprintf(stderr, "Invalid frequency %lu!\n\n",set.freq[cmd]);
+            help(argv[0]);
+            free(cpus);
+            exit(EXIT_FAILURE);
+        }
     }
-    
-    free(fpath);
-    return EXIT_SUCCESS;
 
-}
+    for (i = 0; i < numSelected; i++)
+    {
+        if (apply_settings(cpus[i], &set) != 0)
+        {
+            failed++;
+        }
+    }
 
+    free(cpus);
+    return (failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -59,9 +59,10 @@
 static int globalSocket = -1;
 static pid_t masterPid = 0;
 static int cpuSockets_open = 0;
-static int cpuSockets[MAX_NUM_THREADS] = { [0 ... MAX_NUM_THREADS-1] = -1};
+static int numCpuSockets = 0;
+static int* cpuSockets = NULL;
 static pthread_mutex_t globalLock = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t cpuLocks[MAX_NUM_THREADS] = { [0 ... MAX_NUM_THREADS-1] = PTHREAD_MUTEX_INITIALIZER };
+static pthread_mutex_t* cpuLocks = NULL;
 
 /* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
 
@@ -192,6 +193,36 @@ access_client_startDaemon(int cpu_id)
     return socket_fd;
 }
 
+static int
+access_client_allocate(void)
+{
+    int i;
+    /* Indexed by OS CPU id, numHWThreads only counts the CPUs of the cpuset */
+    int numCpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (numCpus < (int)cpuid_topology.numHWThreads)
+    {
+        numCpus = cpuid_topology.numHWThreads;
+    }
+    cpuSockets = (int*) malloc(numCpus * sizeof(int));
+    cpuLocks = (pthread_mutex_t*) malloc(numCpus * sizeof(pthread_mutex_t));
+    if ((cpuSockets == NULL) || (cpuLocks == NULL))
+    {
+        ERROR_PRINT(Cannot allocate socket list for %d CPUs, numCpus);
+        free(cpuSockets);
+        free(cpuLocks);
+        cpuSockets = NULL;
+        cpuLocks = NULL;
+        return -ENOMEM;
+    }
+    for (i = 0; i < numCpus; i++)
+    {
+        cpuSockets[i] = -1;
+        pthread_mutex_init(&cpuLocks[i], NULL);
+    }
+    numCpuSockets = numCpus;
+    return 0;
+}
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 int
@@ -201,6 +232,17 @@ access_client_init(int cpu_id)
     {
         return 0;
     }
+    pthread_mutex_lock(&globalLock);
+    if ((cpuSockets == NULL) && (access_client_allocate() < 0))
+    {
+        pthread_mutex_unlock(&globalLock);
+        return -ENOMEM;
+    }
+    pthread_mutex_unlock(&globalLock);
+    if ((cpu_id < 0) || (cpu_id >= numCpuSockets))
+    {
+        return -EINVAL;
+    }
     if (cpuSockets[cpu_id] < 0)
     {
         pthread_mutex_lock(&cpuLocks[cpu_id]);
@@ -240,6 +282,10 @@ access_client_read(PciDeviceIndex dev, const int cpu_id, uint32_t reg, uint64_t
     {
         return -ENOENT;
     }
+    if ((cpu_id < 0) || (cpu_id >= numCpuSockets))
+    {
+        return -EINVAL;
+    }
 
     if (cpuSockets[cpu_id] < 0 && gettid() != masterPid)
     {
@@ -311,6 +357,10 @@ access_client_write(PciDeviceIndex dev, const int cpu_id, uint32_t reg, uint64_t
     {
         return -ENOENT;
     }
+    if ((cpu_id < 0) || (cpu_id >= numCpuSockets))
+    {
+        return -EINVAL;
+    }
 
     if (cpuSockets[cpu_id] < 0 && gettid() != masterPid)
     {
@@ -368,6 +418,10 @@ void
 access_client_finalize(int cpu_id)
 {
     AccessDataRecord record;
+    if ((cpu_id < 0) || (cpu_id >= numCpuSockets))
+    {
+        return;
+    }
     if (cpuSockets[cpu_id] > 0)
     {
         record.type = DAEMON_EXIT;
@@ -379,6 +433,15 @@ access_client_finalize(int cpu_id)
     if (cpuSockets_open == 0)
     {
         globalSocket = -1;
+        for (int i = 0; i < numCpuSockets; i++)
+        {
+            pthread_mutex_destroy(&cpuLocks[i]);
+        }
+        free(cpuSockets);
+        free(cpuLocks);
+        cpuSockets = NULL;
+        cpuLocks = NULL;
+        numCpuSockets = 0;
     }
     masterPid = 0;
 }
@@ -394,6 +457,10 @@ access_client_check(PciDeviceIndex dev, int cpu_id)
     record.device = dev;
     record.type = DAEMON_CHECK;
     record.errorcode = ERR_OPENFAIL;
+    if ((cpu_id < 0) || (cpu_id >= numCpuSockets))
+    {
+        return 0;
+    }
     if (dev != MSR_DEV)
     {
         record.cpu = affinity_core2node_lookup[cpu_id];
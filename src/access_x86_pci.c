@@ -50,6 +50,7 @@
 #include <bstrlib.h>
 #include <error.h>
 #include <topology.h>
+#include <topology_cache.h>
 
 #include <access_x86_pci.h>
 
@@ -151,23 +152,30 @@ access_x86_pci_init(const int socket)
             }
         }
 
-#ifdef LIKWID_USE_HWLOC
-        DEBUG_PLAIN_PRINT(DEBUGLEV_DETAIL, Using hwloc to find pci devices);
-        ret = hwloc_pci_init(testDevice, socket_bus, &nr_sockets);
-        if (ret)
+        if (topology_cache_getPciBuses(0x8086, testDevice, socket_bus, &nr_sockets) == 0)
         {
-            ERROR_PLAIN_PRINT(Using hwloc to find pci devices failed);
-            return -ENODEV;
+            DEBUG_PLAIN_PRINT(DEBUGLEV_DETAIL, Using topology cache to find pci devices);
         }
-#else
-        DEBUG_PLAIN_PRINT(DEBUGLEV_DETAIL, Using procfs to find pci devices);
-        ret = proc_pci_init(testDevice, socket_bus, &nr_sockets);
-        if (ret)
+        else
         {
-            ERROR_PLAIN_PRINT(Using procfs to find pci devices failed);
-            return -ENODEV;
-        }
+#ifdef LIKWID_USE_HWLOC
+            DEBUG_PLAIN_PRINT(DEBUGLEV_DETAIL, Using hwloc to find pci devices);
+            ret = hwloc_pci_init(testDevice, socket_bus, &nr_sockets);
+            if (ret)
+            {
+                ERROR_PLAIN_PRINT(Using hwloc to find pci devices failed);
+                return -ENODEV;
+            }
+#else
+            DEBUG_PLAIN_PRINT(DEBUGLEV_DETAIL, Using procfs to find pci devices);
+            ret = proc_pci_init(testDevice, socket_bus, &nr_sockets);
+            if (ret)
+            {
+                ERROR_PLAIN_PRINT(Using procfs to find pci devices failed);
+                return -ENODEV;
+            }
 #endif
+        }
     }
 
     for(int j=1;j<MAX_NUM_PCI_DEVICES;j++)
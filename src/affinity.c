@@ -51,6 +51,7 @@
 #include <affinity.h>
 #include <tree.h>
 #include <topology.h>
+#include <topology_cache.h>
 
 /* #####   EXPORTED VARIABLES   ########################################### */
 
@@ -68,6 +69,7 @@ static AffinityDomain*  domains;
 static int affinity_initialized = 0;
 
 AffinityDomains affinityDomains;
+static TopologyLookup topologyLookup;
 
 /* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
 
@@ -147,6 +149,163 @@ treeFillNextEntries(
     return numberOfEntries-counter;
 }
 
+static int
+compareHWThreadPosition(const void* a, const void* b)
+{
+    const HWThread* x = &cpuid_topology.threadPool[*(const int*)a];
+    const HWThread* y = &cpuid_topology.threadPool[*(const int*)b];
+    if (x->packageId != y->packageId)
+    {
+        return (x->packageId < y->packageId ? -1 : 1);
+    }
+    if (x->coreId != y->coreId)
+    {
+        return (x->coreId < y->coreId ? -1 : 1);
+    }
+    if (x->threadId != y->threadId)
+    {
+        return (x->threadId < y->threadId ? -1 : 1);
+    }
+    return 0;
+}
+
+static int
+domainsSize(int first, int count)
+{
+    int size = 0;
+    for (int i = first; i < first + count; i++)
+    {
+        size += domains[i].numberOfProcessors;
+    }
+    return size;
+}
+
+static int*
+fillDomainLookup(int first, int count, int* map, int* offsets, int* hwthreads)
+{
+    int insert = 0;
+    for (int i = 0; i < count; i++)
+    {
+        offsets[i] = insert;
+        for (int j = 0; j < domains[first + i].numberOfProcessors; j++)
+        {
+            int cpu = domains[first + i].processorList[j];
+            map[cpu] = i;
+            hwthreads[insert++] = cpu;
+        }
+    }
+    offsets[count] = insert;
+    return hwthreads + insert;
+}
+
+static void
+finalizeTopologyLookup(void)
+{
+    /* all tables live in the allocation starting at hwthread2core */
+    free(topologyLookup.hwthread2core);
+    memset(&topologyLookup, 0, sizeof(TopologyLookup));
+}
+
+/* Build the flat lookup tables from the affinity domains. Socket, LLC and
+ * NUMA membership is taken from the S, C and M domains so that the tables
+ * agree with the domain names used in CPU strings. The cores and the SMT
+ * index are determined from the HW thread IDs of the topology. */
+static void
+initTopologyLookup(void)
+{
+    int numSockets = affinityDomains.numberOfSocketDomains;
+    int numCaches = affinityDomains.numberOfCacheDomains;
+    int numNuma = affinityDomains.numberOfNumaDomains;
+    int firstCache = 1 + numSockets;
+    int firstNuma = firstCache + numCaches;
+    int numActive = domains[0].numberOfProcessors;
+    int numIds = 0;
+    int sizeSockets = domainsSize(1, numSockets);
+    int sizeCaches = domainsSize(firstCache, numCaches);
+    int sizeNuma = domainsSize(firstNuma, numNuma);
+    int* sorted = NULL;
+    int* data = NULL;
+    int* ptr = NULL;
+
+    for (int i = 0; i < affinity_numberOfDomains; i++)
+    {
+        for (int j = 0; j < domains[i].numberOfProcessors; j++)
+        {
+            numIds = MAX(numIds, domains[i].processorList[j] + 1);
+        }
+    }
+    sorted = (int*) malloc(numActive * sizeof(int));
+    data = (int*) malloc((5 * numIds + numActive + sizeSockets + sizeCaches + sizeNuma +
+                          numActive + numSockets + numCaches + numNuma + 4) * sizeof(int));
+    if ((!sorted) || (!data))
+    {
+        ERROR_PLAIN_PRINT(Cannot allocate topology lookup tables);
+        free(sorted);
+        free(data);
+        return;
+    }
+    topologyLookup.numberOfHWThreads = numIds;
+    topologyLookup.hwthread2core = data;
+    topologyLookup.hwthread2socket = data + numIds;
+    topologyLookup.hwthread2cache = data + 2 * numIds;
+    topologyLookup.hwthread2numa = data + 3 * numIds;
+    topologyLookup.hwthread2smt = data + 4 * numIds;
+    for (int i = 0; i < 5 * numIds; i++)
+    {
+        data[i] = -1;
+    }
+    ptr = data + 5 * numIds;
+
+    topologyLookup.numberOfSockets = numSockets;
+    topologyLookup.socketOffsets = ptr;
+    topologyLookup.socketHWThreads = ptr + numSockets + 1;
+    ptr = fillDomainLookup(1, numSockets, topologyLookup.hwthread2socket,
+                           topologyLookup.socketOffsets,
+                           topologyLookup.socketHWThreads);
+    topologyLookup.numberOfCacheDomains = numCaches;
+    topologyLookup.cacheOffsets = ptr;
+    topologyLookup.cacheHWThreads = ptr + numCaches + 1;
+    ptr = fillDomainLookup(firstCache, numCaches, topologyLookup.hwthread2cache,
+                           topologyLookup.cacheOffsets,
+                           topologyLookup.cacheHWThreads);
+    topologyLookup.numberOfNumaDomains = numNuma;
+    topologyLookup.numaOffsets = ptr;
+    topologyLookup.numaHWThreads = ptr + numNuma + 1;
+    ptr = fillDomainLookup(firstNuma, numNuma, topologyLookup.hwthread2numa,
+                           topologyLookup.numaOffsets,
+                           topologyLookup.numaHWThreads);
+
+    /* Cores: sort the active HW threads by socket, core and thread ID */
+    numActive = 0;
+    for (int j = 0; j < domains[0].numberOfProcessors; j++)
+    {
+        if (domains[0].processorList[j] < cpuid_topology.numHWThreads)
+        {
+            sorted[numActive++] = domains[0].processorList[j];
+        }
+    }
+    qsort(sorted, numActive, sizeof(int), compareHWThreadPosition);
+    topologyLookup.coreOffsets = ptr;
+    topologyLookup.numberOfCores = 0;
+    for (int j = 0; j < numActive; j++)
+    {
+        HWThread* t = &cpuid_topology.threadPool[sorted[j]];
+        if ((j == 0) ||
+            (t->packageId != cpuid_topology.threadPool[sorted[j-1]].packageId) ||
+            (t->coreId != cpuid_topology.threadPool[sorted[j-1]].coreId))
+        {
+            topologyLookup.coreOffsets[topologyLookup.numberOfCores++] = j;
+        }
+        topologyLookup.hwthread2core[sorted[j]] = topologyLookup.numberOfCores - 1;
+        topologyLookup.hwthread2smt[sorted[j]] =
+            j - topologyLookup.coreOffsets[topologyLookup.numberOfCores - 1];
+    }
+    topologyLookup.coreOffsets[topologyLookup.numberOfCores] = numActive;
+    topologyLookup.coreHWThreads = topologyLookup.coreOffsets + topologyLookup.numberOfCores + 1;
+    memcpy(topologyLookup.coreHWThreads, sorted, numActive * sizeof(int));
+    free(sorted);
+}
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 void
@@ -167,6 +326,21 @@ affinity_init()
     numa_init();
     int numberOfNumaDomains = numa_info.numberOfNodes;
     DEBUG_PRINT(DEBUGLEV_DEVELOP, Affinity: NUMA domains %d, numberOfNumaDomains);
+    if (topology_cache_loadAffinity(&affinityDomains) == 0)
+    {
+        domains = affinityDomains.domains;
+        affinity_numberOfDomains = affinityDomains.numberOfAffinityDomains;
+        for (int i=0; i < affinityDomains.numberOfSocketDomains; i++ )
+        {
+            for ( int j = 0; j < domains[1 + i].numberOfProcessors; j++ )
+            {
+                affinity_core2node_lookup[domains[1 + i].processorList[j]] = i;
+            }
+        }
+        initTopologyLookup();
+        affinity_initialized = 1;
+        return;
+    }
     int numberOfProcessorsPerSocket =
         cpuid_topology.numCoresPerSocket * cpuid_topology.numThreadsPerCore;
     DEBUG_PRINT(DEBUGLEV_DEVELOP, Affinity: CPUs per socket %d, numberOfProcessorsPerSocket);
@@ -377,7 +551,9 @@ affinity_init()
     affinityDomains.numberOfCoresPerCache = numberOfCoresPerCache;
     affinityDomains.numberOfProcessorsPerCache = numberOfProcessorsPerCache;
     affinityDomains.domains = domains;
+    initTopologyLookup();
     affinity_initialized = 1;
+    topology_cache_store(&affinityDomains);
 }
 
 void
@@ -387,6 +563,7 @@ affinity_finalize()
     {
         return;
     }
+    finalizeTopologyLookup();
     if (!affinityDomains.domains)
     {
         return;
@@ -522,3 +699,13 @@ get_affinityDomains(void)
     return &affinityDomains;
 }
 
+TopologyLookup_t
+get_topologyLookup(void)
+{
+    if (affinity_initialized == 0)
+    {
+        return NULL;
+    }
+    return &topologyLookup;
+}
+
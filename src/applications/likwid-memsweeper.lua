@@ -46,6 +46,8 @@ local function examples()
     print_stdout("likwid-memsweeper -c 1-2")
     print_stdout("To clean specific domains:")
     print_stdout("likwid-memsweeper -c 0,1-2")
+    print_stdout("To show in which domains the memory of a process resides:")
+    print_stdout("likwid-memsweeper -p 4711")
 
 end
 
@@ -56,6 +58,7 @@ local function usage()
     print_stdout("-h\t\t Help message")
     print_stdout("-v\t\t Version information")
     print_stdout("-c <list>\t Specify NUMA domain ID to clean up")
+    print_stdout("-p <pid>\t Print the NUMA placement of the writable memory of a process")
     print_stdout("")
     examples()
 end
@@ -68,7 +71,38 @@ for i,_ in pairs(numainfo["nodes"]) do
     end
 end
 
-for opt,arg in likwid.getopt(arg, {"c:", "h", "v", "help", "version"}) do
+local function printPlacement(pid)
+    local f = io.open(string.format("/proc/%d/maps", pid), "r")
+    if f == nil then
+        print_stderr(string.format("Cannot read memory mappings of process %d", pid))
+        os.exit(1)
+    end
+    print_stdout(string.format("NUMA placement of process %d:", pid))
+    for line in f:lines() do
+        local s, e, perms, path = line:match("^(%x+)-(%x+)%s+(%S+)%s+%S+%s+%S+%s+%S+%s*(.*)$")
+        if s ~= nil and perms:sub(1,2) == "rw" then
+            local start = tonumber(s, 16)
+            local size = tonumber(e, 16) - start
+            local pages, counts = likwid.getPagePlacement(pid, start, size)
+            if pages ~= nil and pages > 0 then
+                local str = string.format("%s %s %.2f MB:", s, (path ~= "" and path or "[anon]"), size/(1024*1024))
+                local touched = 0
+                for i, c in pairs(counts) do
+                    if c > 0 then
+                        str = str .. string.format(" domain %d %.1f%%", i-1, (100.0*c)/pages)
+                        touched = touched + c
+                    end
+                end
+                if touched > 0 then
+                    print_stdout(str)
+                end
+            end
+        end
+    end
+    f:close()
+end
+
+for opt,arg in likwid.getopt(arg, {"c:", "p:", "h", "v", "help", "version"}) do
     if opt == "h" or opt == "help" then
         usage()
         os.exit(0)
@@ -77,6 +111,14 @@ for opt,arg in likwid.getopt(arg, {"c:", "h", "v", "help", "version"}) do
         os.exit(0)
     elseif (opt == "c") then
         num_nodes, nodes = likwid.nodestr_to_nodelist(arg)
+    elseif (opt == "p") then
+        if tonumber(arg) == nil then
+            print_stderr("Argument for -p must be a process ID")
+            os.exit(1)
+        end
+        printPlacement(tonumber(arg))
+        likwid.putNumaInfo()
+        os.exit(0)
     elseif opt == "?" then
         print_stderr("Invalid commandline option -"..arg)
         os.exit(1)
@@ -86,7 +128,16 @@ for opt,arg in likwid.getopt(arg, {"c:", "h", "v", "help", "version"}) do
     end
 end
 
-for i,socket in pairs(nodes) do
-    likwid.memSweepDomain(socket)
+-- Select one CPU per NUMA domain, the domains are swept concurrently
+local cpus = {}
+for i,node in pairs(nodes) do
+    for j, n in pairs(numainfo["nodes"]) do
+        if tonumber(n["id"]) == tonumber(node) and n["processors"][1] ~= nil then
+            table.insert(cpus, n["processors"][1])
+        end
+    end
+end
+if #cpus > 0 then
+    likwid.memSweep(#cpus, cpus)
 end
 likwid.putNumaInfo()
@@ -54,6 +54,10 @@ local function examples()
     print_stdout("Each MPI processes may start 2 OpenMP threads pinned to the first two CPUs on each socket")
     print_stdout("likwid-mpirun -pin S0:0-1_S1:0-1 ./a.out")
     print_stdout("")
+    print_stdout("Starts 4 MPI processes on each host, distributed evenly over the NUMA domains")
+    print_stdout("Each MPI process may start 2 OpenMP threads in its NUMA domain")
+    print_stdout("likwid-mpirun -placement numa_balanced:4x2 ./a.out")
+    print_stdout("")
     print_stdout("Run 2 processes on each socket and measure the MEM performance group")
     print_stdout("likwid-mpirun -nperdomain S:2 -g MEM ./a.out")
     print_stdout("Only one process on a socket measures the Uncore/RAPL counters, the other one(s) only core-local counters")
@@ -70,6 +74,8 @@ local function usage()
     print_stdout("-n/-np <count>\t\t Set the number of processes")
     print_stdout("-nperdomain <domain>\t Set the number of processes per node by giving an affinity domain and count")
     print_stdout("-pin <list>\t\t Specify pinning of threads. CPU expressions like likwid-pin separated with '_'")
+    print_stdout("-placement <policy>:<ranks>x<threads>\t Place processes and their threads with a placement policy")
+    print_stdout("\t\t\t Policies: compact_llc, spread_mem, cores_first and numa_balanced")
     print_stdout("-s, --skip <hex>\t Bitmask with threads to skip")
     print_stdout("-mpi <id>\t\t Specify which MPI should be used. Possible values: openmpi, intelmpi and mvapich2")
     print_stdout("\t\t\t If not set, module system is checked")
@@ -936,6 +942,35 @@ local function calculateCpuExprs(nperdomain, cpuexprs)
     return newexprs
 end
 
+local function calculatePlacementExprs(placement)
+    local newexprs = {}
+    local policy, ranks, threads = placement:match("^([%a_]+):(%d+)x(%d+)$")
+    if policy == nil then
+        policy, ranks = placement:match("^([%a_]+):(%d+)$")
+        threads = 1
+    end
+    if policy == nil then
+        return newexprs
+    end
+    ranks = tonumber(ranks)
+    threads = tonumber(threads)
+    local amount, list = likwid.cpustr_to_cpulist(string.format("P:%s:%dx%d", policy, ranks, threads))
+    if amount == nil or amount < ranks * threads then
+        return newexprs
+    end
+    for r=1,ranks do
+        local strList = {}
+        for t=1,threads do
+            table.insert(strList, list[((r-1)*threads) + t])
+        end
+        table.insert(newexprs, table.concat(strList, ","))
+    end
+    if debug then
+        print_stdout("DEBUG: Resolved placement "..placement.." to CPU expressions: "..table.concat(newexprs, " "))
+    end
+    return newexprs
+end
+
 local function createEventString(eventlist)
     if eventlist == nil or #eventlist == 0 then
         print_stderr("ERROR: Empty event list. Failed to create event set string")
@@ -1602,7 +1637,7 @@ if #arg == 0 then
     os.exit(0)
 end
 
-for opt,arg in likwid.getopt(arg, {"n:","np:", "nperdomain:","pin:","hostfile:","h","help","v","g:","group:","mpi:","omp:","d","m","O","debug","marker","version","s:","skip:","f"}) do
+for opt,arg in likwid.getopt(arg, {"n:","np:", "nperdomain:","pin:","placement:","hostfile:","h","help","v","g:","group:","mpi:","omp:","d","m","O","debug","marker","version","s:","skip:","f"}) do
     if (type(arg) == "string") then
         local s,e = arg:find("-")
         if s == 1 then
@@ -1643,6 +1678,12 @@ for opt,arg in likwid.getopt(arg, {"n:","np:", "nperdomain:","pin:","hostfile:",
         hostfile = arg
     elseif opt == "pin" then
         cpuexprs = likwid.stringsplit(arg, "_")
+    elseif opt == "placement" then
+        cpuexprs = calculatePlacementExprs(arg)
+        if #cpuexprs == 0 then
+            print_stderr("Invalid option to -placement")
+            os.exit(1)
+        end
     elseif opt == "g" or opt == "group" then
         table.insert(perf, arg)
     elseif opt == "mpi" then
@@ -1662,7 +1703,7 @@ end
 
 
 if np == 0 and nperdomain == nil and #cpuexprs == 0 then
-    print_stderr("ERROR: No option -n/-np, -nperdomain or -pin")
+    print_stderr("ERROR: No option -n/-np, -nperdomain, -pin or -placement")
     os.exit(1)
 end
 
@@ -76,6 +76,7 @@ local function usage()
     io.stdout:write("Modes:")
     io.stdout:write("-S <time>\t\t Stethoscope mode with duration in s, ms or us, e.g 20ms\n")
     io.stdout:write("-t <time>\t\t Timeline mode with frequency in s, ms or us, e.g. 300ms\n")
+    io.stdout:write("--effclock\t\t Add the effective clock (APERF/MPERF) of each CPU to the timeline output\n")
     io.stdout:write("-m, --marker\t\t Use Marker API inside code\n")
     io.stdout:write("Output options:\n")
     io.stdout:write("-o, --output <file>\t Store output to file. (Optional: Apply text filter according to filename suffix)\n")
@@ -126,6 +127,7 @@ overflow_interval = 2.E06
 output = ""
 use_csv = false
 print_stats = false
+use_effclock = false
 execString = nil
 outfile = nil
 forceOverwrite = 0
@@ -139,7 +141,7 @@ if #arg == 0 then
     os.exit(0)
 end
 
-for opt,arg in likwid.getopt(arg, {"a", "c:", "C:", "e", "E:", "g:", "h", "H", "i", "m", "M:", "o:", "O", "P", "s:", "S:", "t:", "v", "V:", "T:", "f", "group:", "help", "info", "version", "verbose:", "output:", "skip:", "marker", "force", "stats"}) do
+for opt,arg in likwid.getopt(arg, {"a", "c:", "C:", "e", "E:", "g:", "h", "H", "i", "m", "M:", "o:", "O", "P", "s:", "S:", "t:", "v", "V:", "T:", "f", "group:", "help", "info", "version", "verbose:", "output:", "skip:", "marker", "force", "stats", "effclock"}) do
     if (type(arg) == "string") then
         local s,e = arg:find("-");
         if s == 1 then
@@ -296,6 +298,8 @@ for opt,arg in likwid.getopt(arg, {"a", "c:", "C:", "e", "E:", "g:", "h", "H", "
         use_csv = true
     elseif (opt == "stats") then
         print_stats = true
+    elseif (opt == "effclock") then
+        use_effclock = true
     elseif opt == "?" then
         print_stderr("Invalid commandline option -"..arg)
         if outfile ~= nil and likwid.access(outfile..".tmp", "e") == 0 then
@@ -537,6 +541,11 @@ if use_stethoscope == false and use_timeline == false and use_marker == false th
     use_wrapper = true
 end
 
+if use_effclock == true and use_timeline == false then
+    print_stderr("Effective clock output is only available in Timeline mode")
+    use_effclock = false
+end
+
 if use_wrapper and likwid.tablelength(arg)-2 == 0 and print_info == false then
     print_stderr("No Executable can be found on commandline")
     usage()
@@ -685,6 +694,11 @@ elseif not ldpath:match(libpath) then
 end
 
 
+if use_effclock == true and likwid.initEffectiveClock(#cpulist, cpulist) ~= 0 then
+    print_stderr("Cannot read APERF/MPERF registers, effective clock not available")
+    use_effclock = false
+end
+
 if use_timeline == true then
     local cores_string = "CORES: "
     for i, cpu in pairs(cpulist) do
@@ -702,6 +716,9 @@ if use_timeline == true then
                 table.insert(strlist, e["description"])
             end
         end
+        if use_effclock == true then
+            table.insert(strlist, "Effective clock [MHz]")
+        end
         print_stderr("# "..table.concat(strlist, "|").."\n")
     end
 end
@@ -728,6 +745,7 @@ if use_wrapper or use_timeline then
         print_stderr(string.format("Error starting counters for cpu %d.",cpulist[ret * (-1)]))
         os.exit(1)
     end
+    likwid.startOverflowGuard()
 
     local pid = nil
     if execString:len() > 0 then
@@ -741,6 +759,7 @@ if use_wrapper or use_timeline then
     end
 
     if not pid then
+        likwid.stopOverflowGuard()
         print_stderr("Failed to execute command: ".. execString)
         likwid.putTopology()
         likwid.putNumaInfo()
@@ -748,6 +767,9 @@ if use_wrapper or use_timeline then
         os.exit(1)
     else
         start = likwid.startClock()
+        if use_effclock == true then
+            likwid.readEffectiveClock()
+        end
         groupTime[activeGroup] = 0
         while true do
             if likwid.getSignalState() ~= 0 then
@@ -773,12 +795,25 @@ if use_wrapper or use_timeline then
                 else
                     results = likwid.getLastMetrics()
                 end
-                str = tostring(math.tointeger(activeGroup)) .. " "..tostring(#results[activeGroup]).." "..tostring(#cpulist).." "..tostring(time)
+                local nr_results = #results[activeGroup]
+                local clocks = nil
+                if use_effclock == true then
+                    clocks = likwid.readEffectiveClock()
+                    if clocks then
+                        nr_results = nr_results + 1
+                    end
+                end
+                str = tostring(math.tointeger(activeGroup)) .. " "..tostring(nr_results).." "..tostring(#cpulist).." "..tostring(time)
                 for i,l1 in pairs(results[activeGroup]) do
                     for j, value in pairs(l1) do
                         str = str .. " " .. tostring(value)
                     end
                 end
+                if clocks then
+                    for j, value in pairs(clocks) do
+                        str = str .. " " .. tostring(value * 1.E-6)
+                    end
+                end
                 io.stderr:write(str.."\n")
                 groupTime[activeGroup] = time
             else
@@ -794,6 +829,7 @@ if use_wrapper or use_timeline then
             end
         end
         stop = likwid.stopClock()
+        likwid.stopOverflowGuard()
     end
 elseif use_stethoscope then
     local ret = likwid.startCounters()
@@ -801,14 +837,18 @@ elseif use_stethoscope then
         print_stderr(string.format("Error starting counters for cpu %d.",cpulist[ret * (-1)]))
         os.exit(1)
     end
+    likwid.startOverflowGuard()
     likwid.sleep(duration)
+    likwid.stopOverflowGuard()
 elseif use_marker then
     local ret = likwid.startCounters()
     if ret < 0 then
         print_stderr(string.format("Error starting counters for cpu %d.",cpulist[ret * (-1)]))
         os.exit(1)
     end
+    likwid.startOverflowGuard()
     local ret = os.execute(execString)
+    likwid.stopOverflowGuard()
     if ret == nil then
         print_stderr("Failed to execute command: ".. execString)
         exitvalue = 1
@@ -889,6 +929,9 @@ if outfile then
     end
 end
 
+if use_effclock == true then
+    likwid.finalizeEffectiveClock()
+end
 likwid.finalize()
 likwid.putTopology()
 likwid.putNumaInfo()
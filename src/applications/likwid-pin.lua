@@ -41,7 +41,7 @@ end
 
 local function examples()
     print_stdout("Examples:")
-    print_stdout("There are three possibilities to provide a thread to processor list:")
+    print_stdout("There are five possibilities to provide a thread to processor list:")
     print_stdout("1. Thread list with physical thread IDs")
     print_stdout("Example: likwid-pin.lua -c 0,4-6 ./myApp")
     print_stdout("Pins the application to cores 0,4,5 and 6")
@@ -65,6 +65,12 @@ local function examples()
     print_stdout("Example usage scatter: likwid-pin.lua -c M:scatter ./myApp")
     print_stdout("This will generate a thread to processor mapping scattered among all memory domains")
     print_stdout("with physical cores first.")
+    print_stdout("5. Placement policies based on the cache, NUMA and SMT layout.")
+    print_stdout("Example usage placement: likwid-pin.lua -c P:compact_llc:8 ./myApp")
+    print_stdout("The following syntax variants are available:")
+    print_stdout("\t1. -c P:<policy>:<number of threads>")
+    print_stdout("\t2. -c P:<policy>:<ranks>x<threads per rank>")
+    print_stdout("\tPolicies: compact_llc, spread_mem, cores_first and numa_balanced")
     print_stdout("")
     print_stdout("likwid-pin sets OMP_NUM_THREADS with as many threads as specified")
     print_stdout("in your pin expression if OMP_NUM_THREADS is not present in your environment.")
@@ -80,7 +86,12 @@ local function usage()
     print_stdout("-i\t\t\t Set numa interleave policy with all involved numa nodes")
     print_stdout("-S, --sweep\t\t Sweep memory and LLC of involved NUMA nodes")
     print_stdout("-c <list>\t\t Comma separated processor IDs or expression")
-    print_stdout("-s, --skip <hex>\t Bitmask with threads to skip")
+    print_stdout("-s, --skip <hex>\t Bitmask with threads to skip, may be longer than 64 bits")
+    print_stdout("--skip-caller <list>\t Skip threads created by or running functions of the given")
+    print_stdout("\t\t\t comma separated libraries or functions, e.g. libmpi,libtbb")
+    print_stdout("--skip-name <list>\t Skip threads that name themselves with one of the given names")
+    print_stdout("--leastloaded\t\t Pin threads created after the list is used up to the least")
+    print_stdout("\t\t\t loaded CPU of the list in the socket of the creating thread")
     print_stdout("-p\t\t\t Print available domains with mapping on physical IDs")
     print_stdout("\t\t\t If used together with -p option outputs a physical processor IDs.")
     print_stdout("-d <string>\t\t Delimiter used for using -p to output physical processor list, default is comma.")
@@ -96,6 +107,9 @@ interleaved_policy = false
 print_domains = false
 cpu_list = {}
 skip_mask = nil
+skip_caller = nil
+skip_name = nil
+least_loaded = false
 affinity = nil
 num_threads = 0
 
@@ -109,7 +123,7 @@ if (#arg == 0) then
     os.exit(0)
 end
 
-for opt,arg in likwid.getopt(arg, {"c:", "d:", "h", "i", "p", "q", "s:", "S", "t:", "v", "V:", "verbose:", "help", "version", "skip","sweep", "quiet"}) do
+for opt,arg in likwid.getopt(arg, {"c:", "d:", "h", "i", "p", "q", "s:", "S", "t:", "v", "V:", "verbose:", "help", "version", "skip","sweep", "quiet", "skip-caller:", "skip-name:", "leastloaded"}) do
     if opt == "h" or opt == "help" then
         usage()
         likwid.putTopology()
@@ -160,6 +174,12 @@ for opt,arg in likwid.getopt(arg, {"c:", "d:", "h", "i", "p", "q", "s:", "S", "t
             os.exit(1)
         end
         skip_mask = arg
+    elseif opt == "skip-caller" then
+        skip_caller = arg
+    elseif opt == "skip-name" then
+        skip_name = arg
+    elseif opt == "leastloaded" then
+        least_loaded = true
     elseif opt == "q" or opt == "quiet" then
         likwid.setenv("LIKWID_SILENT","true")
         quiet = 1
@@ -238,6 +258,15 @@ end
 if skip_mask then
     likwid.setenv("LIKWID_SKIP", skip_mask)
 end
+if skip_caller then
+    likwid.setenv("LIKWID_SKIP_CALLER", skip_caller)
+end
+if skip_name then
+    likwid.setenv("LIKWID_SKIP_NAME", skip_name)
+end
+if least_loaded then
+    likwid.setenv("LIKWID_PIN_OVERFLOW", "leastloaded")
+end
 
 if num_threads > 1 then
     local pinString = tostring(math.tointeger(cpu_list[2]))
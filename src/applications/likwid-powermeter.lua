@@ -47,6 +47,9 @@ local function examples()
     print_stdout("")
     print_stdout("Use it as wrapper for an application to measure the energy for the whole execution")
     print_stdout("likwid-powermeter -c 1 ./a.out")
+    print_stdout("")
+    print_stdout("Write a power trace of all RAPL domains with 10 ms resolution to a CSV file")
+    print_stdout("likwid-powermeter -T 10ms -o trace.csv ./a.out")
 end
 
 local function usage()
@@ -61,6 +64,10 @@ local function usage()
     print_stdout("-i, --info\t Print information from MSR_PKG_POWER_INFO register and Turbo mode")
     print_stdout("-s <duration>\t Set measure duration in us, ms or s. (default 2s)")
     print_stdout("-p\t\t Print dynamic clocking and CPI values, uses likwid-perfctr")
+    print_stdout("-e\t\t Print effective clock of the measured sockets based on APERF/MPERF")
+    print_stdout("-T, --timeline <time>\t Timeline mode, print the power of all RAPL domains every <time>")
+    print_stdout("\t\t (s, ms or us, minimum 1ms) as CSV to stderr")
+    print_stdout("-o, --output <file>\t Write the timeline to <file> instead of stderr")
     print_stdout("-t\t\t Print current temperatures of all CPU cores")
     print_stdout("-f\t\t Print current temperatures in Fahrenheit")
     print_stdout("")
@@ -74,6 +81,7 @@ use_perfctr = false
 stethoscope = false
 fahrenheit = false
 print_temp = false
+use_effclock = false
 verbose = 0
 if config["daemonMode"] < 0 then
     access_mode = 1
@@ -81,17 +89,20 @@ else
     access_mode = config["daemonMode"]
 end
 time_interval = 2.E06
+use_timeline = false
+timeline_interval = 0
+timeline_file = nil
 time_orig = "2s"
 read_interval = 30.E06
 sockets = {}
-domainList = {"PKG", "PP0", "PP1", "DRAM"}
+domainList = {"PKG", "PP0", "PP1", "DRAM", "PLATFORM"}
 
 cpuinfo = likwid.getCpuInfo()
 cputopo = likwid.getCpuTopology()
 numatopo = likwid.getNumaInfo()
 affinity = likwid_getAffinityInfo()
 
-for opt,arg in likwid.getopt(arg, {"V:", "c:", "h", "i", "M:", "p", "s:", "v", "f", "t", "help", "info", "version", "verbose:"}) do
+for opt,arg in likwid.getopt(arg, {"V:", "c:", "e", "h", "i", "M:", "o:", "p", "s:", "T:", "v", "f", "t", "help", "info", "version", "verbose:", "timeline:", "output:"}) do
     if (type(arg) == "string") then
         local s,e = arg:find("-");
         if s == 1 then
@@ -126,6 +137,17 @@ for opt,arg in likwid.getopt(arg, {"V:", "c:", "h", "i", "M:", "p", "s:", "v", "
         print_info = true
     elseif (opt == "p") then
         use_perfctr = true
+    elseif (opt == "e") then
+        use_effclock = true
+    elseif opt == "T" or opt == "timeline" then
+        timeline_interval = likwid.parse_time(arg)
+        use_timeline = true
+        if timeline_interval < 1000 then
+            print_stderr("Timeline interval too short, minimum is 1ms")
+            os.exit(1)
+        end
+    elseif opt == "o" or opt == "output" then
+        timeline_file = arg
     elseif (opt == "f") then
         fahrenheit = true
         print_temp = true
@@ -282,6 +304,142 @@ else
     end
 end
 
+effcpus = {}
+effsockets = {}
+if use_effclock and not use_perfctr then
+    for i,socket in pairs(sockets) do
+        for j, domain in pairs(affinity["domains"]) do
+            if domain["tag"] == "S"..tostring(socket) then
+                for k, cpu in pairs(domain["processorList"]) do
+                    table.insert(effcpus, cpu)
+                    table.insert(effsockets, i)
+                end
+            end
+        end
+    end
+    if #effcpus == 0 or likwid.initEffectiveClock(#effcpus, effcpus) ~= 0 then
+        print_stderr("Cannot read APERF/MPERF registers, effective clock not available")
+        use_effclock = false
+    end
+end
+
+local function socketClock(clocks, c0, sock)
+    local sum = 0
+    local busy = 0
+    local minclock = nil
+    local maxclock = 0
+    local nr = 0
+    local nrbusy = 0
+    for k, c in pairs(clocks) do
+        if effsockets[k] == sock then
+            nr = nr + 1
+            busy = busy + c0[k]
+            if c0[k] > 0 then
+                sum = sum + c
+                nrbusy = nrbusy + 1
+                if minclock == nil or c < minclock then minclock = c end
+                if c > maxclock then maxclock = c end
+            end
+        end
+    end
+    if nrbusy == 0 then
+        return 0, 0, 0, 0
+    end
+    return sum/nrbusy, minclock, maxclock, busy/nr
+end
+
+local function runTimeline(pid)
+    local out = io.stderr
+    local exitvalue = 0
+    local last = {}
+    local header = {"Time [s]"}
+    if timeline_file then
+        out = io.open(timeline_file, "w")
+        if not out then
+            print_stderr(string.format("Cannot open file %s for writing", timeline_file))
+            return 1
+        end
+    end
+    for i,socket in pairs(sockets) do
+        for idx, dom in pairs(domainList) do
+            if power["domains"][dom]["supportStatus"] then
+                table.insert(header, string.format("S%d:%s [W]", socket, dom))
+            end
+        end
+        if use_effclock then
+            table.insert(header, string.format("S%d:Clock [MHz]", socket))
+        end
+        last[i] = likwid.readPowerDomains(cpulist[i])
+        if not last[i] then
+            print_stderr(string.format("Cannot read RAPL domains of socket %d", socket))
+            return 1
+        end
+    end
+    out:write("# "..table.concat(header, ",").."\n")
+    if use_effclock then
+        likwid.readEffectiveClock()
+    end
+
+    -- Samples are taken at fixed multiples of the interval to avoid drift, the
+    -- power is calculated from the energy difference to the previous sample
+    local start = likwid.startClock()
+    local lasttime = 0
+    local samples = 0
+    while true do
+        if likwid.getSignalState() ~= 0 then
+            if pid then
+                likwid.killProgram()
+            end
+            break
+        end
+        samples = samples + 1
+        local wait = samples * timeline_interval - likwid.getClock(start, likwid.stopClock()) * 1.E06
+        if wait >= 1 then
+            likwid.sleep(math.floor(wait))
+        end
+        local now = likwid.getClock(start, likwid.stopClock())
+        local values = {string.format("%.6f", now)}
+        local clocks, c0 = nil, nil
+        if use_effclock then
+            clocks, c0 = likwid.readEffectiveClock()
+        end
+        for i,socket in pairs(sockets) do
+            local cur = likwid.readPowerDomains(cpulist[i])
+            if not cur then
+                cur = last[i]
+            end
+            for idx, dom in pairs(domainList) do
+                if power["domains"][dom]["supportStatus"] then
+                    local energy = likwid.calcPower(last[i][idx], cur[idx], idx-1)
+                    table.insert(values, string.format("%.3f", energy/(now-lasttime)))
+                end
+            end
+            if use_effclock then
+                local clock = 0
+                if clocks then
+                    clock = socketClock(clocks, c0, i)
+                end
+                table.insert(values, string.format("%.0f", clock*1.E-6))
+            end
+            last[i] = cur
+        end
+        out:write(table.concat(values, ",").."\n")
+        lasttime = now
+        if pid then
+            exitvalue = likwid.checkProgram(pid)
+            if exitvalue >= 0 then
+                break
+            end
+        elseif now * 1.E06 >= time_interval then
+            break
+        end
+    end
+    if timeline_file then
+        out:close()
+    end
+    return math.max(exitvalue, 0)
+end
+
 local exitvalue = 0
 if not print_info and not print_temp then
     if stethoscope or (#arg > 0 and not use_perfctr) then
@@ -292,8 +450,22 @@ if not print_info and not print_temp then
             end
         end
 
+        if use_effclock then
+            likwid.readEffectiveClock()
+        end
         time_before = likwid.startClock()
-        if stethoscope then
+        if use_timeline then
+            local pid = nil
+            if not stethoscope then
+                pid = likwid.startProgram(execString, 0, {})
+                if not pid then
+                    print_stderr(string.format("Failed to execute %s!",execString))
+                    likwid.finalize()
+                    os.exit(1)
+                end
+            end
+            exitvalue = runTimeline(pid)
+        elseif stethoscope then
             if read_interval < time_interval then
                 while ((read_interval <= time_interval) and (time_interval > 0)) do
                     likwid.sleep(read_interval)
@@ -346,6 +518,11 @@ if not print_info and not print_temp then
             end
         end
         runtime = likwid.getClock(time_before, time_after)
+        local clocks = nil
+        local c0 = nil
+        if use_effclock and not use_timeline then
+            clocks, c0 = likwid.readEffectiveClock()
+        end
 
         print_stdout(likwid.hline)
         print_stdout(string.format("Runtime: %g s",runtime))
@@ -361,6 +538,13 @@ if not print_info and not print_temp then
                     print_stdout(string.format("Power consumed: %g Watt",energy/runtime))
                 end
             end
+            if clocks then
+                local avgclock, minclock, maxclock, busy = socketClock(clocks, c0, i)
+                if avgclock > 0 then
+                    print_stdout(string.format("Effective clock: %g MHz (min %g MHz, max %g MHz)", avgclock*1.E-6, minclock*1.E-6, maxclock*1.E-6))
+                end
+                print_stdout(string.format("C0 residency: %.1f %%", busy*100))
+            end
             if i < #sockets then print_stdout("") end
         end
         print_stdout(likwid.hline)
@@ -398,6 +582,9 @@ if print_temp and (string.find(cpuinfo["features"],"TM2") ~= nil) then
     print_stdout(likwid.hline)
 end
 
+if use_effclock then
+    likwid.finalizeEffectiveClock()
+end
 likwid.putPowerInfo()
 likwid.finalize()
 os.exit(exitvalue)
@@ -345,74 +345,31 @@ if governor == "turbo" then
     frequency = availturbo
 end
 
-if min_freq then
-    for i=1,#cpulist do
-        local valid_freq = false
-        for k,v in pairs(availfreqs) do
-            if (min_freq == v) then
-                valid_freq = true
-                break
-            end
-        end
-        if min_freq == availturbo then
-            valid_freq = true
-        end
-        if not valid_freq then
-            print_stderr(string.format("ERROR: Selected min. frequency %s not available for CPU %d! Please select one of\n%s", min_freq, cpulist[i], table.concat(availfreqs, ", ")))
-            os.exit(1)
-        end
-        local f = likwid.setCpuClockMin(cpulist[i], tonumber(min_freq)*1E6)
+local function checkFreq(freq, name)
+    if freq == availturbo then
+        return true
     end
-end
-
-if max_freq then
-    for i=1,#cpulist do
-        local valid_freq = false
-        for k,v in pairs(availfreqs) do
-            if (max_freq == v) then
-                valid_freq = true
-                break
-            end
-        end
-        if max_freq == availturbo then
-            valid_freq = true
-        end
-        if not valid_freq then
-            print_stderr(string.format("ERROR: Selected max. frequency %s not available for CPU %d! Please select one of\n%s", max_freq, cpulist[i], table.concat(availfreqs, ", ")))
-            os.exit(1)
+    for k,v in pairs(availfreqs) do
+        if (freq == v) then
+            return true
         end
-        local f = likwid.setCpuClockMax(cpulist[i], tonumber(max_freq)*1E6)
     end
+    print_stderr(string.format("ERROR: Selected %s %s not available! Please select one of\n%s", name, freq, table.concat(availfreqs, ", ")))
+    return false
 end
 
-if frequency then
-    for i=1,#cpulist do
-        
-        local valid_freq = false
-        for k,v in pairs(availfreqs) do
-            if (frequency == v) then
-                valid_freq = true
-                break
-            end
-        end
-        if frequency == availturbo then
-            valid_freq = true
-        end
-        if not valid_freq then
-            print_stderr(string.format("ERROR: Selected frequency %s not available for CPU %d! Please select one of\n%s", frequency, cpulist[i], table.concat(availfreqs, ", ")))
-            os.exit(1)
-        end
-        local f = likwid.setCpuClockCurrent(cpulist[i], tonumber(frequency)*1E6)
-    end
+if min_freq and not checkFreq(min_freq, "min. frequency") then
+    os.exit(1)
+end
+if max_freq and not checkFreq(max_freq, "max. frequency") then
+    os.exit(1)
+end
+if frequency and not checkFreq(frequency, "frequency") then
+    os.exit(1)
 end
 
 if governor then
     local govs = likwid.getAvailGovs(cpulist[1])
-    local cur_govs = {}
-    for i,c in pairs(cpulist) do
-        table.insert(cur_govs, likwid.getGovernor(cpulist[1]))
-    end
-    
     local valid_gov = false
     for k,v in pairs(govs) do
         if (governor == v) then
@@ -420,23 +377,27 @@ if governor then
             break
         end
     end
-    local cur_freqs = {}
     if governor == "turbo" and availturbo ~= "0" then
         valid_gov = true
         governor = "performance"
-        for i=1,#cpulist do
-            cur_freqs[cpulist[i]] = availturbo
-        end
     end
     if not valid_gov then
         print_stderr(string.format("ERROR: Governor %s not available! Please select one of\n%s", governor, table.concat(govs, ", ")))
         os.exit(1)
     end
-    for i=1,#cpulist do
-        if governor ~= cur_govs[i] then
-            local f = likwid.setGovernor(cpulist[i], governor)
-        end
-    end
+end
+
+-- All settings for all CPUs are applied with a single call of the frequency daemon
+local ret = likwid.setFreqList(cpulist,
+                               min_freq and tonumber(min_freq)*1E6 or nil,
+                               max_freq and tonumber(max_freq)*1E6 or nil,
+                               frequency and tonumber(frequency)*1E6 or nil,
+                               governor)
+if ret ~= 0 then
+    print_stderr("ERROR: Failed to apply the frequency settings")
+    likwid.putAffinityInfo()
+    likwid.putTopology()
+    os.exit(1)
 end
 likwid.putAffinityInfo()
 likwid.putTopology()
@@ -56,6 +56,8 @@ likwid.setupCounters = likwid_setupCounters
 likwid.startCounters = likwid_startCounters
 likwid.stopCounters = likwid_stopCounters
 likwid.readCounters = likwid_readCounters
+likwid.startOverflowGuard = likwid_startOverflowGuard
+likwid.stopOverflowGuard = likwid_stopOverflowGuard
 likwid.switchGroup = likwid_switchGroup
 likwid.finalize = likwid_finalize
 likwid.getEventsAndCounters = likwid_getEventsAndCounters
@@ -82,6 +84,7 @@ likwid.getCpuTopology = likwid_getCpuTopology
 likwid.putTopology = likwid_putTopology
 likwid.getNumaInfo = likwid_getNumaInfo
 likwid.putNumaInfo = likwid_putNumaInfo
+likwid.getPagePlacement = likwid_getPagePlacement
 likwid.setMemInterleaved = likwid_setMemInterleaved
 likwid.getAffinityInfo = likwid_getAffinityInfo
 likwid.putAffinityInfo = likwid_putAffinityInfo
@@ -99,6 +102,7 @@ likwid.sleep = sleep
 likwid.startPower = likwid_startPower
 likwid.stopPower = likwid_stopPower
 likwid.calcPower = likwid_printEnergy
+likwid.readPowerDomains = likwid_readPowerDomains
 likwid.getPowerLimit = likwid_powerLimitGet
 likwid.setPowerLimit = likwid_powerLimitSet
 likwid.statePowerLimit = likwid_powerLimitState
@@ -153,6 +157,10 @@ likwid.setCpuClockMax = likwid_setCpuClockMax
 likwid.getGovernor = likwid_getGovernor
 likwid.setGovernor = likwid_setGovernor
 likwid.getDriver = likwid_getDriver
+likwid.setFreqList = likwid_setFreqList
+likwid.initEffectiveClock = likwid_initEffectiveClock
+likwid.readEffectiveClock = likwid_readEffectiveClock
+likwid.finalizeEffectiveClock = likwid_finalizeEffectiveClock
 likwid.getuid = likwid_getuid
 likwid.geteuid = likwid_geteuid
 likwid.setuid = likwid_setuid
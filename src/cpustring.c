@@ -33,7 +33,10 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
+#include <limits.h>
 
+#include <types.h>
 #include <likwid.h>
 
 /* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
@@ -83,12 +86,33 @@ cpu_in_domain(int domainidx, int cpu)
 {
     affinity_init();
     AffinityDomains_t affinity = get_affinityDomains();
-    for (int i=0;i<affinity->domains[domainidx].numberOfProcessors; i++)
+    TopologyLookup_t lookup = get_topologyLookup();
+    if (lookup == NULL || lookup->hwthread2core == NULL)
     {
-        if (cpu == affinity->domains[domainidx].processorList[i])
+        for (int i=0;i<affinity->domains[domainidx].numberOfProcessors; i++)
         {
-            return 1;
+            if (cpu == affinity->domains[domainidx].processorList[i])
+            {
+                return 1;
+            }
         }
+        return 0;
+    }
+    if (cpu < 0 || cpu >= lookup->numberOfHWThreads)
+    {
+        return 0;
+    }
+    char* tag = bdata(affinity->domains[domainidx].tag);
+    switch (tag[0])
+    {
+        case 'N':
+            return (lookup->hwthread2core[cpu] >= 0);
+        case 'S':
+            return (lookup->hwthread2socket[cpu] == atoi(&tag[1]));
+        case 'C':
+            return (lookup->hwthread2cache[cpu] == atoi(&tag[1]));
+        case 'M':
+            return (lookup->hwthread2numa[cpu] == atoi(&tag[1]));
     }
     return 0;
 }
@@ -549,8 +573,275 @@ physical_done:
     return insert;
 }
 
+static const char* placement_names[MAX_PLACEMENT_POLICY] = {
+    [PLACEMENT_COMPACT_LLC] = "compact_llc",
+    [PLACEMENT_SPREAD_MEM] = "spread_mem",
+    [PLACEMENT_CORES_FIRST] = "cores_first",
+    [PLACEMENT_NUMA_BALANCED] = "numa_balanced",
+};
+
+static int
+placement_cores_first(TopologyLookup_t lookup, const int* cpus, int count, int* outcpus)
+{
+    int insert = 0;
+    int maxSmt = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (lookup->hwthread2smt[cpus[i]] >= maxSmt)
+        {
+            maxSmt = lookup->hwthread2smt[cpus[i]] + 1;
+        }
+    }
+    for (int smt = 0; smt < maxSmt; smt++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (lookup->hwthread2smt[cpus[i]] == smt)
+            {
+                outcpus[insert++] = cpus[i];
+            }
+        }
+    }
+    return insert;
+}
+
+/* Positive count of a placement expression or -1 for invalid counts */
+static int
+placement_count(const_bstring str)
+{
+    char* end = NULL;
+    long val;
+
+    if ((str == NULL) || (blength(str) == 0))
+    {
+        return -1;
+    }
+    val = strtol((const char*) str->data, &end, 10);
+    if ((*end != '\0') || (val <= 0) || (val > INT_MAX))
+    {
+        return -1;
+    }
+    return (int) val;
+}
+
+/* Distance between two M domains. The M domains and the distance lists
+ * follow the order of numa_info.nodes, the node IDs may be sparse. */
+static int
+placement_distance(int from, int to, int numDomains)
+{
+    if (numa_info.numberOfNodes != numDomains)
+    {
+        return abs(from - to);
+    }
+    if (numa_info.nodes[from].distances != NULL &&
+        to < numa_info.nodes[from].numberOfDistances)
+    {
+        return numa_info.nodes[from].distances[to];
+    }
+    return abs((int)numa_info.nodes[from].id - (int)numa_info.nodes[to].id);
+}
+
+static int
+placement_numa_balanced(TopologyLookup_t lookup, int* order, int ranks, int threads, int* cpulist, int length)
+{
+    int numDomains = lookup->numberOfNumaDomains;
+    int* cursor = (int*) calloc(numDomains, sizeof(int));
+    int total = lookup->numaOffsets[numDomains];
+    int used = 0;
+    int insert = 0;
+    if (!cursor)
+    {
+        return -ENOMEM;
+    }
+    for (int d = 0; d < numDomains; d++)
+    {
+        int first = lookup->numaOffsets[d];
+        placement_cores_first(lookup, &lookup->numaHWThreads[first],
+                              lookup->numaOffsets[d+1] - first, &order[first]);
+    }
+    for (int r = 0; r < ranks && insert < length; r++)
+    {
+        int home = (int)(((long)r * numDomains) / ranks);
+        for (int t = 0; t < threads && insert < length; t++)
+        {
+            int dom = -1;
+            if (used == total)
+            {
+                memset(cursor, 0, numDomains * sizeof(int));
+                used = 0;
+            }
+            for (int d = 0; d < numDomains; d++)
+            {
+                if (lookup->numaOffsets[d] + cursor[d] >= lookup->numaOffsets[d+1])
+                {
+                    continue;
+                }
+                if (dom < 0 || placement_distance(home, d, numDomains) < placement_distance(home, dom, numDomains))
+                {
+                    dom = d;
+                }
+            }
+            if (dom < 0)
+            {
+                /* No M domain has HW threads */
+                free(cursor);
+                return -ENODEV;
+            }
+            cpulist[insert++] = order[lookup->numaOffsets[dom] + cursor[dom]];
+            cursor[dom]++;
+            used++;
+        }
+    }
+    free(cursor);
+    return insert;
+}
+
+static int
+cpustr_to_cpulist_placement(bstring bcpustr, int* cpulist, int length)
+{
+    int policy = -1;
+    int ranks = 1;
+    int threads = 0;
+    struct bstrList* strlist;
+    struct bstrList* countlist;
+    if (bstrchrp(bcpustr, 'P', 0) != 0)
+    {
+        fprintf(stderr, "ERROR: Not a valid placement expression\n");
+        return 0;
+    }
+    strlist = bsplit(bcpustr, ':');
+    if (strlist->qty != 3)
+    {
+        fprintf(stderr, "ERROR: Invalid expression, should look like P:<policy>:<count> or P:<policy>:<ranks>x<threads>\n");
+        bstrListDestroy(strlist);
+        return 0;
+    }
+    for (int i = 0; i < MAX_PLACEMENT_POLICY; i++)
+    {
+        if (biseqcstr(strlist->entry[1], placement_names[i]))
+        {
+            policy = i;
+            break;
+        }
+    }
+    if (policy < 0)
+    {
+        fprintf(stderr, "ERROR: Unknown placement policy %s\n", bdata(strlist->entry[1]));
+        bstrListDestroy(strlist);
+        return 0;
+    }
+    countlist = bsplit(strlist->entry[2], 'x');
+    if (countlist->qty == 2)
+    {
+        ranks = placement_count(countlist->entry[0]);
+        threads = placement_count(countlist->entry[1]);
+    }
+    else
+    {
+        threads = placement_count(countlist->entry[0]);
+    }
+    bstrListDestroy(countlist);
+    bstrListDestroy(strlist);
+    return placement_to_cpulist(policy, ranks, threads, cpulist, length);
+}
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
+int
+placement_to_cpulist(PlacementPolicy policy, int ranks, int threads, int* cpulist, int length)
+{
+    int total = 0;
+    int count = 0;
+    int insert = 0;
+    int* order = NULL;
+    TopologyLookup_t lookup = NULL;
+    if (policy < 0 || policy >= MAX_PLACEMENT_POLICY || ranks <= 0 || threads <= 0)
+    {
+        return -EINVAL;
+    }
+    affinity_init();
+    lookup = get_topologyLookup();
+    if (lookup == NULL || lookup->hwthread2core == NULL)
+    {
+        return -EFAULT;
+    }
+    count = MIN(ranks * threads, length);
+    total = MAX(lookup->coreOffsets[lookup->numberOfCores], lookup->numaOffsets[lookup->numberOfNumaDomains]);
+    total = MAX(total, lookup->cacheOffsets[lookup->numberOfCacheDomains]);
+    if (total == 0)
+    {
+        return 0;
+    }
+    order = (int*) malloc(2 * total * sizeof(int));
+    if (!order)
+    {
+        return -ENOMEM;
+    }
+    switch (policy)
+    {
+        case PLACEMENT_COMPACT_LLC:
+            total = 0;
+            for (int c = 0; c < lookup->numberOfCacheDomains; c++)
+            {
+                int first = lookup->cacheOffsets[c];
+                total += placement_cores_first(lookup, &lookup->cacheHWThreads[first],
+                                               lookup->cacheOffsets[c+1] - first, &order[total]);
+            }
+            break;
+        case PLACEMENT_SPREAD_MEM:
+            /* cores first order of each NUMA domain in the upper half of
+             * the buffer, then take one HW thread per domain in turn */
+            for (int d = 0; d < lookup->numberOfNumaDomains; d++)
+            {
+                int first = lookup->numaOffsets[d];
+                placement_cores_first(lookup, &lookup->numaHWThreads[first],
+                                      lookup->numaOffsets[d+1] - first, &order[total + first]);
+            }
+            insert = total;
+            total = 0;
+            for (int i = 0; total < lookup->numaOffsets[lookup->numberOfNumaDomains]; i++)
+            {
+                for (int d = 0; d < lookup->numberOfNumaDomains; d++)
+                {
+                    if (lookup->numaOffsets[d] + i < lookup->numaOffsets[d+1])
+                    {
+                        order[total++] = order[insert + lookup->numaOffsets[d] + i];
+                    }
+                }
+            }
+            break;
+        case PLACEMENT_CORES_FIRST:
+            total = placement_cores_first(lookup, lookup->coreHWThreads,
+                                          lookup->coreOffsets[lookup->numberOfCores], order);
+            break;
+        case PLACEMENT_NUMA_BALANCED:
+            insert = placement_numa_balanced(lookup, order, ranks, threads, cpulist, length);
+            free(order);
+            return insert;
+        default:
+            free(order);
+            return -EINVAL;
+    }
+    if (total == 0)
+    {
+        free(order);
+        return 0;
+    }
+    if (count > total && getenv("LIKWID_SILENT") == NULL)
+    {
+        fprintf(stderr,
+                "WARN: Placement policy %s has only %d hardware threads, but %d threads are requested.\n",
+                placement_names[policy], total, count);
+        fprintf(stderr, "      This results in multiple threads on the same hardware thread.\n");
+    }
+    for (insert = 0; insert < count; insert++)
+    {
+        cpulist[insert] = order[insert % total];
+    }
+    free(order);
+    return insert;
+}
+
 int
 cpustr_to_cpulist(const char* cpustring, int* cpulist, int length)
 {
@@ -579,6 +870,11 @@ cpustr_to_cpulist(const char* cpustring, int* cpulist, int length)
             ret = cpustr_to_cpulist_scatter(strlist->entry[i], tmpList, length);
             insert += cpulist_concat(cpulist, insert, tmpList, ret);
         }
+        else if (bstrchrp(strlist->entry[i], 'P', 0) == 0)
+        {
+            ret = cpustr_to_cpulist_placement(strlist->entry[i], tmpList, length);
+            insert += cpulist_concat(cpulist, insert, tmpList, ret);
+        }
         else if (bstrchrp(strlist->entry[i], 'E', 0) == 0)
         {
             ret = cpustr_to_cpulist_expression(strlist->entry[i], tmpList, length);
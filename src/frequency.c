@@ -38,9 +38,15 @@
 #include <errno.h>
 #include <string.h>
 
+#include <types.h>
 #include <bstrlib.h>
 #include <likwid.h>
 #include <error.h>
+#include <registers.h>
+#include <access.h>
+#if defined(__x86_64) || defined(__i386__)
+#include <cpuid.h>
+#endif
 
 #include <frequency.h>
 
@@ -80,40 +86,10 @@ uint64_t freq_getCpuClockCurrent(const int cpu_id )
 
 uint64_t freq_setCpuClockCurrent(const int cpu_id, const uint64_t freq)
 {
-    FILE *fpipe = NULL;
-    char cmd[256];
-    char buff[256];
-    uint64_t cur = 0x0ULL;
-    char* drv = freq_getDriver(cpu_id);
-    if (strcmp(drv, "intel_pstate") == 0)
-    {
-        fprintf(stderr, "CPUfreq driver intel_pstate not supported\n");
-        free(drv);
-        return 0x0ULL;
-    }
-    free(drv);
-    cur = freq_getCpuClockCurrent(cpu_id);
-    if (cur == freq)
-    {
-        return cur;
-    }
-
-    sprintf(buff, "%s", daemon_path);
-    if (access(buff, X_OK))
+    if (freq_setList(1, &cpu_id, 0, 0, freq, NULL) < 0)
     {
-        fprintf(stderr, "Daemon %s not executable", buff);
-        return 0;
-    }
-
-    sprintf(cmd, "%s %d cur %lu", daemon_path, cpu_id, freq);
-    if ( !(fpipe = (FILE*)popen(cmd,"r")) )
-    {  // If fpipe is NULL
-        fprintf(stderr, "Problems setting cpu frequency of CPU %d", cpu_id);
         return 0;
     }
-    if (pclose(fpipe))
-        return 0;
-
     return freq;
 }
 
@@ -142,40 +118,10 @@ uint64_t freq_getCpuClockMax(const int cpu_id )
 
 uint64_t freq_setCpuClockMax(const int cpu_id, const uint64_t freq)
 {
-    FILE *fpipe = NULL;
-    char cmd[256];
-    char buff[256];
-    uint64_t cur = 0x0ULL;
-    char* drv = freq_getDriver(cpu_id);
-    if (strcmp(drv, "intel_pstate") == 0)
-    {
-        fprintf(stderr, "CPUfreq driver intel_pstate not supported\n");
-        free(drv);
-        return 0x0ULL;
-    }
-    free(drv);
-    cur = freq_getCpuClockMax(cpu_id);
-    if (cur == freq)
+    if (freq_setList(1, &cpu_id, 0, freq, 0, NULL) < 0)
     {
-        return cur;
-    }
-
-    sprintf(buff, "%s", daemon_path);
-    if (access(buff, X_OK))
-    {
-        fprintf(stderr, "Daemon %s not executable", buff);
         return 0;
     }
-
-    sprintf(cmd, "%s %d max %lu", daemon_path, cpu_id, freq);
-    if ( !(fpipe = (FILE*)popen(cmd,"r")) )
-    {  // If fpipe is NULL
-        fprintf(stderr, "Problems setting cpu frequency of CPU %d", cpu_id);
-        return 0;
-    }
-    if (pclose(fpipe))
-        return 0;
-
     return freq;
 }
 
@@ -205,40 +151,10 @@ uint64_t freq_getCpuClockMin(const int cpu_id )
 
 uint64_t freq_setCpuClockMin(const int cpu_id, const uint64_t freq)
 {
-    FILE *fpipe = NULL;
-    char cmd[256];
-    char buff[256];
-    uint64_t cur = 0x0ULL;
-    char* drv = freq_getDriver(cpu_id);
-    if (strcmp(drv, "intel_pstate") == 0)
+    if (freq_setList(1, &cpu_id, freq, 0, 0, NULL) < 0)
     {
-        fprintf(stderr, "CPUfreq driver intel_pstate not supported\n");
-        free(drv);
-        return 0x0ULL;
-    }
-    free(drv);
-    cur = freq_getCpuClockMin(cpu_id);
-    if (cur == freq)
-    {
-        return cur;
-    }
-
-    sprintf(buff, "%s", daemon_path);
-    if (access(buff, X_OK))
-    {
-        fprintf(stderr, "Daemon %s not executable", buff);
-        return 0;
-    }
-
-    sprintf(cmd, "%s %d min %lu", daemon_path, cpu_id, freq);
-    if ( !(fpipe = (FILE*)popen(cmd,"r")) )
-    {  // If fpipe is NULL
-        fprintf(stderr, "Problems setting cpu frequency of CPU %d", cpu_id);
         return 0;
     }
-    if (pclose(fpipe))
-        return 0;
-
     return freq;
 }
 
@@ -275,32 +191,10 @@ char * freq_getGovernor(const int cpu_id )
 
 int freq_setGovernor(const int cpu_id, const char* gov)
 {
-    FILE *fpipe = NULL;
-    char cmd[256];
-    char buff[256];
-    char* drv = freq_getDriver(cpu_id);
-    if (strcmp(drv, "intel_pstate") == 0)
-    {
-        fprintf(stderr, "CPUfreq driver intel_pstate not supported\n");
-        free(drv);
-        return 0;
-    }
-    free(drv);
-    sprintf(buff, "%s", daemon_path);
-    if (access(buff, X_OK))
+    if (freq_setList(1, &cpu_id, 0, 0, 0, gov) < 0)
     {
-        fprintf(stderr, "Daemon %s not executable", buff);
         return 0;
     }
-
-    sprintf(cmd, "%s %d gov %s", daemon_path, cpu_id, gov);
-    if ( !(fpipe = (FILE*)popen(cmd,"r")) )
-    {  // If fpipe is NULL
-        fprintf(stderr, "Problems setting cpu frequency of CPU %d", cpu_id);
-        return 0;
-    }
-    if (pclose(fpipe))
-        return 0;
     return 1;
 }
 
@@ -436,3 +330,242 @@ char * freq_getDriver(const int cpu_id )
     fclose(f);
     return eptr;
 }
+
+int
+freq_setList(const int num_cpus, const int* cpus, const uint64_t min, const uint64_t max, const uint64_t cur, const char* gov)
+{
+    int i = 0;
+    int start = 0;
+    int err = 0;
+    FILE *fpipe = NULL;
+    char* drv = NULL;
+    bstring cmd = NULL;
+
+    if ((num_cpus <= 0) || (cpus == NULL))
+    {
+        return -EINVAL;
+    }
+    if ((min == 0) && (max == 0) && (cur == 0) && (gov == NULL))
+    {
+        return 0;
+    }
+    drv = freq_getDriver(cpus[0]);
+    if (drv == NULL)
+    {
+        return -ENODEV;
+    }
+    if (strcmp(drv, "intel_pstate") == 0)
+    {
+        fprintf(stderr, "CPUfreq driver intel_pstate not supported\n");
+        free(drv);
+        return -EPERM;
+    }
+    free(drv);
+    if (access(daemon_path, X_OK))
+    {
+        fprintf(stderr, "Daemon %s not executable\n", daemon_path);
+        return -EACCES;
+    }
+
+    /* The daemon gets all CPUs and settings at once, consecutive CPUs are
+     * compressed to ranges to keep the command line short on large nodes.
+     */
+    cmd = bformat("%s ", daemon_path);
+    for (i = 1; i <= num_cpus; i++)
+    {
+        if ((i < num_cpus) && (cpus[i] == cpus[i-1] + 1))
+        {
+            continue;
+        }
+        if (start > 0)
+        {
+            bconchar(cmd, ',');
+        }
+        if (i - 1 > start)
+        {
+            bformata(cmd, "%d-%d", cpus[start], cpus[i-1]);
+        }
+        else
+        {
+            bformata(cmd, "%d", cpus[start]);
+        }
+        start = i;
+    }
+    if (min > 0)
+        bformata(cmd, " min %lu", min);
+    if (max > 0)
+        bformata(cmd, " max %lu", max);
+    if (cur > 0)
+        bformata(cmd, " cur %lu", cur);
+    if (gov != NULL)
+        bformata(cmd, " gov %s", gov);
+    DEBUG_PRINT(DEBUGLEV_DETAIL, Executing %s, bdata(cmd));
+
+    if ( !(fpipe = (FILE*)popen(bdata(cmd),"r")) )
+    {  // If fpipe is NULL
+        fprintf(stderr, "Problems setting cpu frequency of %d CPUs\n", num_cpus);
+        bdestroy(cmd);
+        return -EIO;
+    }
+    if (pclose(fpipe))
+        err = -EIO;
+    bdestroy(cmd);
+    return err;
+}
+
+int
+freq_setCpuClockCurrentList(const int num_cpus, const int* cpus, const uint64_t freq)
+{
+    return freq_setList(num_cpus, cpus, 0, 0, freq, NULL);
+}
+
+int
+freq_setCpuClockMaxList(const int num_cpus, const int* cpus, const uint64_t freq)
+{
+    return freq_setList(num_cpus, cpus, 0, freq, 0, NULL);
+}
+
+int
+freq_setCpuClockMinList(const int num_cpus, const int* cpus, const uint64_t freq)
+{
+    return freq_setList(num_cpus, cpus, freq, 0, 0, NULL);
+}
+
+int
+freq_setGovernorList(const int num_cpus, const int* cpus, const char* gov)
+{
+    return freq_setList(num_cpus, cpus, 0, 0, 0, gov);
+}
+
+int
+freq_initSampler(const int num_cpus, const int* cpus)
+{
+    int i = 0;
+    int ret = 0;
+    uint64_t tmp = 0x0ULL;
+
+    if ((num_cpus <= 0) || (cpus == NULL))
+    {
+        return -EINVAL;
+    }
+#if defined(__x86_64) || defined(__i386__)
+    {
+        /* MPERF and TSC only tick with the same rate if the TSC is
+         * invariant (CPUID 0x80000007 EDX bit 8), older AMD CPUs count
+         * MPERF with the P0 clock and the TSC with the boot clock */
+        uint32_t eax = 0x80000000, ebx = 0x0, ecx = 0x0, edx = 0x0;
+        CPUID(eax, ebx, ecx, edx);
+        if (eax < 0x80000007)
+        {
+            return -ENODEV;
+        }
+        eax = 0x80000007; ebx = 0x0; ecx = 0x0; edx = 0x0;
+        CPUID(eax, ebx, ecx, edx);
+        if (!(edx & (1U << 8)))
+        {
+            return -ENODEV;
+        }
+    }
+#endif
+    timer_init();
+    HPMinit();
+    for (i = 0; i < num_cpus; i++)
+    {
+        ret = HPMaddThread(cpus[i]);
+        if (ret < 0)
+        {
+            fprintf(stderr, "Cannot initialize access to registers on CPU %d\n", cpus[i]);
+            return ret;
+        }
+        ret = HPMread(cpus[i], MSR_DEV, MSR_APERF, &tmp);
+        if (ret < 0)
+        {
+            fprintf(stderr, "Cannot read APERF/MPERF registers on CPU %d\n", cpus[i]);
+            return -ENODEV;
+        }
+    }
+    return 0;
+}
+
+int
+freq_readSamples(const int num_cpus, const int* cpus, FreqSample* samples)
+{
+    int i = 0;
+    int ret = 0;
+    uint64_t tscEnd = 0x0ULL;
+
+    if ((num_cpus <= 0) || (cpus == NULL) || (samples == NULL))
+    {
+        return -EINVAL;
+    }
+    /* Every HPMread may be a round trip to the access daemon. The TSC is
+     * read before and after MPERF and APERF and the midpoint is used, so
+     * all three values of a HW thread refer to the same point in time.
+     * MPERF and APERF are read in the same order for every sample, so
+     * the gap between them cancels out in the differences. */
+    for (i = 0; i < num_cpus; i++)
+    {
+        samples[i].cpu_id = cpus[i];
+        ret = HPMread(cpus[i], MSR_DEV, MSR_TIME_STAMP_COUNTER, &samples[i].tsc);
+        if (ret == 0)
+        {
+            ret = HPMread(cpus[i], MSR_DEV, MSR_MPERF, &samples[i].mperf);
+        }
+        if (ret == 0)
+        {
+            ret = HPMread(cpus[i], MSR_DEV, MSR_APERF, &samples[i].aperf);
+        }
+        if (ret == 0)
+        {
+            ret = HPMread(cpus[i], MSR_DEV, MSR_TIME_STAMP_COUNTER, &tscEnd);
+            samples[i].tsc += (tscEnd - samples[i].tsc) / 2;
+        }
+        if (ret < 0)
+        {
+            DEBUG_PRINT(DEBUGLEV_DETAIL, Reading clock counters of CPU %d failed, cpus[i]);
+            return ret;
+        }
+    }
+    return num_cpus;
+}
+
+double
+freq_getEffectiveClock(const FreqSample* before, const FreqSample* after)
+{
+    uint64_t aperf = 0x0ULL;
+    uint64_t mperf = 0x0ULL;
+
+    if ((before == NULL) || (after == NULL) || (before->cpu_id != after->cpu_id))
+    {
+        return 0.0;
+    }
+    aperf = after->aperf - before->aperf;
+    mperf = after->mperf - before->mperf;
+    if (mperf == 0)
+    {
+        return 0.0;
+    }
+    /* MPERF ticks with the invariant TSC clock while the HW thread is in C0 */
+    return ((double)aperf/(double)mperf) * (double)timer_getCpuClock();
+}
+
+double
+freq_getC0Residency(const FreqSample* before, const FreqSample* after)
+{
+    uint64_t mperf = 0x0ULL;
+    uint64_t tsc = 0x0ULL;
+    double res = 0.0;
+
+    if ((before == NULL) || (after == NULL) || (before->cpu_id != after->cpu_id))
+    {
+        return 0.0;
+    }
+    mperf = after->mperf - before->mperf;
+    tsc = after->tsc - before->tsc;
+    if (tsc == 0)
+    {
+        return 0.0;
+    }
+    res = (double)mperf/(double)tsc;
+    return (res > 1.0 ? 1.0 : res);
+}
@@ -32,9 +32,11 @@
 /* #####   HEADER FILE INCLUDES   ######################################### */
 
 #include <stdlib.h>
+#include <errno.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 #include <pthread.h>
 
 #include <ghash.h>
@@ -42,6 +44,7 @@
 #include <types.h>
 #include <hashTable.h>
 #include <likwid.h>
+#include <topology.h>
 
 /* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
 
@@ -52,22 +55,41 @@ typedef struct {
     GHashTable* hashTable;
 } ThreadList;
 
-static ThreadList* threadList[MAX_NUM_THREADS];
+static ThreadList** threadList = NULL;
+static int numThreadList = 0;
 
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 void
 hashTable_init()
 {
-    for (int i=0; i<MAX_NUM_THREADS; i++)
+    /* Indexed by OS CPU id, numHWThreads only counts the CPUs of the cpuset */
+    int numCpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (numCpus < (int)cpuid_topology.numHWThreads)
     {
-        threadList[i] = NULL;
+        numCpus = cpuid_topology.numHWThreads;
     }
+    if (threadList != NULL)
+    {
+        return;
+    }
+    threadList = (ThreadList**) calloc(numCpus, sizeof(ThreadList*));
+    if (threadList == NULL)
+    {
+        fprintf(stderr, "Failed to allocate %lu bytes for the thread list\n",
+                numCpus * sizeof(ThreadList*));
+        return;
+    }
+    numThreadList = numCpus;
 }
 
 void
 hashTable_initThread(int coreID)
 {
+    if ((coreID < 0) || (coreID >= numThreadList))
+    {
+        return;
+    }
     ThreadList* resPtr = threadList[coreID];
     /* check if thread was already initialized */
     if (resPtr == NULL)
@@ -86,6 +108,11 @@ int
 hashTable_get(bstring label, LikwidThreadResults** resEntry)
 {
     int coreID = likwid_getProcessorId();
+    if ((coreID < 0) || (coreID >= numThreadList))
+    {
+        (*resEntry) = NULL;
+        return -EINVAL;
+    }
     ThreadList* resPtr = threadList[coreID];
 
     /* check if thread was already initialized */
@@ -135,7 +162,7 @@ hashTable_finalize(int* numThreads, int* numRegions, LikwidResults** results)
 
     regionLookup = g_hash_table_new(g_str_hash, g_str_equal);
     /* determine number of active threads */
-    for (int i=0; i<MAX_NUM_THREADS; i++)
+    for (int i=0; i<numThreadList; i++)
     {
         if (threadList[i] != NULL)
         {
@@ -215,7 +242,7 @@ hashTable_finalize(int* numThreads, int* numRegions, LikwidResults** results)
 
     uint32_t regionIds[numberOfRegions];
 
-    for (int core=0; core<MAX_NUM_THREADS; core++)
+    for (int core=0; core<numThreadList; core++)
     {
         ThreadList* resPtr = threadList[core];
 
@@ -269,7 +296,7 @@ hashTable_finalize(int* numThreads, int* numRegions, LikwidResults** results)
 
 void __attribute__((destructor (102))) hashTable_finalizeDestruct(void)
 {
-    for (int core=0; core<MAX_NUM_THREADS; core++)
+    for (int core=0; core<numThreadList; core++)
     {
         ThreadList* resPtr = threadList[core];
         if (resPtr != NULL)
@@ -279,5 +306,8 @@ void __attribute__((destructor (102))) hashTable_finalizeDestruct(void)
             threadList[core] = NULL;
         }
     }
+    free(threadList);
+    threadList = NULL;
+    numThreadList = 0;
 }
 
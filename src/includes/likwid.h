@@ -507,8 +507,9 @@ extern void numa_setInterleaved(const int* processorList, int numberOfProcessors
 @param [in,out] ptr Start pointer of memory
 @param [in] size Size for the allocation
 @param [in] domainId ID of NUMA node for the allocation
+@return 0 for success and negative error code otherwise
 */
-extern void numa_membind(void* ptr, size_t size, int domainId) __attribute__ ((visibility ("default") ));
+extern int numa_membind(void* ptr, size_t size, int domainId) __attribute__ ((visibility ("default") ));
 /*! \brief Destroy NUMA information structure
 
 Destroys the NUMA information structure NumaTopology_t. Retrieved pointers
@@ -524,6 +525,31 @@ NumaTopology_t
 @return Number of NUMA nodes
 */
 extern int likwid_getNumberOfNodes(void) __attribute__ ((visibility ("default") ));
+/*! \brief Determine the NUMA node placement of a buffer
+
+Counts the pages of the buffer per NUMA node using move_pages(2) without moving
+any page. The \a counts array must have numberOfNodes entries of NumaTopology_t.
+Pages that are not yet backed by memory (not touched) are not counted. For large
+buffers only a sample of evenly spaced pages is inspected and the counts are
+extrapolated to the whole buffer.
+\sa NumaTopology_t
+@param [in] ptr Start address of the buffer
+@param [in] size Size of the buffer in bytes
+@param [out] counts Number of pages per NUMA node
+@return Number of pages of the buffer or -ERRORCODE on failure
+*/
+extern int numa_getPagePlacement(void* ptr, size_t size, uint64_t* counts) __attribute__ ((visibility ("default") ));
+/*! \brief Determine the NUMA node placement of a buffer in another process
+
+Same as numa_getPagePlacement() but for a buffer in the address space of the
+process \a pid. Requires the permissions to access the process.
+@param [in] pid Process ID (0 for the calling process)
+@param [in] ptr Start address of the buffer in the process
+@param [in] size Size of the buffer in bytes
+@param [out] counts Number of pages per NUMA node
+@return Number of pages of the buffer or -ERRORCODE on failure
+*/
+extern int numa_getProcessPagePlacement(int pid, void* ptr, size_t size, uint64_t* counts) __attribute__ ((visibility ("default") ));
 /** @}*/
 /*
 ################################################################################
@@ -569,6 +595,41 @@ typedef struct {
 /** \brief Pointer for exporting the AffinityDomains data structure */
 typedef AffinityDomains* AffinityDomains_t;
 
+/*! \brief The TopologyLookup data structure holds flat lookup tables between HW threads
+and the CPU cores, sockets, LLC cache domains and NUMA domains containing them
+
+The tables are indexed by the HW thread ID and contain -1 for HW threads that are
+not part of the affinity domains. For each domain kind the inverse mapping is stored
+in compressed form: the HW threads of entry \a i are
+\a xxxHWThreads[xxxOffsets[i]] ... \a xxxHWThreads[xxxOffsets[i+1]-1] in the same
+order as in the processor list of the corresponding affinity domain. The HW threads of
+a CPU core are ordered by their SMT index.
+\extends AffinityDomains
+*/
+typedef struct {
+    uint32_t numberOfHWThreads; /*!< \brief Length of the per HW thread arrays (highest HW thread ID + 1) */
+    uint32_t numberOfCores; /*!< \brief Number of CPU cores in the affinity domains */
+    uint32_t numberOfSockets; /*!< \brief Number of CPU sockets/packages (same as the socket affinity domains) */
+    uint32_t numberOfCacheDomains; /*!< \brief Number of LLC cache domains (same as the cache affinity domains) */
+    uint32_t numberOfNumaDomains; /*!< \brief Number of NUMA domains (same as the memory affinity domains) */
+    int* hwthread2core; /*!< \brief CPU core index of each HW thread */
+    int* hwthread2socket; /*!< \brief Socket index of each HW thread */
+    int* hwthread2cache; /*!< \brief LLC cache domain index of each HW thread */
+    int* hwthread2numa; /*!< \brief NUMA domain index of each HW thread */
+    int* hwthread2smt; /*!< \brief Index of each HW thread among the HW threads of its CPU core */
+    int* coreOffsets; /*!< \brief Offsets into \a coreHWThreads, length \a numberOfCores + 1 */
+    int* coreHWThreads; /*!< \brief HW threads grouped by CPU core */
+    int* socketOffsets; /*!< \brief Offsets into \a socketHWThreads, length \a numberOfSockets + 1 */
+    int* socketHWThreads; /*!< \brief HW threads grouped by socket */
+    int* cacheOffsets; /*!< \brief Offsets into \a cacheHWThreads, length \a numberOfCacheDomains + 1 */
+    int* cacheHWThreads; /*!< \brief HW threads grouped by LLC cache domain */
+    int* numaOffsets; /*!< \brief Offsets into \a numaHWThreads, length \a numberOfNumaDomains + 1 */
+    int* numaHWThreads; /*!< \brief HW threads grouped by NUMA domain */
+} TopologyLookup;
+
+/** \brief Pointer for exporting the TopologyLookup data structure */
+typedef TopologyLookup* TopologyLookup_t;
+
 /*! \brief Initialize affinity information
 
 Initialize affinity information AffinityDomains_t using the data of the structures
@@ -583,6 +644,15 @@ Get the previously initialized affinity info structure
 @return AffinityDomains_t (pointer to internal affinityDomains structure)
 */
 extern AffinityDomains_t get_affinityDomains(void) __attribute__ ((visibility ("default") ));
+/*! \brief Retrieve the flat topology lookup tables
+
+Get the lookup tables between HW threads and cores, sockets, LLC cache domains
+and NUMA domains. They are created by affinity_init() and destroyed by
+affinity_finalize().
+\sa TopologyLookup_t
+@return TopologyLookup_t (pointer to internal lookup structure) or NULL if affinity_init() was not called
+*/
+extern TopologyLookup_t get_topologyLookup(void) __attribute__ ((visibility ("default") ));
 /*! \brief Pin process to a CPU
 
 Pin process to a CPU. Duplicate of likwid_pinProcess()
@@ -630,17 +700,45 @@ extern void affinity_finalize() __attribute__ ((visibility ("default") ));
  *  @{
  */
 
+/*! \brief Enum of the placement policies
+
+The placement policies distribute threads or ranks of threads over the HW threads of
+the node according to the cache, NUMA and SMT layout. They are available through
+placement_to_cpulist() and the CPU selection string <CODE>P:&lt;policy&gt;:&lt;count&gt;</CODE>
+or <CODE>P:&lt;policy&gt;:&lt;ranks&gt;x&lt;threads&gt;</CODE>.
+*/
+typedef enum {
+    PLACEMENT_COMPACT_LLC = 0, /*!< \brief Fill one LLC cache domain after the other, physical cores first (compact_llc) */
+    PLACEMENT_SPREAD_MEM, /*!< \brief Round-robin over the NUMA domains/memory controllers, physical cores first (spread_mem) */
+    PLACEMENT_CORES_FIRST, /*!< \brief One HW thread per CPU core of the node, then the SMT siblings (cores_first) */
+    PLACEMENT_NUMA_BALANCED, /*!< \brief Ranks evenly over the NUMA domains, the threads of a rank in its domain or the nearest ones (numa_balanced) */
+    MAX_PLACEMENT_POLICY
+} PlacementPolicy;
+
 /*! \brief Read CPU selection string and resolve to available CPU numbers
 
 Reads the CPU selection string and fills the given list with the CPU numbers
 defined in the selection string. This function is a interface function for the
-different selection modes: scatter, expression, logical and physical.
+different selection modes: scatter, expression, logical, placement and physical.
 @param [in] cpustring Selection string
 @param [in,out] cpulist List of CPUs
 @param [in] length Length of cpulist
 @return error code (>0 on success for the returned list length, -ERRORCODE on failure)
 */
 extern int cpustr_to_cpulist(const char* cpustring, int* cpulist, int length)  __attribute__ ((visibility ("default") ));
+/*! \brief Resolve a placement policy to a CPU list
+
+Fills the given list with \a ranks * \a threads CPU IDs selected by the placement
+policy. The threads of a rank are stored consecutively. If more threads are requested
+than HW threads are available, the selection starts over.
+@param [in] policy Placement policy
+@param [in] ranks Number of ranks (processes)
+@param [in] threads Number of threads per rank
+@param [in,out] cpulist List of CPUs
+@param [in] length Length of cpulist
+@return error code (>0 on success for the returned list length, -ERRORCODE on failure)
+*/
+extern int placement_to_cpulist(PlacementPolicy policy, int ranks, int threads, int* cpulist, int length)  __attribute__ ((visibility ("default") ));
 /*! \brief Read NUMA node selection string and resolve to available NUMA node numbers
 
 Reads the NUMA node selection string and fills the given list with the NUMA node numbers
@@ -782,6 +880,76 @@ code. Before returning, the counters are started again. Only one thread's CPU is
 @return 0 on success and -(thread_id+1) for error
 */
 extern int perfmon_readGroupThreadCounters(int groupId, int threadId) __attribute__ ((visibility ("default") ));
+/*! \brief Start the overflow guard thread
+
+Some counter registers like the RAPL energy registers are only 32 bit wide and
+have no hardware overflow flag. If they wrap more than once between two reads,
+the overflow is lost. The overflow guard reads these registers in the background
+at a low rate derived from the register width and the maximal expected increment
+rate, so that perfmon_startCounters() and perfmon_stopCounters() can be used for
+long running measurements. If no registers are at risk, no thread is started.
+@return 0 on success, -ERRORCODE on failure
+*/
+extern int perfmon_startOverflowGuard(void) __attribute__ ((visibility ("default") ));
+/*! \brief Stop the overflow guard thread
+
+@return 0 on success
+*/
+extern int perfmon_stopOverflowGuard(void) __attribute__ ((visibility ("default") ));
+/*! \brief Get the read interval of the overflow guard thread
+
+@return Interval in seconds or 0 if the overflow guard is not running
+*/
+extern double perfmon_getOverflowGuardPeriod(void) __attribute__ ((visibility ("default") ));
+/*! \brief Snapshot of the raw counter values of an event group
+
+A snapshot stores the raw counter values of all events and threads of a group
+together with the accumulated overflows and the TSC at capture time. The values
+are stored densely with index event * numberOfThreads + thread. Two snapshots
+of the same group and measurement run can be subtracted with perfmon_diffSnapshots()
+to get the results of arbitrary, also overlapping, intervals without changing
+the state used by perfmon_readCounters() or the Marker API.
+*/
+typedef struct {
+    int groupId; /*!< \brief ID of the group the snapshot was taken of */
+    int numberOfEvents; /*!< \brief Number of events in the group */
+    int numberOfThreads; /*!< \brief Number of threads in the group */
+    uint64_t startCount; /*!< \brief Measurement run of the group the snapshot belongs to */
+    uint64_t tsc; /*!< \brief Time stamp counter at capture time */
+    uint64_t* values; /*!< \brief Raw counter values, numberOfEvents * numberOfThreads entries */
+    uint64_t* overflows; /*!< \brief Overflows since the counters were started, numberOfEvents * numberOfThreads entries */
+} PerfmonSnapshot;
+
+/** \brief Pointer for exporting the PerfmonSnapshot data structure */
+typedef PerfmonSnapshot* perfmon_snapshot_t;
+
+/*! \brief Capture a snapshot of the counters of a running group
+
+Reads the counters of all threads in the group and stores the raw values in a
+newly allocated snapshot. The intervals of perfmon_readCounters() are not changed.
+The snapshot must be freed with perfmon_freeSnapshot().
+@param [in] groupId ID of the group or -1 for the active group
+@param [out] snapshot Pointer to the new snapshot
+@return 0 on success, -ERRORCODE on failure
+*/
+extern int perfmon_captureSnapshot(int groupId, perfmon_snapshot_t* snapshot) __attribute__ ((visibility ("default") ));
+/*! \brief Calculate the results between two snapshots
+
+Calculates the event results between the snapshots \a start and \a stop taking
+overflows and multipliers into account. Both snapshots must belong to the same
+group and measurement run.
+@param [in] start Snapshot at the beginning of the interval
+@param [in] stop Snapshot at the end of the interval
+@param [out] results Array with numberOfEvents * numberOfThreads entries for the results (index event * numberOfThreads + thread)
+@param [out] time Interval time in seconds (can be NULL)
+@return Number of results on success, -ERRORCODE on failure
+*/
+extern int perfmon_diffSnapshots(perfmon_snapshot_t start, perfmon_snapshot_t stop, double* results, double* time) __attribute__ ((visibility ("default") ));
+/*! \brief Free a snapshot
+
+@param [in] snapshot Snapshot returned by perfmon_captureSnapshot()
+*/
+extern void perfmon_freeSnapshot(perfmon_snapshot_t snapshot) __attribute__ ((visibility ("default") ));
 /*! \brief Switch the active eventSet to a new one
 
 Stops the currently running counters, switches the eventSet by setting up the
@@ -1108,7 +1276,7 @@ extern void timer_finalize(void) __attribute__ ((visibility ("default") ));
 \def NUM_POWER_DOMAINS
 Amount of currently supported RAPL domains
 */
-#define NUM_POWER_DOMAINS 4
+#define NUM_POWER_DOMAINS 5
 /*! \brief List of all RAPL domain names
 */
 extern const char* power_names[NUM_POWER_DOMAINS] __attribute__ ((visibility ("default") ));
@@ -1155,7 +1323,8 @@ typedef enum {
     PKG = 0, /*!< \brief PKG domain, mostly one CPU socket/package */
     PP0 = 1, /*!< \brief PP0 domain, not clearly defined by Intel */
     PP1 = 2, /*!< \brief PP1 domain, not clearly defined by Intel */
-    DRAM = 3 /*!< \brief DRAM domain, the memory modules */
+    DRAM = 3, /*!< \brief DRAM domain, the memory modules */
+    PLATFORM = 4 /*!< \brief PLATFORM domain, the whole system on chip (PSys) */
 } PowerType;
 
 /*! \brief Structure describing an RAPL power domain
@@ -1231,6 +1400,16 @@ extern int power_read(int cpuId, uint64_t reg, uint32_t *data) __attribute__ ((v
 @param [out] data Energy data
 */
 extern int power_tread(int socket_fd, int cpuId, uint64_t reg, uint32_t *data) __attribute__ ((visibility ("default") ));
+/*! \brief Read the current energy values of all RAPL domains
+
+Read the energy registers of all supported RAPL domains back-to-back. Entries of
+unsupported domains are set to 0. The energy between two readings is calculated
+with power_printEnergy(), which handles a single wraparound of the 32 bit counters.
+@param [in] cpuId Read energy facility for this CPU
+@param [out] data Array with NUM_POWER_DOMAINS entries for the energy data
+@return Number of read domains or negative value for errors
+*/
+extern int power_readDomains(int cpuId, uint32_t *data) __attribute__ ((visibility ("default") ));
 /*! \brief Start energy measurements
 
 @param [in,out] data Data structure holding start and stop values for energy measurements
@@ -1518,6 +1697,109 @@ Get the name of the currently active cpufreq driver. The returned string must be
 @return String with active cpufreq driver or NULL in case of errors
 */
 extern char * freq_getDriver(const int cpu_id ) __attribute__ ((visibility ("default") ));
+/*! \brief Set frequencies and governor of multiple cores at once
+
+Set the minimal, maximal and current frequency and the governor of all given
+cores with a single call of the frequency daemon. Settings with value 0 (or NULL
+for the governor) are left unchanged. Minimal and maximal frequency are applied
+first, then the current frequency and finally the governor.
+@param [in] num_cpus Number of CPUs
+@param [in] cpus List of CPU IDs
+@param [in] min Minimal frequency in kHz or 0
+@param [in] max Maximal frequency in kHz or 0
+@param [in] cur Current frequency in kHz or 0
+@param [in] gov Governor or NULL
+@return 0 for success, negative value in case of errors
+*/
+extern int freq_setList(const int num_cpus, const int* cpus, const uint64_t min, const uint64_t max, const uint64_t cur, const char* gov) __attribute__ ((visibility ("default") ));
+/*! \brief Set the current clock frequency of multiple cores
+
+Set the current clock frequency of multiple cores
+@param [in] num_cpus Number of CPUs
+@param [in] cpus List of CPU IDs
+@param [in] freq Frequency in kHz
+@return 0 for success, negative value in case of errors
+*/
+extern int freq_setCpuClockCurrentList(const int num_cpus, const int* cpus, const uint64_t freq) __attribute__ ((visibility ("default") ));
+/*! \brief Set the maximal clock frequency of multiple cores
+
+Set the maximal clock frequency of multiple cores
+@param [in] num_cpus Number of CPUs
+@param [in] cpus List of CPU IDs
+@param [in] freq Frequency in kHz
+@return 0 for success, negative value in case of errors
+*/
+extern int freq_setCpuClockMaxList(const int num_cpus, const int* cpus, const uint64_t freq) __attribute__ ((visibility ("default") ));
+/*! \brief Set the minimal clock frequency of multiple cores
+
+Set the minimal clock frequency of multiple cores
+@param [in] num_cpus Number of CPUs
+@param [in] cpus List of CPU IDs
+@param [in] freq Frequency in kHz
+@return 0 for success, negative value in case of errors
+*/
+extern int freq_setCpuClockMinList(const int num_cpus, const int* cpus, const uint64_t freq) __attribute__ ((visibility ("default") ));
+/*! \brief Set the frequency governor of multiple cores
+
+Set the frequency governor of multiple cores
+@param [in] num_cpus Number of CPUs
+@param [in] cpus List of CPU IDs
+@param [in] gov Governor
+@return 0 for success, negative value in case of errors
+*/
+extern int freq_setGovernorList(const int num_cpus, const int* cpus, const char* gov) __attribute__ ((visibility ("default") ));
+
+/*! \brief Sample of the clock counters of a HW thread
+
+Snapshot of the clock counters used to calculate the effective clock frequency
+delivered by the hardware. In contrast to the cpufreq value, it includes Turbo
+mode and frequency drops caused by AVX or thermal/power limits.
+*/
+typedef struct {
+    int cpu_id; /*!< \brief HW thread ID */
+    uint64_t aperf; /*!< \brief Actual performance clock counter (IA32_APERF) */
+    uint64_t mperf; /*!< \brief Maximum performance clock counter (IA32_MPERF) */
+    uint64_t tsc; /*!< \brief Time stamp counter (IA32_TIME_STAMP_COUNTER) */
+} FreqSample;
+/*! \brief Initialize the effective clock sampler
+
+Initialize the access layer for the given HW threads and check whether the
+APERF/MPERF counters are readable. The sampler requires an invariant TSC
+because MPERF is assumed to tick with the TSC rate, this excludes older AMD
+CPUs that count MPERF with the P0 clock and the TSC with the boot clock.
+@param [in] num_cpus Number of HW threads
+@param [in] cpus List of HW thread IDs
+@return 0 for success, -ENODEV if the counters are not available, other negative values for errors
+*/
+extern int freq_initSampler(const int num_cpus, const int* cpus) __attribute__ ((visibility ("default") ));
+/*! \brief Read the clock counters of multiple HW threads
+
+Read the APERF, MPERF and TSC counters of all given HW threads in one go. The
+counters of a HW thread are read back-to-back, the TSC value is the midpoint of
+a read before and after MPERF and APERF to keep the skew between them small.
+@param [in] num_cpus Number of HW threads
+@param [in] cpus List of HW thread IDs
+@param [out] samples Array with num_cpus entries for the samples
+@return Number of read samples or negative value for errors
+*/
+extern int freq_readSamples(const int num_cpus, const int* cpus, FreqSample* samples) __attribute__ ((visibility ("default") ));
+/*! \brief Get the effective clock frequency between two samples
+
+Get the average clock frequency of a HW thread while it was not halted
+(APERF/MPERF ratio scaled by the TSC clock).
+@param [in] before Sample at the start of the interval
+@param [in] after Sample at the end of the interval
+@return Effective clock frequency in Hz or 0 in case of errors
+*/
+extern double freq_getEffectiveClock(const FreqSample* before, const FreqSample* after) __attribute__ ((visibility ("default") ));
+/*! \brief Get the fraction of time a HW thread was not halted between two samples
+
+Get the fraction of the interval the HW thread spent in C0 state (MPERF/TSC ratio).
+@param [in] before Sample at the start of the interval
+@param [in] after Sample at the end of the interval
+@return Fraction between 0 and 1 or 0 in case of errors
+*/
+extern double freq_getC0Residency(const FreqSample* before, const FreqSample* after) __attribute__ ((visibility ("default") ));
 /** @}*/
 
 #ifdef __cplusplus
@@ -40,6 +40,14 @@
 #define FREEZE_FLAG_CLEAR_CTR (1ULL<<1)
 #define FREEZE_FLAG_CLEAR_CTL (1ULL<<0)
 
+/* Overflow guard: counters are read PERFMON_GUARD_SAFETY times per wrap
+ * interval, the interval is clamped to the limits (in seconds) */
+#define PERFMON_GUARD_SAFETY 4
+#define PERFMON_GUARD_MIN_PERIOD 0.1
+#define PERFMON_GUARD_MAX_PERIOD 3600.0
+/* Assumed power in Watt if the RAPL info registers provide no limit */
+#define PERFMON_GUARD_DEFAULT_POWER 1000.0
+
 extern uint64_t currentConfig[MAX_NUM_THREADS][NUM_PMC];
 
 extern int (*perfmon_startCountersThread) (int thread_id, PerfmonEventSet* eventSet);
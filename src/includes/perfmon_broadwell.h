@@ -1072,7 +1072,7 @@ int perfmon_setupCounterThread_broadwell(
         PerfmonEvent *event = &(eventSet->events[i].event);
         uint64_t reg = counter_map[index].configRegister;
         PciDeviceIndex dev = counter_map[index].device;
-        eventSet->events[i].threadCounter[thread_id].init = TRUE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         flags = 0x0ULL;
         switch (type)
         {
@@ -1217,7 +1217,7 @@ int perfmon_startCountersThread_broadwell(int thread_id, PerfmonEventSet* eventS
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -1227,8 +1227,8 @@ int perfmon_startCountersThread_broadwell(int thread_id, PerfmonEventSet* eventS
             RegisterIndex index = eventSet->events[i].index;
             uint64_t counter1 = counter_map[index].counterRegister;
             PciDeviceIndex dev = counter_map[index].device;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             switch (type)
             {
                 case PMC:
@@ -1247,7 +1247,7 @@ int perfmon_startCountersThread_broadwell(int thread_id, PerfmonEventSet* eventS
                         tmp = 0x0ULL;
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1,(uint32_t*)&tmp));
                         VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST tmp, START_POWER)
-                        eventSet->events[i].threadCounter[thread_id].startData = field64(tmp, 0, box_map[type].regWidth);
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = field64(tmp, 0, box_map[type].regWidth);
                     }
                     break;
 
@@ -1257,7 +1257,7 @@ int perfmon_startCountersThread_broadwell(int thread_id, PerfmonEventSet* eventS
                         tmp = 0x0ULL;
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, dev, counter1, &tmp));
                         VERBOSEPRINTPCIREG(cpu_id, dev, counter1, LLU_CAST tmp, START_WBOXFIX);
-                        eventSet->events[i].threadCounter[thread_id].startData = field64(tmp, 0, box_map[type].regWidth);
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = field64(tmp, 0, box_map[type].regWidth);
                     }
                     break;
                 case QBOX0FIX:
@@ -1268,7 +1268,7 @@ int perfmon_startCountersThread_broadwell(int thread_id, PerfmonEventSet* eventS
                         {
                             CHECK_PCI_READ_ERROR(HPMread(cpu_id, dev, counter1, &tmp));
                             VERBOSEPRINTPCIREG(cpu_id, dev, counter1, LLU_CAST tmp, START_QBOXFIX);
-                            eventSet->events[i].threadCounter[thread_id].startData = field64(tmp, 0, box_map[type].regWidth);
+                            THREADCOUNTER(eventSet, i, thread_id, startData) = field64(tmp, 0, box_map[type].regWidth);
                         }
                     }
                     break;
@@ -1276,7 +1276,7 @@ int perfmon_startCountersThread_broadwell(int thread_id, PerfmonEventSet* eventS
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = eventSet->events[i].threadCounter[thread_id].startData;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = THREADCOUNTER(eventSet, i, thread_id, startData);
         }
     }
 
@@ -1379,26 +1379,26 @@ int bdw_uncore_read(int cpu_id, RegisterIndex index, PerfmonEvent *event,
 
 
 #define BDW_CHECK_CORE_OVERFLOW(offset) \
-    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData) \
+    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData)) \
     { \
         uint64_t ovf_values = 0x0ULL; \
         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values)); \
         if (ovf_values & (1ULL<<offset)) \
         { \
-            eventSet->events[i].threadCounter[thread_id].overflows++; \
+            THREADCOUNTER(eventSet, i, thread_id, overflows)++; \
         } \
         CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL, (1ULL<<offset))); \
     }
 
 #define BDW_CHECK_LOCAL_OVERFLOW \
-    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData) \
+    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData)) \
     { \
         uint64_t ovf_values = 0x0ULL; \
         uint64_t offset = getCounterTypeOffset(eventSet->events[i].index); \
         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, box_map[eventSet->events[i].type].statusRegister, &ovf_values)); \
         if (ovf_values & (1ULL<<offset)) \
         { \
-            eventSet->events[i].threadCounter[thread_id].overflows++; \
+            THREADCOUNTER(eventSet, i, thread_id, overflows)++; \
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, box_map[eventSet->events[i].type].statusRegister, (1ULL<<offset))); \
         } \
     }
@@ -1423,7 +1423,7 @@ int perfmon_stopCountersThread_broadwell(int thread_id, PerfmonEventSet* eventSe
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -1435,8 +1435,8 @@ int perfmon_stopCountersThread_broadwell(int thread_id, PerfmonEventSet* eventSe
             PerfmonEvent *event = &(eventSet->events[i].event);
             PciDeviceIndex dev = counter_map[index].device;
             uint64_t counter1 = counter_map[index].counterRegister;
-            uint64_t* current = &(eventSet->events[i].threadCounter[thread_id].counterData);
-            int* overflows = &(eventSet->events[i].threadCounter[thread_id].overflows);
+            uint64_t* current = &(THREADCOUNTER(eventSet, i, thread_id, counterData));
+            int* overflows = &(THREADCOUNTER(eventSet, i, thread_id, overflows));
             int ovf_offset = box_map[type].ovflOffset;
             switch (type)
             {
@@ -1457,9 +1457,9 @@ int perfmon_stopCountersThread_broadwell(int thread_id, PerfmonEventSet* eventSe
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&counter_result));
                         VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST counter_result, STOP_POWER)
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
                     }
                     break;
@@ -1551,7 +1551,7 @@ int perfmon_stopCountersThread_broadwell(int thread_id, PerfmonEventSet* eventSe
                     {
                         HPMread(cpu_id, dev, counter1, &counter_result);
                         VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST counter_result, READ_QBOXFIX)
-                        eventSet->events[i].threadCounter[thread_id].startData = 0;
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
                         if (eventSet->events[i].event.eventId == 0x00)
                         {
                             switch(extractBitField(counter_result, 3, 0))
@@ -1623,7 +1623,7 @@ int perfmon_readCountersThread_broadwell(int thread_id, PerfmonEventSet* eventSe
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             counter_result= 0x0ULL;
             RegisterType type = eventSet->events[i].type;
@@ -1635,8 +1635,8 @@ int perfmon_readCountersThread_broadwell(int thread_id, PerfmonEventSet* eventSe
             PerfmonEvent *event = &(eventSet->events[i].event);
             PciDeviceIndex dev = counter_map[index].device;
             uint64_t counter1 = counter_map[index].counterRegister;
-            uint64_t* current = &(eventSet->events[i].threadCounter[thread_id].counterData);
-            int* overflows = &(eventSet->events[i].threadCounter[thread_id].overflows);
+            uint64_t* current = &(THREADCOUNTER(eventSet, i, thread_id, counterData));
+            int* overflows = &(THREADCOUNTER(eventSet, i, thread_id, overflows));
             int ovf_offset = box_map[type].ovflOffset;
             switch (type)
             {
@@ -1659,9 +1659,9 @@ int perfmon_readCountersThread_broadwell(int thread_id, PerfmonEventSet* eventSe
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&counter_result));
                         VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST counter_result, STOP_POWER)
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
                         *current = field64(counter_result, 0, box_map[type].regWidth);
                     }
@@ -1864,7 +1864,7 @@ int perfmon_finalizeCountersThread_broadwell(int thread_id, PerfmonEventSet* eve
                     CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, dev, counter_map[index].counterRegister2, 0x0ULL));
             }
         }
-        eventSet->events[i].threadCounter[thread_id].init = FALSE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
     }
 
     if (haveLock && MEASURE_UNCORE(eventSet))
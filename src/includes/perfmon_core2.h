@@ -124,7 +124,7 @@ int perfmon_setupCounterThread_core2( int thread_id, PerfmonEventSet* eventSet)
         }
         RegisterIndex index = eventSet->events[i].index;
         PerfmonEvent *event = &(eventSet->events[i].event);
-        eventSet->events[i].threadCounter[thread_id].init = TRUE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         switch (type)
         {
             case PMC:
@@ -152,7 +152,7 @@ int perfmon_startCountersThread_core2(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -161,8 +161,8 @@ int perfmon_startCountersThread_core2(int thread_id, PerfmonEventSet* eventSet)
             }
             RegisterIndex index = eventSet->events[i].index;
             uint64_t counter = counter_map[index].counterRegister;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, counter, 0x0ULL));
 
             if (type == PMC)
@@ -186,13 +186,13 @@ int perfmon_startCountersThread_core2(int thread_id, PerfmonEventSet* eventSet)
 }
 
 #define CORE2_CHECK_OVERFLOW(offset) \
-    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData) \
+    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData)) \
     { \
         uint64_t ovf_values = 0x0ULL; \
         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values)); \
         if (ovf_values & (1ULL<<offset)) \
         { \
-            eventSet->events[i].threadCounter[thread_id].overflows++; \
+            THREADCOUNTER(eventSet, i, thread_id, overflows)++; \
         } \
         CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL, (1ULL<<offset))); \
     }
@@ -212,7 +212,7 @@ int perfmon_stopCountersThread_core2(int thread_id, PerfmonEventSet* eventSet)
     /* read out counter results */
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -237,7 +237,7 @@ int perfmon_stopCountersThread_core2(int thread_id, PerfmonEventSet* eventSet)
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
         }
     }
 
@@ -261,7 +261,7 @@ int perfmon_readCountersThread_core2(int thread_id, PerfmonEventSet* eventSet)
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
         counter_result = 0x0ULL;
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -285,7 +285,7 @@ int perfmon_readCountersThread_core2(int thread_id, PerfmonEventSet* eventSet)
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
         }
     }
 
@@ -313,7 +313,7 @@ int perfmon_finalizeCountersThread_core2(int thread_id, PerfmonEventSet* eventSe
         }
         RegisterIndex index = eventSet->events[i].index;
         uint64_t reg = counter_map[index].configRegister;
-        eventSet->events[i].threadCounter[thread_id].init = FALSE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
         if (type == PMC)
         {
             ovf_values_core |= (1ULL<<(index - cpuid_info.perf_num_fixed_ctr));
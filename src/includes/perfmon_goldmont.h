@@ -186,7 +186,7 @@ int perfmon_setupCounterThread_goldmont(
         RegisterIndex index = eventSet->events[i].index;
         PerfmonEvent *event = &(eventSet->events[i].event);
         uint64_t reg = counter_map[index].configRegister;
-        eventSet->events[i].threadCounter[thread_id].init = TRUE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         flags = 0x0ULL;
         switch (type)
         {
@@ -228,7 +228,7 @@ int perfmon_startCountersThread_goldmont(int thread_id, PerfmonEventSet* eventSe
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -240,8 +240,8 @@ int perfmon_startCountersThread_goldmont(int thread_id, PerfmonEventSet* eventSe
             uint64_t counter1 = counter_map[index].counterRegister;
 
             PciDeviceIndex dev = counter_map[index].device;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             switch (type)
             {
                 case PMC:
@@ -260,13 +260,13 @@ int perfmon_startCountersThread_goldmont(int thread_id, PerfmonEventSet* eventSe
                         tmp = 0x0ULL;
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1,(uint32_t*)&tmp));
                         VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST tmp, START_POWER)
-                        eventSet->events[i].threadCounter[thread_id].startData = field64(tmp, 0, box_map[type].regWidth);
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = field64(tmp, 0, box_map[type].regWidth);
                     }
                     break;
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = eventSet->events[i].threadCounter[thread_id].startData;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = THREADCOUNTER(eventSet, i, thread_id, startData);
         }
     }
 
@@ -283,26 +283,26 @@ int perfmon_startCountersThread_goldmont(int thread_id, PerfmonEventSet* eventSe
 
 
 #define GLM_CHECK_CORE_OVERFLOW(offset) \
-    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData) \
+    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData)) \
     { \
         uint64_t ovf_values = 0x0ULL; \
         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values)); \
         if (ovf_values & (1ULL<<offset)) \
         { \
-            eventSet->events[i].threadCounter[thread_id].overflows++; \
+            THREADCOUNTER(eventSet, i, thread_id, overflows)++; \
         } \
         CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL, (1ULL<<offset))); \
     }
 
 #define GLM_CHECK_LOCAL_OVERFLOW \
-    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData) \
+    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData)) \
     { \
         uint64_t ovf_values = 0x0ULL; \
         uint64_t offset = getCounterTypeOffset(eventSet->events[i].index); \
         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, box_map[eventSet->events[i].type].statusRegister, &ovf_values)); \
         if (ovf_values & (1ULL<<offset)) \
         { \
-            eventSet->events[i].threadCounter[thread_id].overflows++; \
+            THREADCOUNTER(eventSet, i, thread_id, overflows)++; \
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, box_map[eventSet->events[i].type].statusRegister, (1ULL<<offset))); \
         } \
     }
@@ -326,7 +326,7 @@ int perfmon_stopCountersThread_goldmont(int thread_id, PerfmonEventSet* eventSet
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -338,8 +338,8 @@ int perfmon_stopCountersThread_goldmont(int thread_id, PerfmonEventSet* eventSet
             PerfmonEvent *event = &(eventSet->events[i].event);
             PciDeviceIndex dev = counter_map[index].device;
             uint64_t counter1 = counter_map[index].counterRegister;
-            uint64_t* current = &(eventSet->events[i].threadCounter[thread_id].counterData);
-            int* overflows = &(eventSet->events[i].threadCounter[thread_id].overflows);
+            uint64_t* current = &(THREADCOUNTER(eventSet, i, thread_id, counterData));
+            int* overflows = &(THREADCOUNTER(eventSet, i, thread_id, overflows));
             switch (type)
             {
                 case PMC:
@@ -361,9 +361,9 @@ int perfmon_stopCountersThread_goldmont(int thread_id, PerfmonEventSet* eventSet
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&counter_result));
                         VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST counter_result, STOP_POWER)
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
                         *current = field64(counter_result, 0, box_map[type].regWidth);
                     }
@@ -407,7 +407,7 @@ int perfmon_readCountersThread_goldmont(int thread_id, PerfmonEventSet* eventSet
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             counter_result= 0x0ULL;
             RegisterType type = eventSet->events[i].type;
@@ -419,22 +419,22 @@ int perfmon_readCountersThread_goldmont(int thread_id, PerfmonEventSet* eventSet
             PerfmonEvent *event = &(eventSet->events[i].event);
             PciDeviceIndex dev = counter_map[index].device;
             uint64_t counter1 = counter_map[index].counterRegister;
-            uint64_t* current = &(eventSet->events[i].threadCounter[thread_id].counterData);
-            int* overflows = &(eventSet->events[i].threadCounter[thread_id].overflows);
+            uint64_t* current = &(THREADCOUNTER(eventSet, i, thread_id, counterData));
+            int* overflows = &(THREADCOUNTER(eventSet, i, thread_id, overflows));
             switch (type)
             {
                 case PMC:
                     CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter1, &counter_result));
                     GLM_CHECK_CORE_OVERFLOW(index-cpuid_info.perf_num_fixed_ctr);
                     VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST counter_result, READ_PMC)
-                    eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+                    THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
                     break;
 
                 case FIXED:
                     CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter1, &counter_result));
                     GLM_CHECK_CORE_OVERFLOW(index+32);
                     VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST counter_result, READ_FIXED)
-                    eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+                    THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
                     break;
 
                 case POWER:
@@ -442,11 +442,11 @@ int perfmon_readCountersThread_goldmont(int thread_id, PerfmonEventSet* eventSet
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&counter_result));
                         VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST counter_result, STOP_POWER)
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
-                        eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+                        THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
                     }
                     break;
 
@@ -525,7 +525,7 @@ int perfmon_finalizeCountersThread_goldmont(int thread_id, PerfmonEventSet* even
                 CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, dev, counter_map[index].counterRegister2, 0x0ULL));
             }
         }
-        eventSet->events[i].threadCounter[thread_id].init = FALSE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
     }
 
     if (MEASURE_CORE(eventSet))
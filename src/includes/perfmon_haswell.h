@@ -1063,7 +1063,7 @@ int perfmon_setupCounterThread_haswell(
         RegisterIndex index = eventSet->events[i].index;
         PerfmonEvent *event = &(eventSet->events[i].event);
         uint64_t reg = counter_map[index].configRegister;
-        eventSet->events[i].threadCounter[thread_id].init = TRUE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         flags = 0x0ULL;
         switch (type)
         {
@@ -1211,7 +1211,7 @@ int perfmon_startCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -1222,8 +1222,8 @@ int perfmon_startCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet
             RegisterIndex index = eventSet->events[i].index;
             uint64_t counter1 = counter_map[index].counterRegister;
             PciDeviceIndex dev = counter_map[index].device;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             switch (type)
             {
                 case PMC:
@@ -1244,7 +1244,7 @@ int perfmon_startCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet
                         tmp = 0x0ULL;
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1,(uint32_t*)&tmp));
                         VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST tmp, START_POWER)
-                        eventSet->events[i].threadCounter[thread_id].startData = field64(tmp, 0, box_map[type].regWidth);
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = field64(tmp, 0, box_map[type].regWidth);
                     }
                     break;
                 case WBOX0FIX:
@@ -1253,7 +1253,7 @@ int perfmon_startCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet
                         tmp = 0x0ULL;
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, dev, counter1, &tmp));
                         VERBOSEPRINTPCIREG(cpu_id, dev, counter1, LLU_CAST tmp, START_WBOXFIX);
-                        eventSet->events[i].threadCounter[thread_id].startData = field64(tmp, 0, box_map[type].regWidth);
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = field64(tmp, 0, box_map[type].regWidth);
                     }
                     break;
                 case QBOX0FIX:
@@ -1264,7 +1264,7 @@ int perfmon_startCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet
                         {
                             CHECK_PCI_READ_ERROR(HPMread(cpu_id, dev, counter1, &tmp));
                             VERBOSEPRINTPCIREG(cpu_id, dev, counter1, LLU_CAST tmp, START_QBOXFIX);
-                            eventSet->events[i].threadCounter[thread_id].startData = field64(tmp, 0, box_map[type].regWidth);
+                            THREADCOUNTER(eventSet, i, thread_id, startData) = field64(tmp, 0, box_map[type].regWidth);
                         }
                     }
                     break;
@@ -1272,7 +1272,7 @@ int perfmon_startCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = eventSet->events[i].threadCounter[thread_id].startData;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = THREADCOUNTER(eventSet, i, thread_id, startData);
         }
     }
 
@@ -1375,27 +1375,27 @@ int has_uncore_read(int cpu_id, RegisterIndex index, PerfmonEvent *event,
 }
 
 #define HASEP_CHECK_CORE_OVERFLOW(offset) \
-    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData) \
+    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData)) \
     { \
         uint64_t ovf_values = 0x0ULL; \
         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values)); \
         if (ovf_values & (1ULL<<offset)) \
         { \
-            eventSet->events[i].threadCounter[thread_id].overflows++; \
+            THREADCOUNTER(eventSet, i, thread_id, overflows)++; \
         } \
         CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL, (1ULL<<offset))); \
     }
 
 
 #define HASEP_CHECK_LOCAL_OVERFLOW \
-    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData) \
+    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData)) \
     { \
         uint64_t ovf_values = 0x0ULL; \
         uint64_t offset = getCounterTypeOffset(eventSet->events[i].index); \
         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, box_map[eventSet->events[i].type].statusRegister, &ovf_values)); \
         if (ovf_values & (1ULL<<offset)) \
         { \
-            eventSet->events[i].threadCounter[thread_id].overflows++; \
+            THREADCOUNTER(eventSet, i, thread_id, overflows)++; \
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, box_map[eventSet->events[i].type].statusRegister, (1ULL<<offset))); \
         } \
     }
@@ -1422,7 +1422,7 @@ int perfmon_stopCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -1434,8 +1434,8 @@ int perfmon_stopCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet)
             PerfmonEvent *event = &(eventSet->events[i].event);
             PciDeviceIndex dev = counter_map[index].device;
             uint64_t counter1 = counter_map[index].counterRegister;
-            uint64_t* current = &(eventSet->events[i].threadCounter[thread_id].counterData);
-            int* overflows = &(eventSet->events[i].threadCounter[thread_id].overflows);
+            uint64_t* current = &(THREADCOUNTER(eventSet, i, thread_id, counterData));
+            int* overflows = &(THREADCOUNTER(eventSet, i, thread_id, overflows));
             int ovf_offset = box_map[type].ovflOffset;
             switch (type)
             {
@@ -1458,10 +1458,10 @@ int perfmon_stopCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet)
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&counter_result));
                         VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST counter_result, STOP_POWER)
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
                             VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST counter_result, OVERFLOW_POWER)
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
                         *current = field64(counter_result, 0, box_map[type].regWidth);
                     }
@@ -1599,8 +1599,8 @@ int perfmon_stopCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet)
                         counter_result = field64(counter_result, 0, box_map[type].regWidth);
                     }
                     VERBOSEPRINTPCIREG(cpu_id, dev, counter1, LLU_CAST counter_result, STOP_QBOXFIX);
-                    eventSet->events[i].threadCounter[thread_id].counterData = counter_result;
-                    eventSet->events[i].threadCounter[thread_id].startData = 0;
+                    THREADCOUNTER(eventSet, i, thread_id, counterData) = counter_result;
+                    THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
                     break;
 
                 default:
@@ -1638,7 +1638,7 @@ int perfmon_readCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             counter_result= 0x0ULL;
             RegisterType type = eventSet->events[i].type;
@@ -1650,8 +1650,8 @@ int perfmon_readCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet)
             PerfmonEvent *event = &(eventSet->events[i].event);
             PciDeviceIndex dev = counter_map[index].device;
             uint64_t counter1 = counter_map[index].counterRegister;
-            uint64_t* current = &(eventSet->events[i].threadCounter[thread_id].counterData);
-            int* overflows = &(eventSet->events[i].threadCounter[thread_id].overflows);
+            uint64_t* current = &(THREADCOUNTER(eventSet, i, thread_id, counterData));
+            int* overflows = &(THREADCOUNTER(eventSet, i, thread_id, overflows));
             int ovf_offset = box_map[type].ovflOffset;
             switch (type)
             {
@@ -1675,10 +1675,10 @@ int perfmon_readCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet)
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&counter_result));
                         VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST counter_result, READ_POWER)
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
                             VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST counter_result, OVERFLOW_POWER)
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
                         *current = field64(counter_result, 0, box_map[type].regWidth);
                     }
@@ -1814,7 +1814,7 @@ int perfmon_readCountersThread_haswell(int thread_id, PerfmonEventSet* eventSet)
                         HPMread(cpu_id, dev, counter1, &counter_result);
                         counter_result = field64(counter_result, 0, box_map[type].regWidth);
                     }
-                    eventSet->events[i].threadCounter[thread_id].counterData = counter_result;
+                    THREADCOUNTER(eventSet, i, thread_id, counterData) = counter_result;
                     break;
 
                 default:
@@ -1912,7 +1912,7 @@ int perfmon_finalizeCountersThread_haswell(int thread_id, PerfmonEventSet* event
                     CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, dev, counter_map[index].counterRegister2, 0x0ULL));
             }
         }
-        eventSet->events[i].threadCounter[thread_id].init = FALSE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
     }
     if (haveLock && MEASURE_UNCORE(eventSet))
     {
@@ -124,7 +124,7 @@ int perfmon_setupCounterThread_interlagos(int thread_id, PerfmonEventSet* eventS
         }
         RegisterIndex index = eventSet->events[i].index;
         PerfmonEvent *event = &(eventSet->events[i].event);
-        eventSet->events[i].threadCounter[thread_id].init = TRUE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         switch(type)
         {
             case PMC:
@@ -154,7 +154,7 @@ int perfmon_startCountersThread_interlagos(int thread_id, PerfmonEventSet* event
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -164,8 +164,8 @@ int perfmon_startCountersThread_interlagos(int thread_id, PerfmonEventSet* event
             RegisterIndex index = eventSet->events[i].index;
             uint32_t counter = counter_map[index].counterRegister;
             uint32_t reg = counter_map[index].configRegister;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             if (type == PMC || ((type == UNCORE) && (haveLock)))
             {
                 CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, counter, 0x0ULL));
@@ -192,7 +192,7 @@ int perfmon_stopCountersThread_interlagos(int thread_id, PerfmonEventSet* eventS
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -223,7 +223,7 @@ int perfmon_stopCountersThread_interlagos(int thread_id, PerfmonEventSet* eventS
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(tmp, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(tmp, 0, box_map[type].regWidth);
         }
     }
     return 0;
@@ -243,7 +243,7 @@ int perfmon_readCountersThread_interlagos(int thread_id, PerfmonEventSet* eventS
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -266,7 +266,7 @@ int perfmon_readCountersThread_interlagos(int thread_id, PerfmonEventSet* eventS
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(tmp, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(tmp, 0, box_map[type].regWidth);
         }
     }
     return 0;
@@ -298,7 +298,7 @@ int perfmon_finalizeCountersThread_interlagos(int thread_id, PerfmonEventSet* ev
             VERBOSEPRINTREG(cpu_id, counter_map[index].counterRegister, LLU_CAST 0x0ULL, CLEAR_CTR);
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, counter_map[index].counterRegister, 0x0ULL));
         }
-        eventSet->events[i].threadCounter[thread_id].init = FALSE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
     }
     return 0;
 }
@@ -767,7 +767,7 @@ int perfmon_setupCounterThread_ivybridge(
         }
         RegisterIndex index = eventSet->events[i].index;
         PerfmonEvent *event = &(eventSet->events[i].event);
-        eventSet->events[i].threadCounter[thread_id].init = TRUE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         switch (type)
         {
             case PMC:
@@ -891,7 +891,7 @@ int perfmon_startCountersThread_ivybridge(int thread_id, PerfmonEventSet* eventS
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -902,8 +902,8 @@ int perfmon_startCountersThread_ivybridge(int thread_id, PerfmonEventSet* eventS
             RegisterIndex index = eventSet->events[i].index;
             uint64_t counter1 = counter_map[index].counterRegister;
             uint64_t counter2 = counter_map[index].counterRegister2;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             switch (type)
             {
                 case PMC:
@@ -921,7 +921,7 @@ int perfmon_startCountersThread_ivybridge(int thread_id, PerfmonEventSet* eventS
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&tmp));
                         VERBOSEPRINTREG(cpu_id, counter1, LLU_CAST field64(tmp, 0, box_map[type].regWidth), START_POWER)
-                        eventSet->events[i].threadCounter[thread_id].startData = field64(tmp, 0, box_map[type].regWidth);
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = field64(tmp, 0, box_map[type].regWidth);
                     }
                     break;
 
@@ -937,7 +937,7 @@ int perfmon_startCountersThread_ivybridge(int thread_id, PerfmonEventSet* eventS
                     }
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = eventSet->events[i].threadCounter[thread_id].startData;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = THREADCOUNTER(eventSet, i, thread_id, startData);
         }
     }
 
@@ -1088,7 +1088,7 @@ int perfmon_stopCountersThread_ivybridge(int thread_id, PerfmonEventSet* eventSe
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -1100,8 +1100,8 @@ int perfmon_stopCountersThread_ivybridge(int thread_id, PerfmonEventSet* eventSe
             PerfmonEvent *event = &(eventSet->events[i].event);
             PciDeviceIndex dev = counter_map[index].device;
             uint64_t counter1 = counter_map[index].counterRegister;
-            uint64_t* current = &(eventSet->events[i].threadCounter[thread_id].counterData);
-            int* overflows = &(eventSet->events[i].threadCounter[thread_id].overflows);
+            uint64_t* current = &(THREADCOUNTER(eventSet, i, thread_id, counterData));
+            int* overflows = &(THREADCOUNTER(eventSet, i, thread_id, overflows));
             switch (type)
             {
                 case PMC:
@@ -1179,7 +1179,7 @@ int perfmon_stopCountersThread_ivybridge(int thread_id, PerfmonEventSet* eventSe
                                 break;
                         }
                         VERBOSEPRINTPCIREG(cpu_id, dev, counter1, LLU_CAST counter_result, READ_SBOX_FIXED_REAL)
-                        eventSet->events[i].threadCounter[thread_id].startData = 0;
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
                     }
                     break;
 
@@ -1283,7 +1283,7 @@ int perfmon_readCountersThread_ivybridge(int thread_id, PerfmonEventSet* eventSe
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -1295,8 +1295,8 @@ int perfmon_readCountersThread_ivybridge(int thread_id, PerfmonEventSet* eventSe
             PerfmonEvent *event = &(eventSet->events[i].event);
             PciDeviceIndex dev = counter_map[index].device;
             uint64_t counter1 = counter_map[index].counterRegister;
-            uint64_t* current = &(eventSet->events[i].threadCounter[thread_id].counterData);
-            int* overflows = &(eventSet->events[i].threadCounter[thread_id].overflows);
+            uint64_t* current = &(THREADCOUNTER(eventSet, i, thread_id, counterData));
+            int* overflows = &(THREADCOUNTER(eventSet, i, thread_id, overflows));
             switch (type)
             {
                 case PMC:
@@ -1381,7 +1381,7 @@ int perfmon_readCountersThread_ivybridge(int thread_id, PerfmonEventSet* eventSe
                             counter_result = extractBitField(counter_result,1,4);
                         }
                         VERBOSEPRINTPCIREG(cpu_id, dev, counter1, LLU_CAST counter_result, READ_SBOX_FIXED_REAL)
-                        eventSet->events[i].threadCounter[thread_id].startData = 0;
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
                     }
                     break;
 
@@ -1538,7 +1538,7 @@ int perfmon_finalizeCountersThread_ivybridge(int thread_id, PerfmonEventSet* eve
                     CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, dev, counter_map[index].counterRegister, 0x0ULL));
             }
         }
-        eventSet->events[i].threadCounter[thread_id].init = FALSE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
     }
     if (haveLock && MEASURE_UNCORE(eventSet))
     {
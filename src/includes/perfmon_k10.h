@@ -99,7 +99,7 @@ int perfmon_setupCounterThread_k10(int thread_id, PerfmonEventSet* eventSet)
         if (type == PMC)
         {
             k10_pmc_setup(cpu_id, index, event);
-            eventSet->events[i].threadCounter[thread_id].init = TRUE;
+            THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         }
     }
     return 0;
@@ -112,7 +112,7 @@ int perfmon_startCountersThread_k10(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -122,8 +122,8 @@ int perfmon_startCountersThread_k10(int thread_id, PerfmonEventSet* eventSet)
             RegisterIndex index = eventSet->events[i].index;
             uint32_t reg = counter_map[index].configRegister;
             uint32_t counter = counter_map[index].counterRegister;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             VERBOSEPRINTREG(cpu_id, counter, 0x0ULL, CLEAR_PMC);
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, counter, 0x0ULL));
             CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, reg, &flags));
@@ -144,7 +144,7 @@ int perfmon_stopCountersThread_k10(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -162,11 +162,11 @@ int perfmon_stopCountersThread_k10(int thread_id, PerfmonEventSet* eventSet)
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, reg, flags));
             CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter, &tmp));
             VERBOSEPRINTREG(cpu_id, counter, tmp, READ_PMC);
-            if (tmp < eventSet->events[i].threadCounter[thread_id].counterData)
+            if (tmp < THREADCOUNTER(eventSet, i, thread_id, counterData))
             {
-                eventSet->events[i].threadCounter[thread_id].overflows++;
+                THREADCOUNTER(eventSet, i, thread_id, overflows)++;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(tmp, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(tmp, 0, box_map[type].regWidth);
         }
     }
     return 0;
@@ -179,7 +179,7 @@ int perfmon_readCountersThread_k10(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -191,11 +191,11 @@ int perfmon_readCountersThread_k10(int thread_id, PerfmonEventSet* eventSet)
             uint32_t counter = counter_map[index].counterRegister;
             CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter, &tmp));
             VERBOSEPRINTREG(cpu_id, counter, tmp, READ_PMC);
-            if (tmp < eventSet->events[i].threadCounter[thread_id].counterData)
+            if (tmp < THREADCOUNTER(eventSet, i, thread_id, counterData))
             {
-                eventSet->events[i].threadCounter[thread_id].overflows++;
+                THREADCOUNTER(eventSet, i, thread_id, overflows)++;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(tmp, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(tmp, 0, box_map[type].regWidth);
         }
     }
     return 0;
@@ -222,7 +222,7 @@ int perfmon_finalizeCountersThread_k10(int thread_id, PerfmonEventSet* eventSet)
             VERBOSEPRINTREG(cpu_id, counter_map[index].counterRegister, 0x0ULL, CLEAR_CTR);
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, counter_map[index].counterRegister, 0x0ULL));
         }
-        eventSet->events[i].threadCounter[thread_id].init = FALSE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
     }
     return 0;
 }
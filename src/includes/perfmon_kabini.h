@@ -178,7 +178,7 @@ int perfmon_setupCounterThread_kabini(int thread_id, PerfmonEventSet* eventSet)
             default:
                 break;
         }
-        eventSet->events[i].threadCounter[thread_id].init = TRUE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
     }
     return 0;
 }
@@ -202,7 +202,7 @@ int perfmon_startCountersThread_kabini(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -212,8 +212,8 @@ int perfmon_startCountersThread_kabini(int thread_id, PerfmonEventSet* eventSet)
             RegisterIndex index = eventSet->events[i].index;
             uint32_t reg = counter_map[index].configRegister;
             uint32_t counter = counter_map[index].counterRegister;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             if ((type == PMC) ||
                 ((type == UNCORE) && (haveSLock)) ||
                 ((type == CBOX0) && (haveTLock)))
@@ -247,7 +247,7 @@ int perfmon_stopCountersThread_kabini(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -266,11 +266,11 @@ int perfmon_stopCountersThread_kabini(int thread_id, PerfmonEventSet* eventSet)
                 flags &= ~(1ULL<<22);  /* clear enable flag */
                 CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, reg, flags));
                 CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter, &counter_result));
-                if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                 {
-                    eventSet->events[i].threadCounter[thread_id].overflows++;
+                    THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                 }
-                eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+                THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
             }
         }
     }
@@ -296,7 +296,7 @@ int perfmon_readCountersThread_kabini(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -313,11 +313,11 @@ int perfmon_readCountersThread_kabini(int thread_id, PerfmonEventSet* eventSet)
             {
                 CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter, &counter_result));
                 VERBOSEPRINTREG(cpu_id, counter, counter_result, CLEAR_CTRL);
-                if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                 {
-                    eventSet->events[i].threadCounter[thread_id].overflows++;
+                    THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                 }
-                eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+                THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
             }
         }
     }
@@ -355,7 +355,7 @@ int perfmon_finalizeCountersThread_kabini(int thread_id, PerfmonEventSet* eventS
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, counter_map[index].configRegister, 0x0ULL));
             VERBOSEPRINTREG(cpu_id, counter_map[index].counterRegister, 0x0ULL, CLEAR_CTR);
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, counter_map[index].counterRegister, 0x0ULL));
-            eventSet->events[i].threadCounter[thread_id].init = FALSE;
+            THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
         }
     }
     return 0;
@@ -463,7 +463,7 @@ int perfmon_setupCountersThread_knl(
         PerfmonEvent *event = &(eventSet->events[i].event);
         uint64_t reg = counter_map[index].configRegister;
         PciDeviceIndex dev = counter_map[index].device;
-        eventSet->events[i].threadCounter[thread_id].init = TRUE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         switch (type)
         {
             case PMC:
@@ -670,7 +670,7 @@ int perfmon_startCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -682,8 +682,8 @@ int perfmon_startCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
             PciDeviceIndex dev = counter_map[index].device;
             uint64_t counter1 = counter_map[index].counterRegister;
             uint64_t counter2 = counter_map[index].counterRegister2;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             switch (type)
             {
                 case PMC:
@@ -700,7 +700,7 @@ int perfmon_startCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
                     if(haveLock)
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&tmp));
-                        eventSet->events[i].threadCounter[thread_id].startData = field64(tmp, 0, box_map[type].regWidth);
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = field64(tmp, 0, box_map[type].regWidth);
                     }
                     break;
                 case MBOX0FIX:
@@ -737,7 +737,7 @@ int perfmon_startCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = eventSet->events[i].threadCounter[thread_id].startData;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = THREADCOUNTER(eventSet, i, thread_id, startData);
         }
     }
 
@@ -839,13 +839,13 @@ int knl_uncore_read(int cpu_id, RegisterIndex index, PerfmonEvent *event,
 }
 
 #define KNL_CHECK_CORE_OVERFLOW(offset) \
-    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData) \
+    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData)) \
     { \
         uint64_t ovf_values = 0x0ULL; \
         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values)); \
         if (ovf_values & (1ULL<<offset)) \
         { \
-            eventSet->events[i].threadCounter[thread_id].overflows++; \
+            THREADCOUNTER(eventSet, i, thread_id, overflows)++; \
         } \
         CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, (1ULL<<offset))); \
     }
@@ -871,7 +871,7 @@ int perfmon_stopCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -884,8 +884,8 @@ int perfmon_stopCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
             PciDeviceIndex dev = counter_map[index].device;
             uint64_t counter1 = counter_map[index].counterRegister;
             uint64_t counter2 = counter_map[index].counterRegister2;
-            uint64_t* current = &(eventSet->events[i].threadCounter[thread_id].counterData);
-            int* overflows = &(eventSet->events[i].threadCounter[thread_id].overflows);
+            uint64_t* current = &(THREADCOUNTER(eventSet, i, thread_id, counterData));
+            int* overflows = &(THREADCOUNTER(eventSet, i, thread_id, overflows));
             int ovf_offset = box_map[type].ovflOffset;
             switch (type)
             {
@@ -904,9 +904,9 @@ int perfmon_stopCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
                     if(haveLock)
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&counter_result));
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
                     }
                     break;
@@ -1018,9 +1018,9 @@ int perfmon_stopCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
                         VERBOSEPRINTPCIREG(cpu_id, dev, counter2, LLU_CAST tmp , READ_FIXED_BOX_1);
                         counter_result = (counter_result<<32)|tmp;
                         counter_result = field64(counter_result, 0, box_map[type].regWidth);
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
                     }
                     break;
@@ -1028,8 +1028,8 @@ int perfmon_stopCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
-            eventSet->events[i].threadCounter[thread_id].init = FALSE;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
         }
     }
     return 0;
@@ -1057,7 +1057,7 @@ int perfmon_readCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -1069,8 +1069,8 @@ int perfmon_readCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
             PerfmonEvent *event = &(eventSet->events[i].event);
             PciDeviceIndex dev = counter_map[index].device;
             uint64_t counter1 = counter_map[index].counterRegister;
-            uint64_t* current = &(eventSet->events[i].threadCounter[thread_id].counterData);
-            int* overflows = &(eventSet->events[i].threadCounter[thread_id].overflows);
+            uint64_t* current = &(THREADCOUNTER(eventSet, i, thread_id, counterData));
+            int* overflows = &(THREADCOUNTER(eventSet, i, thread_id, overflows));
             int ovf_offset = box_map[type].ovflOffset;
             switch (type)
             {
@@ -1089,9 +1089,9 @@ int perfmon_readCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
                     if(haveLock)
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&counter_result));
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
                     }
                     break;
@@ -1197,9 +1197,9 @@ int perfmon_readCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
                     if (haveLock)
                     {
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, dev, counter1, &counter_result));
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
                     }
                     break;
@@ -1207,7 +1207,7 @@ int perfmon_readCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
         }
     }
     KNL_UNFREEZE_UNCORE;
@@ -1275,7 +1275,7 @@ int perfmon_finalizeCountersThread_knl(int thread_id, PerfmonEventSet* eventSet)
             VERBOSEPRINTPCIREG(cpu_id, dev, reg, 0x0ULL, CLEAR_CTL);
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, dev, reg, 0x0ULL));
         }
-        eventSet->events[i].threadCounter[thread_id].init = FALSE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
     }
 
     if (haveLock && MEASURE_UNCORE(eventSet))
@@ -323,7 +323,7 @@ int perfmon_setupCountersThread_perfevent(
                 group_fd = cpu_event_fds[cpu_id][index];
                 running_group = group_fd;
             }
-            eventSet->events[i].threadCounter[thread_id].init = TRUE;
+            THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         }
     }
     return 0;
@@ -334,14 +334,14 @@ int perfmon_startCountersThread_perfevent(int thread_id, PerfmonEventSet* eventS
     int cpu_id = groupSet->threads[thread_id].processorId;
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterIndex index = eventSet->events[i].index;
             if (cpu_event_fds[cpu_id][index] < 0)
                 continue;
             VERBOSEPRINTREG(cpu_id, 0x0, 0x0, RESET_COUNTER);
             ioctl(cpu_event_fds[cpu_id][index], PERF_EVENT_IOC_RESET, 0);
-            eventSet->events[i].threadCounter[thread_id].startData = 0x0ULL;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0x0ULL;
             VERBOSEPRINTREG(cpu_id, 0x0, 0x0, START_COUNTER);
             ioctl(cpu_event_fds[cpu_id][index], PERF_EVENT_IOC_ENABLE, 0);
         }
@@ -356,7 +356,7 @@ int perfmon_stopCountersThread_perfevent(int thread_id, PerfmonEventSet* eventSe
     long long tmp = 0;
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterIndex index = eventSet->events[i].index;
             if (cpu_event_fds[cpu_id][index] < 0)
@@ -368,7 +368,7 @@ int perfmon_stopCountersThread_perfevent(int thread_id, PerfmonEventSet* eventSe
             DEBUG_PRINT(DEBUGLEV_DEVELOP, READ CPU %d COUNTER %d VALUE %llu, cpu_id, index, tmp);
             if (ret == sizeof(long long))
             {
-                eventSet->events[i].threadCounter[thread_id].counterData = tmp;
+                THREADCOUNTER(eventSet, i, thread_id, counterData) = tmp;
             }
             ioctl(cpu_event_fds[cpu_id][index], PERF_EVENT_IOC_RESET, 0);
             VERBOSEPRINTREG(cpu_id, cpu_event_fds[cpu_id][index], 0x0, RESET_COUNTER);
@@ -383,7 +383,7 @@ int perfmon_readCountersThread_perfevent(int thread_id, PerfmonEventSet* eventSe
     long long tmp = 0;
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterIndex index = eventSet->events[i].index;
             if (cpu_event_fds[cpu_id][index] < 0)
@@ -395,7 +395,7 @@ int perfmon_readCountersThread_perfevent(int thread_id, PerfmonEventSet* eventSe
             VERBOSEPRINTREG(cpu_id, cpu_event_fds[cpu_id][index], tmp, READ_COUNTER);
             if (ret == sizeof(long long))
             {
-                eventSet->events[i].threadCounter[thread_id].counterData = tmp;
+                THREADCOUNTER(eventSet, i, thread_id, counterData) = tmp;
             }
             VERBOSEPRINTREG(cpu_id, cpu_event_fds[cpu_id][index], 0x0, UNFREEZE_COUNTER);
             ioctl(cpu_event_fds[cpu_id][index], PERF_EVENT_IOC_ENABLE, 0);
@@ -408,12 +408,12 @@ int perfmon_finalizeCountersThread_perfevent(int thread_id, PerfmonEventSet* eve
     int cpu_id = groupSet->threads[thread_id].processorId;
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterIndex index = eventSet->events[i].index;
             ioctl(cpu_event_fds[cpu_id][index], PERF_EVENT_IOC_DISABLE, 0);
             ioctl(cpu_event_fds[cpu_id][index], PERF_EVENT_IOC_RESET, 0);
-            eventSet->events[i].threadCounter[thread_id].init = FALSE;
+            THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
             close(cpu_event_fds[cpu_id][index]);
             cpu_event_fds[cpu_id][index] = -1;
         }
@@ -99,7 +99,7 @@ int perfmon_setupCounterThread_phi(int thread_id, PerfmonEventSet* eventSet)
         if (type == PMC)
         {
             phi_pmc_setup(cpu_id, index, event);
-            eventSet->events[i].threadCounter[thread_id].init = TRUE;
+            THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         }
     }
     return 0;
@@ -114,7 +114,7 @@ int perfmon_startCountersThread_phi(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE) 
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE) 
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -122,8 +122,8 @@ int perfmon_startCountersThread_phi(int thread_id, PerfmonEventSet* eventSet)
                 continue;
             }
             RegisterIndex index = eventSet->events[i].index;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, counter_map[index].counterRegister , 0x0ULL));
             flags |= (1ULL<<(index));  /* enable counter */
         }
@@ -145,7 +145,7 @@ int perfmon_stopCountersThread_phi(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -155,17 +155,17 @@ int perfmon_stopCountersThread_phi(int thread_id, PerfmonEventSet* eventSet)
             counter_result = 0x0ULL;
             RegisterIndex index = eventSet->events[i].index;
             CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, phi_counter_map[index].counterRegister, &counter_result));
-            if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+            if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
             {
                 uint64_t ovf_values = 0x0ULL;
                 CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_MIC_PERF_GLOBAL_STATUS, &ovf_values));
                 if (ovf_values & (1ULL<<index))
                 {
-                    eventSet->events[i].threadCounter[thread_id].overflows++;
+                    THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                     CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_MIC_PERF_GLOBAL_OVF_CTRL, (1ULL<<index)));
                 }
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
         }
     }
     return 0;
@@ -183,7 +183,7 @@ int perfmon_readCountersThread_phi(int thread_id, PerfmonEventSet* eventSet)
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -193,17 +193,17 @@ int perfmon_readCountersThread_phi(int thread_id, PerfmonEventSet* eventSet)
             counter_result = 0x0ULL;
             RegisterIndex index = eventSet->events[i].index;
             CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter_map[i].counterRegister, &counter_result));
-            if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+            if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
             {
                 uint64_t ovf_values = 0x0ULL;
                 CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_MIC_PERF_GLOBAL_STATUS, &ovf_values));
                 if (ovf_values & (1ULL<<index))
                 {
-                    eventSet->events[i].threadCounter[thread_id].overflows++;
+                    THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                     CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_MIC_PERF_GLOBAL_OVF_CTRL, (1ULL<<index)));
                 }
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
         }
     }
 
@@ -229,7 +229,7 @@ int perfmon_finalizeCountersThread_phi(int thread_id, PerfmonEventSet* eventSet)
         ovf_values_core |= (1ULL<<(index));
         CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, counter_map[i].configRegister, 0x0ULL));
         CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, counter_map[i].counterRegister, 0x0ULL));
-        eventSet->events[i].threadCounter[thread_id].init = FALSE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
     }
     CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_MIC_PERF_GLOBAL_CTRL, 0x0ULL));
     CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_MIC_SPFLT_CONTROL, 0x0ULL));
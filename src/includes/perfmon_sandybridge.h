@@ -842,7 +842,7 @@ int perfmon_setupCounterThread_sandybridge(
         PerfmonEvent *event = &(eventSet->events[i].event);
         RegisterIndex index = eventSet->events[i].index;
         PciDeviceIndex dev = counter_map[index].device;
-        eventSet->events[i].threadCounter[thread_id].init = TRUE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         switch (type)
         {
             case PMC:
@@ -1027,7 +1027,7 @@ int perfmon_startCountersThread_sandybridge(int thread_id, PerfmonEventSet* even
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -1035,14 +1035,14 @@ int perfmon_startCountersThread_sandybridge(int thread_id, PerfmonEventSet* even
                 continue;
             }
             tmp = 0x0ULL;
-            eventSet->events[i].threadCounter[thread_id].startData = 0x0ULL;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0x0ULL;
             RegisterIndex index = eventSet->events[i].index;
             uint64_t reg = counter_map[index].configRegister;
             uint64_t counter1 = counter_map[index].counterRegister;
             uint64_t counter2 = counter_map[index].counterRegister2;
             PciDeviceIndex dev = counter_map[index].device;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             switch (type)
             {
                 case PMC:
@@ -1059,7 +1059,7 @@ int perfmon_startCountersThread_sandybridge(int thread_id, PerfmonEventSet* even
                     if(haveLock)
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&tmp));
-                        eventSet->events[i].threadCounter[thread_id].startData = tmp;
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = tmp;
                     }
                     break;
 
@@ -1082,7 +1082,7 @@ int perfmon_startCountersThread_sandybridge(int thread_id, PerfmonEventSet* even
                     {
                         tmp = 0x0ULL;
                         CHECK_PCI_READ_ERROR(HPMread(cpu_id, dev, counter1, &tmp));
-                        eventSet->events[i].threadCounter[thread_id].startData = tmp;
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = tmp;
                     }*/
                     break;
 
@@ -1138,13 +1138,13 @@ int perfmon_startCountersThread_sandybridge(int thread_id, PerfmonEventSet* even
                     if(haveLock)
                     {
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter1, &tmp));
-                        eventSet->events[i].threadCounter[thread_id].startData = field64(tmp, 0, box_map[WBOX0FIX].regWidth);
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = field64(tmp, 0, box_map[WBOX0FIX].regWidth);
                     }
                     break;
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = eventSet->events[i].threadCounter[thread_id].startData;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = THREADCOUNTER(eventSet, i, thread_id, startData);
         }
     }
 
@@ -1212,9 +1212,9 @@ int perfmon_startCountersThread_sandybridge(int thread_id, PerfmonEventSet* even
 // Check counter result for overflows. We do not handle overflows directly, that is done in the getResults function in perfmon.c
 // SandyBridge has no bits indicating that overflows occured, therefore we use this simple check
 #define SNB_CHECK_OVERFLOW \
-    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData) \
+    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData)) \
     { \
-        eventSet->events[i].threadCounter[thread_id].overflows++; \
+        THREADCOUNTER(eventSet, i, thread_id, overflows)++; \
     }
 
 
@@ -1269,7 +1269,7 @@ int perfmon_stopCountersThread_sandybridge(int thread_id, PerfmonEventSet* event
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -1286,13 +1286,13 @@ int perfmon_stopCountersThread_sandybridge(int thread_id, PerfmonEventSet* event
             {
                 case PMC:
                     CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter1, &counter_result));
-                    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                     {
                         uint64_t ovf_values = 0x0ULL;
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values));
                         if (ovf_values & (1ULL<<(index - cpuid_info.perf_num_fixed_ctr)))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL,
                                                         (1ULL<<(index - cpuid_info.perf_num_fixed_ctr))));
                         }
@@ -1302,13 +1302,13 @@ int perfmon_stopCountersThread_sandybridge(int thread_id, PerfmonEventSet* event
 
                 case FIXED:
                     CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter1, &counter_result));
-                    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                     {
                         uint64_t ovf_values = 0x0ULL;
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values));
                         if (ovf_values & (1ULL<<(index+32)))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL, (1ULL<<(index+32))));
                         }
                     }
@@ -1411,7 +1411,7 @@ int perfmon_stopCountersThread_sandybridge(int thread_id, PerfmonEventSet* event
                         {
                             counter_result = extractBitField(counter_result, 1, 4);
                         }
-                        eventSet->events[i].threadCounter[thread_id].startData = 0;
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
                         VERBOSEPRINTPCIREG(cpu_id, dev, counter1,  LLU_CAST counter_result, STOP_SBOXFIX);
                     }
                     break;
@@ -1494,7 +1494,7 @@ int perfmon_stopCountersThread_sandybridge(int thread_id, PerfmonEventSet* event
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData =
+            THREADCOUNTER(eventSet, i, thread_id, counterData) =
                     field64(counter_result, 0, box_map[type].regWidth);
         }
     }
@@ -1561,7 +1561,7 @@ int perfmon_readCountersThread_sandybridge(int thread_id, PerfmonEventSet* event
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -1579,13 +1579,13 @@ int perfmon_readCountersThread_sandybridge(int thread_id, PerfmonEventSet* event
                 case PMC:
                     CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter1, &counter_result));
                     VERBOSEPRINTPCIREG(cpu_id, dev, counter1,  LLU_CAST counter_result, READ_PMC);
-                    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                     {
                         uint64_t ovf_values = 0x0ULL;
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values));
                         if (ovf_values & (1ULL<<(index - cpuid_info.perf_num_fixed_ctr)))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL,
                                                         (1ULL<<(index - cpuid_info.perf_num_fixed_ctr))));
                         }
@@ -1595,13 +1595,13 @@ int perfmon_readCountersThread_sandybridge(int thread_id, PerfmonEventSet* event
                 case FIXED:
                     CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter1, &counter_result));
                     VERBOSEPRINTPCIREG(cpu_id, dev, counter1,  LLU_CAST counter_result, READ_FIXED);
-                    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                     {
                         uint64_t ovf_values = 0x0ULL;
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values));
                         if (ovf_values & (1ULL<<(index+32)))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL, (1ULL<<(index+32))));
                         }
                     }
@@ -1749,7 +1749,7 @@ int perfmon_readCountersThread_sandybridge(int thread_id, PerfmonEventSet* event
                     {
                         counter_result = extractBitField(counter_result, 1, 4);
                     }
-                    eventSet->events[i].threadCounter[thread_id].startData = 0x0ULL;
+                    THREADCOUNTER(eventSet, i, thread_id, startData) = 0x0ULL;
                     VERBOSEPRINTPCIREG(cpu_id, dev, counter1,  LLU_CAST counter_result, READ_SBOXFIX);
                     break;
 
@@ -1783,7 +1783,7 @@ int perfmon_readCountersThread_sandybridge(int thread_id, PerfmonEventSet* event
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData =
+            THREADCOUNTER(eventSet, i, thread_id, counterData) =
                     field64(counter_result, 0, box_map[type].regWidth);
         }
     }
@@ -1900,7 +1900,7 @@ int perfmon_finalizeCountersThread_sandybridge(int thread_id, PerfmonEventSet* e
                     CHECK_PCI_WRITE_ERROR(HPMwrite(cpu_id, dev, counter_map[index].counterRegister2, 0x0ULL));
             }
         }
-        eventSet->events[i].threadCounter[thread_id].init = FALSE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
     }
 
     if (haveLock && MEASURE_UNCORE(eventSet))
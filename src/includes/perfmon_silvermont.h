@@ -189,7 +189,7 @@ int perfmon_setupCountersThread_silvermont(
         flags = 0x0ULL;
         RegisterIndex index = eventSet->events[i].index;
         PerfmonEvent *event = &(eventSet->events[i].event);
-        eventSet->events[i].threadCounter[thread_id].init = TRUE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = TRUE;
         switch (type)
         {
             case PMC:
@@ -232,7 +232,7 @@ int perfmon_startCountersThread_silvermont(int thread_id, PerfmonEventSet* event
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -242,8 +242,8 @@ int perfmon_startCountersThread_silvermont(int thread_id, PerfmonEventSet* event
             tmp = 0x0ULL;
             RegisterIndex index = eventSet->events[i].index;
             uint64_t counter1 = counter_map[index].counterRegister;
-            eventSet->events[i].threadCounter[thread_id].startData = 0;
-            eventSet->events[i].threadCounter[thread_id].counterData = 0;
+            THREADCOUNTER(eventSet, i, thread_id, startData) = 0;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = 0;
             switch (type)
             {
                 case PMC:
@@ -260,14 +260,14 @@ int perfmon_startCountersThread_silvermont(int thread_id, PerfmonEventSet* event
                     if(haveLock)
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&tmp));
-                        eventSet->events[i].threadCounter[thread_id].startData = field64(tmp, 0, box_map[type].regWidth);
+                        THREADCOUNTER(eventSet, i, thread_id, startData) = field64(tmp, 0, box_map[type].regWidth);
                     }
                     break;
 
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = eventSet->events[i].threadCounter[thread_id].startData;
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = THREADCOUNTER(eventSet, i, thread_id, startData);
         }
     }
 
@@ -301,7 +301,7 @@ int perfmon_stopCountersThread_silvermont(int thread_id, PerfmonEventSet* eventS
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE) 
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE) 
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -315,13 +315,13 @@ int perfmon_stopCountersThread_silvermont(int thread_id, PerfmonEventSet* eventS
             {
                 case PMC:
                     CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter1, &counter_result));
-                    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                     {
                         uint64_t ovf_values = 0x0ULL;
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values));
                         if (ovf_values & (1ULL<<(index - cpuid_info.perf_num_fixed_ctr)))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL,
                                                     (1ULL<<(index - cpuid_info.perf_num_fixed_ctr))));
                         }
@@ -329,13 +329,13 @@ int perfmon_stopCountersThread_silvermont(int thread_id, PerfmonEventSet* eventS
                     break;
                 case FIXED:
                     CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter1, &counter_result));
-                    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                     {
                         uint64_t ovf_values = 0x0ULL;
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values));
                         if (ovf_values & (1ULL<<(index + 32)))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL, (1ULL<<(index + 32))));
                         }
                     }
@@ -345,9 +345,9 @@ int perfmon_stopCountersThread_silvermont(int thread_id, PerfmonEventSet* eventS
                     if(haveLock)
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&counter_result));
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
                     }
                     break;
@@ -359,7 +359,7 @@ int perfmon_stopCountersThread_silvermont(int thread_id, PerfmonEventSet* eventS
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
         }
     }
     return 0;
@@ -386,7 +386,7 @@ int perfmon_readCountersThread_silvermont(int thread_id, PerfmonEventSet* eventS
 
     for (int i=0;i < eventSet->numberOfEvents;i++)
     {
-        if (eventSet->events[i].threadCounter[thread_id].init == TRUE)
+        if (THREADCOUNTER(eventSet, i, thread_id, init) == TRUE)
         {
             RegisterType type = eventSet->events[i].type;
             if (!TESTTYPE(eventSet, type))
@@ -400,13 +400,13 @@ int perfmon_readCountersThread_silvermont(int thread_id, PerfmonEventSet* eventS
             {
                 case PMC:
                     CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter1, &counter_result));
-                    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                     {
                         uint64_t ovf_values = 0x0ULL;
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values));
                         if (ovf_values & (1ULL<<(index - cpuid_info.perf_num_fixed_ctr)))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL,
                                                     (1ULL<<(index - cpuid_info.perf_num_fixed_ctr))));
                         }
@@ -414,13 +414,13 @@ int perfmon_readCountersThread_silvermont(int thread_id, PerfmonEventSet* eventS
                     break;
                 case FIXED:
                     CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, counter1, &counter_result));
-                    if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                    if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                     {
                         uint64_t ovf_values = 0x0ULL;
                         CHECK_MSR_READ_ERROR(HPMread(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_STATUS, &ovf_values));
                         if (ovf_values & (1ULL<<(index + 32)))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                             CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, MSR_DEV, MSR_PERF_GLOBAL_OVF_CTRL, (1ULL<<(index + 32))));
                         }
                     }
@@ -430,9 +430,9 @@ int perfmon_readCountersThread_silvermont(int thread_id, PerfmonEventSet* eventS
                     if(haveLock)
                     {
                         CHECK_POWER_READ_ERROR(power_read(cpu_id, counter1, (uint32_t*)&counter_result));
-                        if (counter_result < eventSet->events[i].threadCounter[thread_id].counterData)
+                        if (counter_result < THREADCOUNTER(eventSet, i, thread_id, counterData))
                         {
-                            eventSet->events[i].threadCounter[thread_id].overflows++;
+                            THREADCOUNTER(eventSet, i, thread_id, overflows)++;
                         }
                     }
                     break;
@@ -444,7 +444,7 @@ int perfmon_readCountersThread_silvermont(int thread_id, PerfmonEventSet* eventS
                 default:
                     break;
             }
-            eventSet->events[i].threadCounter[thread_id].counterData = field64(counter_result, 0, box_map[type].regWidth);
+            THREADCOUNTER(eventSet, i, thread_id, counterData) = field64(counter_result, 0, box_map[type].regWidth);
         }
     }
     if (MEASURE_CORE(eventSet))
@@ -518,7 +518,7 @@ int perfmon_finalizeCountersThread_silvermont(int thread_id, PerfmonEventSet* ev
                 CHECK_MSR_WRITE_ERROR(HPMwrite(cpu_id, dev, counter_map[index].counterRegister2, 0x0ULL));
             }
         }
-        eventSet->events[i].threadCounter[thread_id].init = FALSE;
+        THREADCOUNTER(eventSet, i, thread_id, init) = FALSE;
     }
     if (MEASURE_CORE(eventSet))
     {
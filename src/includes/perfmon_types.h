@@ -174,22 +174,36 @@ typedef struct {
     PerfmonEventOption options[NUM_EVENT_OPTIONS]; /*!< \brief List of options */
 } PerfmonEvent;
 
-/*! \brief Structure describing performance monitoring counter data
+/*! \brief Structure holding the performance monitoring counter data of an eventSet
 
-Each event holds one of these structures for each thread to store the counter
-data, if it is configured and the amount of happened overflows.
-\extends PerfmonEventSetEntry
+The counter data of all events and threads is stored as a structure of arrays.
+Each array holds \a stride entries per thread, one for each event of the eventSet.
+The blocks of the threads start at cache line boundaries, so reading the counters
+touches only a few cache lines and threads reading concurrently do not share lines.
+Use THREADCOUNTER() to access the data of one event and thread.
+\extends PerfmonEventSet
 */
 typedef struct {
-    int         init; /*!< \brief Flag if corresponding control register is set up properly */
-    int         id; /*!< \brief Offset in higher level control register, e.g. position of enable bit */
-    int         overflows; /*!< \brief Amount of overflows */
-    uint64_t    startData; /*!< \brief Start data from the counter */
-    uint64_t    counterData; /*!< \brief Intermediate data from the counters */
-    double      lastResult; /*!< \brief Last measurement result*/
-    double      fullResult; /*!< \brief Aggregated measurement result */
+    int         stride; /*!< \brief Number of entries per thread in each array, multiple of PERFMON_COUNTER_ALIGN */
+    int*        init; /*!< \brief Flags if corresponding control register is set up properly */
+    int*        overflows; /*!< \brief Amount of overflows */
+    uint64_t*   foldedOverflows; /*!< \brief Overflows already accounted by intermediate reads since the counters were started */
+    uint64_t*   startData; /*!< \brief Start data from the counters */
+    uint64_t*   counterData; /*!< \brief Intermediate data from the counters */
+    double*     lastResult; /*!< \brief Last measurement results */
+    double*     fullResult; /*!< \brief Aggregated measurement results */
+    double*     maxValue; /*!< \brief Maximal counter value of each event, only first block */
+    double*     multiplier; /*!< \brief Multiplier of each event, e.g. energy unit, only first block */
+    int*        isState; /*!< \brief Flags if the event reports a state like the temperature instead of a count, only first block */
 } PerfmonCounter;
 
+/** \brief Alignment of thread blocks in PerfmonCounter arrays in number of entries */
+#define PERFMON_COUNTER_ALIGN 16
+
+/** \brief Access the counter data \a field of event \a eventId and thread \a threadId of an eventSet */
+#define THREADCOUNTER(eventSet, eventId, threadId, field) \
+        ((eventSet)->counters.field[(threadId)*(eventSet)->counters.stride+(eventId)])
+
 
 /*! \brief Structure specifying an performance monitoring event
 
@@ -200,7 +214,6 @@ typedef struct {
     PerfmonEvent        event; /*!< \brief Event configuration */
     RegisterIndex       index; /*!< \brief Index of the counter register in the counter map */
     RegisterType        type; /*!< \brief Type of the counter register and event */
-    PerfmonCounter*     threadCounter; /*!< \brief List of counter data for each thread, list length is \a numberOfThreads in PerfmonGroupSet */
 } PerfmonEventSetEntry;
 
 /*! \brief Structure specifying an performance monitoring event group
@@ -211,6 +224,7 @@ A PerfmonEventSet holds a set of event and counter combinations and some global
 typedef struct {
     int                   numberOfEvents; /*!< \brief Number of eventSets in \a events */
     PerfmonEventSetEntry* events; /*!< \brief List of eventSets */
+    PerfmonCounter        counters; /*!< \brief Counter data of all events and threads */
     TimerData             timer; /*!< \brief Time information how long the counters were running */
     double                rdtscTime; /*!< \brief Evaluation of the Time information in seconds */
     double                runTime; /*!< \brief Sum of all time information in seconds that the group was running */
@@ -219,6 +233,7 @@ typedef struct {
     uint64_t              regTypeMask3; /*!< \brief Bitmask3 for easy checks which types are included in the eventSet */
     uint64_t              regTypeMask4; /*!< \brief Bitmask4 for easy checks which types are included in the eventSet */
     GroupState            state; /*!< \brief Current state of the event group (configured, started, none) */
+    uint64_t              startCount; /*!< \brief How often the event group was started, snapshots of different starts cannot be compared */
     GroupInfo             group; /*!< \brief Structure holding the performance group information */
 } PerfmonEventSet;
 
@@ -38,32 +38,37 @@
 #include <error.h>
 #include <access.h>
 
-const char* power_names[NUM_POWER_DOMAINS] = {"PKG", "PP0", "PP1", "DRAM"};
+const char* power_names[NUM_POWER_DOMAINS] = {"PKG", "PP0", "PP1", "DRAM", "PLATFORM"};
 
 uint32_t power_regs[NUM_POWER_DOMAINS] = {MSR_PKG_ENERGY_STATUS,
                                 MSR_PP0_ENERGY_STATUS,
                                 MSR_PP1_ENERGY_STATUS,
-                                MSR_DRAM_ENERGY_STATUS};
+                                MSR_DRAM_ENERGY_STATUS,
+                                MSR_PLATFORM_ENERGY_STATUS};
 
 uint32_t limit_regs[NUM_POWER_DOMAINS] = {MSR_PKG_RAPL_POWER_LIMIT,
                                 MSR_PP0_RAPL_POWER_LIMIT,
                                 MSR_PP1_RAPL_POWER_LIMIT,
-                                MSR_DRAM_RAPL_POWER_LIMIT};
+                                MSR_DRAM_RAPL_POWER_LIMIT,
+                                MSR_PLATFORM_POWER_LIMIT};
 
 uint32_t policy_regs[NUM_POWER_DOMAINS] = {0,
                                 MSR_PP0_ENERGY_POLICY,
                                 MSR_PP1_ENERGY_POLICY,
+                                0,
                                 0};
 
 uint32_t perf_regs[NUM_POWER_DOMAINS] = {MSR_PKG_PERF_STATUS,
                                 MSR_PP0_PERF_STATUS,
                                 0,
-                                MSR_DRAM_PERF_STATUS};
+                                MSR_DRAM_PERF_STATUS,
+                                0};
 
 uint32_t info_regs[NUM_POWER_DOMAINS] = {MSR_PKG_POWER_INFO,
                                 0,
                                 0,
-                                MSR_DRAM_POWER_INFO};
+                                MSR_DRAM_POWER_INFO,
+                                0};
 
 
 double
@@ -199,6 +204,31 @@ power_tread(int socket_fd, int cpuId, uint64_t reg, uint32_t *data)
     }
 }
 
+int
+power_readDomains(int cpuId, uint32_t *data)
+{
+    int i;
+    int count = 0;
+    uint64_t result = 0;
+
+    if (!power_info.hasRAPL)
+    {
+        DEBUG_PLAIN_PRINT(DEBUGLEV_DEVELOP, No RAPL support);
+        return -EIO;
+    }
+    for (i = 0; i < NUM_POWER_DOMAINS; i++)
+    {
+        data[i] = 0;
+        if (power_info.domains[i].supportFlags & POWER_DOMAIN_SUPPORT_STATUS)
+        {
+            CHECK_MSR_READ_ERROR(HPMread(cpuId, MSR_DEV, power_regs[i], &result))
+            data[i] = field64(result, 0, 32);
+            count++;
+        }
+    }
+    return count;
+}
+
 double
 power_getEnergyUnit(int domain)
 {
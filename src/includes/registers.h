@@ -1895,6 +1895,7 @@
 #define MSR_TURBO_RATIO_LIMIT3          0x1AC
 
 /* MISC Intel register */
+#define MSR_TIME_STAMP_COUNTER          0x10
 #define MSR_MPERF                       0xE7
 #define MSR_APERF                       0xE8
 #define MSR_PPERF                       0x64E
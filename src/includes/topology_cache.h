@@ -0,0 +1,98 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  topology_cache.h
+ *
+ *      Description:  Header File of the cached hardware topology snapshot
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Roehl (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef TOPOLOGY_CACHE_H
+#define TOPOLOGY_CACHE_H
+
+#include <stdint.h>
+#include <likwid.h>
+
+#define TOPOLOGY_CACHE_MAGIC "LIKWIDTC"
+#define TOPOLOGY_CACHE_VERSION 1
+
+/* The snapshot is a single file that is mapped into memory. All references
+ * inside the file are byte offsets from the start of the file. */
+typedef struct {
+    char bootId[40];
+    char kernelRelease[65];
+    char kernelVersion[65];
+    uint32_t numHWThreads;
+} TopologyCacheFingerprint;
+
+typedef struct {
+    uint32_t id;
+    uint32_t numberOfProcessors;
+    uint32_t numberOfDistances;
+    uint64_t totalMemory;
+    uint64_t freeMemory;
+    uint64_t processorsOffset;
+    uint64_t distancesOffset;
+} TopologyCacheNode;
+
+typedef struct {
+    char tag[16];
+    uint32_t numberOfProcessors;
+    uint32_t numberOfCores;
+    uint64_t processorListOffset;
+} TopologyCacheDomain;
+
+typedef struct {
+    uint16_t vendorId;
+    uint16_t deviceId;
+    uint32_t bus;
+} TopologyCachePciDevice;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t fileSize;
+    TopologyCacheFingerprint fingerprint;
+    CpuInfo cpuInfo; /* pointers are not valid */
+    CpuTopology cpuTopology; /* pointers are not valid */
+    uint64_t osnameOffset;
+    uint64_t featuresOffset;
+    uint64_t threadPoolOffset;
+    uint64_t cacheLevelsOffset;
+    uint32_t numberOfNodes;
+    uint64_t nodesOffset;
+    AffinityDomains affinity; /* pointers are not valid */
+    uint64_t domainsOffset;
+    uint32_t numberOfPciDevices;
+    uint64_t pciDevicesOffset;
+} TopologyCacheHeader;
+
+extern int topology_cache_load(void);
+extern int topology_cache_isLoaded(void);
+extern int topology_cache_loadAffinity(AffinityDomains* affinity);
+extern int topology_cache_store(const AffinityDomains* affinity);
+extern int topology_cache_getPciBuses(uint16_t vendorId, uint16_t deviceId, char** socket_bus, int* nrSockets);
+extern void topology_cache_finalize(void);
+
+#endif /* TOPOLOGY_CACHE_H */
@@ -60,14 +60,13 @@ int core_lock[MAX_NUM_THREADS];
 static int likwid_init = 0;
 static int numberOfGroups = 0;
 static int* groups;
-static int threads2Cpu[MAX_NUM_THREADS];
-static pthread_t threads2Pthread[MAX_NUM_THREADS];
-static int realThreads2Cpu[MAX_NUM_THREADS] = { [ 0 ... (MAX_NUM_THREADS-1)] = -1};
+static int* threads2Cpu = NULL;
 static int num_cpus = 0;
 static int registered_cpus = 0;
 static pthread_mutex_t globalLock = PTHREAD_MUTEX_INITIALIZER;
 static int use_locks = 0;
-static pthread_mutex_t threadLocks[MAX_NUM_THREADS] = { [ 0 ... (MAX_NUM_THREADS-1)] = PTHREAD_MUTEX_INITIALIZER};
+static int numThreadLocks = 0;
+static pthread_mutex_t* threadLocks = NULL;
 
 
 /* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
@@ -83,7 +82,7 @@ getProcessorID(cpu_set_t* cpu_set)
 {
     int processorId;
 
-    for (processorId=0;processorId<MAX_NUM_THREADS;processorId++)
+    for (processorId=0;processorId<CPU_SETSIZE;processorId++)
     {
         if (CPU_ISSET(processorId,cpu_set))
         {
@@ -191,6 +190,14 @@ likwid_markerInit(void)
     bThreadStr = bfromcstr(cThreadStr);
     threadTokens = bsplit(bThreadStr,',');
     num_cpus = threadTokens->qty;
+    threads2Cpu = (int*) malloc(num_cpus * sizeof(int));
+    if (!threads2Cpu)
+    {
+        fprintf(stderr,"Cannot allocate space for thread list.\n");
+        bstrListDestroy(threadTokens);
+        bdestroy(bThreadStr);
+        exit(EXIT_FAILURE);
+    }
     for (i=0; i<num_cpus; i++)
     {
         threads2Cpu[i] = ownatoi(bdata(threadTokens->entry[i]));
@@ -216,6 +223,25 @@ likwid_markerInit(void)
             }
         }
     }
+    if (use_locks == 1)
+    {
+        /* Indexed by OS CPU id, numHWThreads only counts the CPUs of the cpuset */
+        numThreadLocks = sysconf(_SC_NPROCESSORS_CONF);
+        if (numThreadLocks < (int)cpuid_topology.numHWThreads)
+        {
+            numThreadLocks = cpuid_topology.numHWThreads;
+        }
+        threadLocks = (pthread_mutex_t*) malloc(numThreadLocks * sizeof(pthread_mutex_t));
+        if (!threadLocks)
+        {
+            fprintf(stderr,"Cannot allocate space for thread locks.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (i=0; i<numThreadLocks; i++)
+        {
+            pthread_mutex_init(&threadLocks[i], NULL);
+        }
+    }
 
     i = perfmon_init(num_cpus, threads2Cpu);
     if (i<0)
@@ -246,7 +272,7 @@ likwid_markerInit(void)
         hashTable_initThread(threads2Cpu[i]);
         for(int j=0; j<groupSet->groups[groups[0]].numberOfEvents;j++)
         {
-            groupSet->groups[groups[0]].events[j].threadCounter[i].init = TRUE;
+            THREADCOUNTER(&groupSet->groups[groups[0]], j, i, init) = TRUE;
             groupSet->groups[groups[0]].state = STATE_START;
         }
     }
@@ -418,6 +444,21 @@ void __attribute__((destructor (101))) likwid_markerCloseDestruct(void)
     {
         free(results);
     }
+    if (threadLocks != NULL)
+    {
+        for (int i=0; i<numThreadLocks; i++)
+        {
+            pthread_mutex_destroy(&threadLocks[i]);
+        }
+        free(threadLocks);
+        threadLocks = NULL;
+        numThreadLocks = 0;
+    }
+    if (threads2Cpu != NULL)
+    {
+        free(threads2Cpu);
+        threads2Cpu = NULL;
+    }
     likwid_init = 0;
     HPMfinalize();
 }
@@ -437,6 +478,10 @@ likwid_markerRegisterRegion(const char* regionTag)
     bcatcstr(tag, groupSuffix);
     int cpu_id = hashTable_get(tag, &results);
     bdestroy(tag);
+    if (cpu_id < 0)
+    {
+        return cpu_id;
+    }
 #ifdef LIKWID_USE_PERFEVENT
     return HPMaddThread(cpu_id);
 #else
@@ -471,12 +516,12 @@ likwid_markerStartRegion(const char* regionTag)
     {
         DEBUG_PRINT(DEBUGLEV_DEVELOP, START [%s] READ EVENT [%d=%d] EVENT %d VALUE %llu,
                 regionTag, thread_id, cpu_id, i,
-                LLU_CAST groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].counterData);
-        //groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].startData =
-        //        groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].counterData;
+                LLU_CAST THREADCOUNTER(&groupSet->groups[groupSet->activeGroup], i, thread_id, counterData));
+        //THREADCOUNTER(&groupSet->groups[groupSet->activeGroup], i, thread_id, startData) =
+        //        THREADCOUNTER(&groupSet->groups[groupSet->activeGroup], i, thread_id, counterData);
 
-        results->StartPMcounters[i] = groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].counterData;
-        results->StartOverflows[i] = groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].overflows;
+        results->StartPMcounters[i] = THREADCOUNTER(&groupSet->groups[groupSet->activeGroup], i, thread_id, counterData);
+        results->StartOverflows[i] = THREADCOUNTER(&groupSet->groups[groupSet->activeGroup], i, thread_id, overflows);
     }
 
     bdestroy(tag);
@@ -507,6 +552,11 @@ likwid_markerStopRegion(const char* regionTag)
     LikwidThreadResults* results;
     sprintf(groupSuffix, "-%d", groupSet->activeGroup);
     bcatcstr(tag, groupSuffix);
+    if ((use_locks == 1) && ((myCPU < 0) || (myCPU >= numThreadLocks)))
+    {
+        bdestroy(tag);
+        return -EFAULT;
+    }
     if (use_locks == 1)
     {
         pthread_mutex_lock(&threadLocks[myCPU]);
@@ -525,10 +575,10 @@ likwid_markerStopRegion(const char* regionTag)
     for(int i=0;i<groupSet->groups[groupSet->activeGroup].numberOfEvents;i++)
     {
         DEBUG_PRINT(DEBUGLEV_DEVELOP, STOP [%s] READ EVENT [%d=%d] EVENT %d VALUE %llu, regionTag, thread_id, cpu_id, i,
-                        LLU_CAST groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].counterData);
+                        LLU_CAST THREADCOUNTER(&groupSet->groups[groupSet->activeGroup], i, thread_id, counterData));
         result = calculateMarkerResult(groupSet->groups[groupSet->activeGroup].events[i].index, results->StartPMcounters[i],
-                                        groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].counterData,
-                                        groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].overflows -
+                                        THREADCOUNTER(&groupSet->groups[groupSet->activeGroup], i, thread_id, counterData),
+                                        THREADCOUNTER(&groupSet->groups[groupSet->activeGroup], i, thread_id, overflows) -
                                         results->StartOverflows[i]);
         if (counter_map[groupSet->groups[groupSet->activeGroup].events[i].index].type != THERMAL)
         {
@@ -572,6 +622,14 @@ likwid_markerGetRegion(
     bcatcstr(tag, groupSuffix);
 
     cpu_id = hashTable_get(tag, &results);
+    if (cpu_id < 0)
+    {
+        *nr_events = 0;
+        *time = 0;
+        *count = 0;
+        bdestroy(tag);
+        return;
+    }
     thread_id = getThreadID(myCPU);
     *count = results->count;
     *time = results->time;
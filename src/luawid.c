@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 #include <unistd.h>
 #include <sys/wait.h>
 #include <sys/types.h>
@@ -65,6 +66,9 @@ static int timer_isInitialized = 0;
 static int power_isInitialized = 0;
 static int power_hasRAPL = 0;
 static int config_isInitialized = 0;
+static int effclock_count = 0;
+static int* effclock_cpus = NULL;
+static FreqSample* effclock_samples = NULL;
 
 /* #####   VARIABLES  -  EXPORTED VARIABLES   ############################# */
 
@@ -320,6 +324,33 @@ lua_likwid_stopCounters(lua_State* L)
     return 1;
 }
 
+static int
+lua_likwid_startOverflowGuard(lua_State* L)
+{
+    int ret;
+    if (perfmon_isInitialized == 0)
+    {
+        return 0;
+    }
+    ret = perfmon_startOverflowGuard();
+    lua_pushinteger(L,ret);
+    lua_pushnumber(L,perfmon_getOverflowGuardPeriod());
+    return 2;
+}
+
+static int
+lua_likwid_stopOverflowGuard(lua_State* L)
+{
+    int ret;
+    if (perfmon_isInitialized == 0)
+    {
+        return 0;
+    }
+    ret = perfmon_stopOverflowGuard();
+    lua_pushinteger(L,ret);
+    return 1;
+}
+
 static int
 lua_likwid_readCounters(lua_State* L)
 {
@@ -1613,7 +1644,7 @@ lua_likwid_startPower(lua_State* L)
 #else
     PowerType type = (PowerType) ((lua_Unsigned)lua_tointegerx(L,2, NULL));
 #endif
-    luaL_argcheck(L, type >= PKG+1 && type <= DRAM+1, 2, "Type not valid");
+    luaL_argcheck(L, type >= PKG+1 && type <= PLATFORM+1, 2, "Type not valid");
     power_start(&pwrdata, cpuId, type-1);
     lua_pushnumber(L,pwrdata.before);
     return 1;
@@ -1630,12 +1661,34 @@ lua_likwid_stopPower(lua_State* L)
 #else
     PowerType type = (PowerType) ((lua_Unsigned)lua_tointegerx(L,2, NULL));
 #endif
-    luaL_argcheck(L, type >= PKG+1 && type <= DRAM+1, 2, "Type not valid");
+    luaL_argcheck(L, type >= PKG+1 && type <= PLATFORM+1, 2, "Type not valid");
     power_stop(&pwrdata, cpuId, type-1);
     lua_pushnumber(L,pwrdata.after);
     return 1;
 }
 
+static int
+lua_likwid_readPowerDomains(lua_State* L)
+{
+    int i;
+    uint32_t data[NUM_POWER_DOMAINS];
+    int cpuId = lua_tonumber(L,1);
+    luaL_argcheck(L, cpuId >= 0, 1, "CPU ID must be greater than 0");
+    if (power_readDomains(cpuId, data) < 0)
+    {
+        lua_pushnil(L);
+        return 1;
+    }
+    lua_newtable(L);
+    for (i = 0; i < NUM_POWER_DOMAINS; i++)
+    {
+        lua_pushinteger(L, i+1);
+        lua_pushnumber(L, data[i]);
+        lua_settable(L,-3);
+    }
+    return 1;
+}
+
 static int
 lua_likwid_printEnergy(lua_State* L)
 {
@@ -2010,6 +2063,54 @@ lua_likwid_memSweepDomain(lua_State* L)
     return 0;
 }
 
+static int
+lua_likwid_getPagePlacement(lua_State* L)
+{
+    int pid = luaL_checknumber(L,1);
+    uintptr_t address = (uintptr_t) luaL_checknumber(L,2);
+    size_t size = (size_t) luaL_checknumber(L,3);
+    uint64_t* counts = NULL;
+    int pages = 0;
+    luaL_argcheck(L, pid >= 0, 1, "PID must be greater or equal 0");
+    luaL_argcheck(L, size > 0, 3, "Size must be greater than 0");
+    if (topology_isInitialized == 0)
+    {
+        topology_init();
+        topology_isInitialized = 1;
+        cpuinfo = get_cpuInfo();
+        cputopo = get_cpuTopology();
+    }
+    if (numa_isInitialized == 0)
+    {
+        numa_init();
+        numa_isInitialized = 1;
+        numainfo = get_numaTopology();
+    }
+    counts = (uint64_t*) malloc(numa_info.numberOfNodes * sizeof(uint64_t));
+    if (counts == NULL)
+    {
+        lua_pushnil(L);
+        return 1;
+    }
+    pages = numa_getProcessPagePlacement(pid, (void*)address, size, counts);
+    if (pages < 0)
+    {
+        free(counts);
+        lua_pushnil(L);
+        return 1;
+    }
+    lua_pushinteger(L, pages);
+    lua_newtable(L);
+    for (uint32_t i = 0; i < numa_info.numberOfNodes; i++)
+    {
+        lua_pushinteger(L, i+1);
+        lua_pushnumber(L, (double)counts[i]);
+        lua_settable(L,-3);
+    }
+    free(counts);
+    return 2;
+}
+
 static int
 lua_likwid_pinProcess(lua_State* L)
 {
@@ -2488,6 +2589,151 @@ lua_likwid_getDriver(lua_State* L)
     return 1;
 }
 
+static int
+lua_likwid_setFreqList(lua_State* L)
+{
+    int i, ret;
+    int nrThreads = 0;
+    uint64_t min = 0, max = 0, cur = 0;
+    const char* gov = NULL;
+    if (!lua_istable(L, 1)) {
+      lua_pushstring(L,"No table given as first argument");
+      lua_error(L);
+    }
+#if LUA_VERSION_NUM == 501
+    nrThreads = lua_objlen(L, 1);
+#else
+    nrThreads = lua_rawlen(L, 1);
+#endif
+    luaL_argcheck(L, nrThreads > 0, 1, "CPU list must not be empty");
+    int cpus[nrThreads];
+    for (i = 1; i <= nrThreads; i++)
+    {
+        lua_rawgeti(L,1,i);
+#if LUA_VERSION_NUM == 501
+        cpus[i-1] = ((lua_Integer)lua_tointeger(L,-1));
+#else
+        cpus[i-1] = ((lua_Unsigned)lua_tointegerx(L,-1, NULL));
+#endif
+        lua_pop(L,1);
+    }
+    if (!lua_isnoneornil(L, 2))
+        min = (uint64_t)luaL_checknumber(L, 2);
+    if (!lua_isnoneornil(L, 3))
+        max = (uint64_t)luaL_checknumber(L, 3);
+    if (!lua_isnoneornil(L, 4))
+        cur = (uint64_t)luaL_checknumber(L, 4);
+    if (!lua_isnoneornil(L, 5))
+        gov = luaL_checkstring(L, 5);
+    ret = freq_setList(nrThreads, cpus, min, max, cur, gov);
+    lua_pushinteger(L, ret);
+    return 1;
+}
+
+static int
+lua_likwid_finalizeEffectiveClock(lua_State* L)
+{
+    if (effclock_cpus)
+    {
+        free(effclock_cpus);
+        effclock_cpus = NULL;
+    }
+    if (effclock_samples)
+    {
+        free(effclock_samples);
+        effclock_samples = NULL;
+    }
+    effclock_count = 0;
+    return 0;
+}
+
+static int
+lua_likwid_initEffectiveClock(lua_State* L)
+{
+    int i, ret;
+    int nrThreads = luaL_checknumber(L,1);
+    luaL_argcheck(L, nrThreads > 0, 1, "CPU count must be greater than 0");
+    if (!lua_istable(L, -1)) {
+      lua_pushstring(L,"No table given as second argument");
+      lua_error(L);
+    }
+    if (topology_isInitialized == 0)
+    {
+        topology_init();
+        topology_isInitialized = 1;
+        cpuinfo = get_cpuInfo();
+        cputopo = get_cpuTopology();
+    }
+    lua_likwid_finalizeEffectiveClock(L);
+    effclock_cpus = (int*) malloc(nrThreads * sizeof(int));
+    /* Two samples per CPU, the last and the current one */
+    effclock_samples = (FreqSample*) malloc(2 * nrThreads * sizeof(FreqSample));
+    if ((!effclock_cpus) || (!effclock_samples))
+    {
+        lua_likwid_finalizeEffectiveClock(L);
+        lua_pushinteger(L, -ENOMEM);
+        return 1;
+    }
+    for (i = 1; i <= nrThreads; i++)
+    {
+        lua_rawgeti(L,-1,i);
+#if LUA_VERSION_NUM == 501
+        effclock_cpus[i-1] = ((lua_Integer)lua_tointeger(L,-1));
+#else
+        effclock_cpus[i-1] = ((lua_Unsigned)lua_tointegerx(L,-1, NULL));
+#endif
+        lua_pop(L,1);
+    }
+    ret = freq_initSampler(nrThreads, effclock_cpus);
+    if (ret == 0)
+    {
+        ret = freq_readSamples(nrThreads, effclock_cpus, effclock_samples);
+    }
+    if (ret < 0)
+    {
+        lua_likwid_finalizeEffectiveClock(L);
+        lua_pushinteger(L, ret);
+        return 1;
+    }
+    effclock_count = nrThreads;
+    lua_pushinteger(L, 0);
+    return 1;
+}
+
+static int
+lua_likwid_readEffectiveClock(lua_State* L)
+{
+    int i;
+    FreqSample* last = effclock_samples;
+    FreqSample* cur = effclock_samples + effclock_count;
+    if (effclock_count == 0)
+    {
+        lua_pushnil(L);
+        return 1;
+    }
+    if (freq_readSamples(effclock_count, effclock_cpus, cur) < 0)
+    {
+        lua_pushnil(L);
+        return 1;
+    }
+    lua_newtable(L);
+    for (i = 0; i < effclock_count; i++)
+    {
+        lua_pushinteger(L, i+1);
+        lua_pushnumber(L, freq_getEffectiveClock(&last[i], &cur[i]));
+        lua_settable(L,-3);
+    }
+    lua_newtable(L);
+    for (i = 0; i < effclock_count; i++)
+    {
+        lua_pushinteger(L, i+1);
+        lua_pushnumber(L, freq_getC0Residency(&last[i], &cur[i]));
+        lua_settable(L,-3);
+    }
+    memcpy(last, cur, effclock_count * sizeof(FreqSample));
+    return 2;
+}
+
 static int
 lua_likwid_getuid(lua_State* L)
 {
@@ -2614,6 +2860,8 @@ luaopen_liblikwid(lua_State* L){
     lua_register(L, "likwid_startCounters",lua_likwid_startCounters);
     lua_register(L, "likwid_stopCounters",lua_likwid_stopCounters);
     lua_register(L, "likwid_readCounters",lua_likwid_readCounters);
+    lua_register(L, "likwid_startOverflowGuard",lua_likwid_startOverflowGuard);
+    lua_register(L, "likwid_stopOverflowGuard",lua_likwid_stopOverflowGuard);
     lua_register(L, "likwid_switchGroup",lua_likwid_switchGroup);
     lua_register(L, "likwid_finalize",lua_likwid_finalize);
     lua_register(L, "likwid_getEventsAndCounters", lua_likwid_getEventsAndCounters);
@@ -2664,6 +2912,7 @@ luaopen_liblikwid(lua_State* L){
     lua_register(L, "likwid_startPower",lua_likwid_startPower);
     lua_register(L, "likwid_stopPower",lua_likwid_stopPower);
     lua_register(L, "likwid_printEnergy",lua_likwid_printEnergy);
+    lua_register(L, "likwid_readPowerDomains",lua_likwid_readPowerDomains);
     lua_register(L, "likwid_powerLimitGet",lua_likwid_power_limitGet);
     lua_register(L, "likwid_powerLimitSet",lua_likwid_power_limitSet);
     lua_register(L, "likwid_powerLimitState",lua_likwid_power_limitState);
@@ -2673,6 +2922,7 @@ luaopen_liblikwid(lua_State* L){
     // MemSweep functions
     lua_register(L, "likwid_memSweep", lua_likwid_memSweep);
     lua_register(L, "likwid_memSweepDomain", lua_likwid_memSweepDomain);
+    lua_register(L, "likwid_getPagePlacement", lua_likwid_getPagePlacement);
     // Pinning functions
     lua_register(L, "likwid_pinProcess", lua_likwid_pinProcess);
     // Helper functions
@@ -2726,6 +2976,10 @@ luaopen_liblikwid(lua_State* L){
     lua_register(L, "likwid_getAvailFreq", lua_likwid_getAvailFreq);
     lua_register(L, "likwid_getAvailGovs", lua_likwid_getAvailGovs);
     lua_register(L, "likwid_getDriver", lua_likwid_getDriver);
+    lua_register(L, "likwid_setFreqList", lua_likwid_setFreqList);
+    lua_register(L, "likwid_initEffectiveClock", lua_likwid_initEffectiveClock);
+    lua_register(L, "likwid_readEffectiveClock", lua_likwid_readEffectiveClock);
+    lua_register(L, "likwid_finalizeEffectiveClock", lua_likwid_finalizeEffectiveClock);
     // setuid&friends
     lua_register(L, "likwid_getuid", lua_likwid_getuid);
     lua_register(L, "likwid_geteuid", lua_likwid_geteuid);
@@ -33,6 +33,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <pthread.h>
 #include <sys/mman.h>
 
 #include <error.h>
@@ -45,6 +47,15 @@
 /* #####   EXPORTED VARIABLES   ########################################### */
 
 extern void _loadData(uint32_t size, void* ptr);
+extern void _storeDataNT(uint64_t size, void* ptr);
+
+/* #####   TYPE DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ############## */
+
+typedef struct {
+    int cpu;
+    char* ptr;
+    size_t size;
+} SweepChunk;
 
 /* #####   LOCAL VARIABLES   ############################################## */
 
@@ -64,20 +75,66 @@ allocateOnNode(size_t size, int domainId)
         ERROR;
     }
 
-    numa_membind(ptr, size, domainId);
+    if (numa_membind(ptr, size, domainId) < 0)
+    {
+        exit(EXIT_FAILURE);
+    }
 
     return ptr;
 }
 
-static void
-initMemory(size_t size, char* ptr, int domainId)
+static void*
+initChunk(void* arg)
 {
-    affinity_pinProcess(numa_info.nodes[domainId].processors[0]);
+    SweepChunk* chunk = (SweepChunk*) arg;
+    if (chunk->size == 0)
+    {
+        return NULL;
+    }
+    affinity_pinThread(chunk->cpu);
+#if defined(__x86_64__) || defined(__i386__)
+    /* non-temporal stores do not pollute the caches with the fill data */
+    _storeDataNT(chunk->size, chunk->ptr);
+#else
+    for (size_t i=0; i < chunk->size; i += PAGE_ALIGNMENT)
+    {
+        chunk->ptr[i] = (char) 0xEF;
+    }
+#endif
+    return NULL;
+}
 
-    for (size_t i=0; i < size; i += PAGE_ALIGNMENT)
+/* Split the buffer of a domain into page aligned chunks, one for the first
+ * HW thread of each CPU core in the domain. Returns the number of chunks. */
+static int
+splitDomain(int domainId, char* ptr, size_t size, SweepChunk* chunks)
+{
+    int numCores = 0;
+    size_t offset = 0;
+    size_t chunkSize = 0;
+
+    for (uint32_t i=0; i < numa_info.nodes[domainId].numberOfProcessors; i++)
+    {
+        uint32_t cpu = numa_info.nodes[domainId].processors[i];
+        if ((cpu < cpuid_topology.numHWThreads) &&
+            (cpuid_topology.threadPool[cpu].threadId == 0) &&
+            (cpuid_topology.threadPool[cpu].inCpuSet))
+        {
+            chunks[numCores++].cpu = cpu;
+        }
+    }
+    if (numCores == 0)
     {
-        ptr[i] = (char) 0xEF;
+        chunks[numCores++].cpu = numa_info.nodes[domainId].processors[0];
     }
+    chunkSize = ((size / numCores) / PAGE_ALIGNMENT) * PAGE_ALIGNMENT;
+    for (int i=0; i < numCores; i++)
+    {
+        chunks[i].ptr = ptr + offset;
+        chunks[i].size = (i == numCores-1 ? size - offset : chunkSize);
+        offset += chunkSize;
+    }
+    return numCores;
 }
 
 static int
@@ -95,6 +152,31 @@ findProcessor(uint32_t nodeId, uint32_t coreId)
     return 0;
 }
 
+static void
+printPagePlacement(char* ptr, size_t size)
+{
+    uint64_t* counts = (uint64_t*) malloc(numa_info.numberOfNodes * sizeof(uint64_t));
+    int pages = 0;
+    if (!counts)
+    {
+        return;
+    }
+    pages = numa_getPagePlacement(ptr, size, counts);
+    if (pages > 0)
+    {
+        printf("Placement of %d pages:", pages);
+        for (uint32_t i = 0; i < numa_info.numberOfNodes; i++)
+        {
+            if (counts[i] > 0)
+            {
+                printf(" domain %d %.1f%%", i, (100.0 * counts[i]) / pages);
+            }
+        }
+        printf("\n");
+    }
+    free(counts);
+}
+
 /* evict all dirty cachelines from last level cache */
 static void
 cleanupCache(char* ptr)
@@ -109,6 +191,106 @@ cleanupCache(char* ptr)
 #endif
 }
 
+/* Sweep the given NUMA domains concurrently. The buffers of all domains are
+ * filled at the same time by one pinned thread per CPU core. */
+static void
+sweepDomains(const int* domainIds, int numDomains)
+{
+    char** ptrs = NULL;
+    size_t* sizes = NULL;
+    SweepChunk* chunks = NULL;
+    pthread_t* threads = NULL;
+    int* started = NULL;
+    int numChunks = 0;
+    int maxChunks = 0;
+    size_t total = 0;
+    struct timespec start, stop;
+    double runtime = 0;
+
+    for (int d=0; d < numDomains; d++)
+    {
+        maxChunks += MAX(numa_info.nodes[domainIds[d]].numberOfProcessors, 1);
+    }
+    ptrs = (char**) calloc(numDomains, sizeof(char*));
+    sizes = (size_t*) calloc(numDomains, sizeof(size_t));
+    chunks = (SweepChunk*) calloc(maxChunks, sizeof(SweepChunk));
+    threads = (pthread_t*) calloc(maxChunks, sizeof(pthread_t));
+    started = (int*) calloc(maxChunks, sizeof(int));
+    if ((!ptrs) || (!sizes) || (!chunks) || (!threads) || (!started))
+    {
+        ERROR_PLAIN_PRINT(Cannot allocate memory for memory sweep);
+        goto sweep_free;
+    }
+
+    for (int d=0; d < numDomains; d++)
+    {
+        int domainId = domainIds[d];
+        sizes[d] = numa_info.nodes[domainId].totalMemory * 1024ULL * memoryFraction / 100ULL;
+        sizes[d] = (sizes[d] / PAGE_ALIGNMENT) * PAGE_ALIGNMENT;
+        if (getenv("LIKWID_SILENT") == NULL)
+        {
+            printf("Sweeping domain %d: Using %g MB of %g MB\n",
+                    domainId,
+                    sizes[d] / (1024.0 * 1024.0),
+                    numa_info.nodes[domainId].totalMemory/ 1024.0);
+        }
+        ptrs[d] = (char*) allocateOnNode(sizes[d], domainId);
+        if (ptrs[d] == (char*)-1)
+        {
+            ptrs[d] = NULL;
+            continue;
+        }
+        numChunks += splitDomain(domainId, ptrs[d], sizes[d], &chunks[numChunks]);
+        total += sizes[d];
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i=0; i < numChunks; i++)
+    {
+        started[i] = (pthread_create(&threads[i], NULL, initChunk, &chunks[i]) == 0);
+    }
+    for (int i=0; i < numChunks; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+        else
+        {
+            initChunk(&chunks[i]);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    runtime = (stop.tv_sec - start.tv_sec) + 1E-9 * (stop.tv_nsec - start.tv_nsec);
+    if ((getenv("LIKWID_SILENT") == NULL) && (runtime > 0))
+    {
+        printf("Swept %g MB with %d threads in %g s: %g MB/s\n",
+                total / (1024.0 * 1024.0), numChunks, runtime,
+                (total / (1024.0 * 1024.0)) / runtime);
+    }
+
+    for (int d=0; d < numDomains; d++)
+    {
+        if (ptrs[d] == NULL)
+        {
+            continue;
+        }
+        if (getenv("LIKWID_SILENT") == NULL)
+        {
+            printPagePlacement(ptrs[d], sizes[d]);
+        }
+        affinity_pinProcess(numa_info.nodes[domainIds[d]].processors[0]);
+        cleanupCache(ptrs[d]);
+        munmap(ptrs[d], sizes[d]);
+    }
+sweep_free:
+    free(ptrs);
+    free(sizes);
+    free(chunks);
+    free(threads);
+    free(started);
+}
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 void
@@ -120,43 +302,46 @@ memsweep_setMemoryFraction(uint64_t fraction)
 void
 memsweep_node(void)
 {
+    int* domains = (int*) malloc(numa_info.numberOfNodes * sizeof(int));
+    if (!domains)
+    {
+        return;
+    }
     for ( uint32_t i=0; i < numa_info.numberOfNodes; i++)
     {
-        memsweep_domain(i);
+        domains[i] = i;
     }
+    sweepDomains(domains, numa_info.numberOfNodes);
+    free(domains);
 }
 
 void
 memsweep_domain(int domainId)
 {
-    char* ptr = NULL;
-    size_t size = numa_info.nodes[domainId].totalMemory * 1024ULL * memoryFraction / 100ULL;
-    if (getenv("LIKWID_SILENT") == NULL)
-    {
-        printf("Sweeping domain %d: Using %g MB of %g MB\n",
-                domainId,
-                size / (1024.0 * 1024.0),
-                numa_info.nodes[domainId].totalMemory/ 1024.0);
-    }
-    ptr = (char*) allocateOnNode(size, domainId);
-    initMemory(size, ptr, domainId);
-    cleanupCache(ptr);
-    munmap(ptr, size);
+    sweepDomains(&domainId, 1);
 }
 
 void
 memsweep_threadGroup(const int* processorList, int numberOfProcessors)
 {
+    int numDomains = 0;
+    int* domains = (int*) malloc(numa_info.numberOfNodes * sizeof(int));
+    if (!domains)
+    {
+        return;
+    }
     for (uint32_t i=0; i<numa_info.numberOfNodes; i++)
     {
         for (int j=0; j<numberOfProcessors; j++)
         {
             if (findProcessor(i,processorList[j]))
             {
-                memsweep_domain(i);
+                domains[numDomains++] = i;
                 break;
             }
         }
     }
+    sweepDomains(domains, numDomains);
+    free(domains);
 }
 
@@ -35,6 +35,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <sched.h>
@@ -46,6 +48,7 @@
 #include <linux/mempolicy.h>
 #endif
 #include <topology.h>
+#include <topology_cache.h>
 
 #include <configuration.h>
 
@@ -70,6 +73,13 @@ NumaTopology numa_info = {0,NULL};
 
 static int numaInitialized = 0;
 
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+/* pages queried per move_pages call */
+#define NUMA_PLACEMENT_BATCH 1024
+/* buffers with more pages are sampled */
+#define NUMA_PLACEMENT_MAX_SAMPLES 262144
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 int
@@ -110,11 +120,11 @@ empty_numa_setInterleaved(const int* processorList, int numberOfProcessors)
     return;
 }
 
-void
+int
 empty_numa_membind(void* ptr, size_t size, int domainId)
 {
     printf("MBIND NOT supported in kernel!\n");
-    return;
+    return -ENOSYS;
 }
 
 const struct numa_functions numa_funcs = {
@@ -153,6 +163,12 @@ numa_init(void)
         numaInitialized = 1;
         return 0;
     }
+    else if (topology_cache_isLoaded() && (numa_info.nodes != NULL))
+    {
+        /* Also filled when the topology was read from the cached snapshot */
+        numaInitialized = 1;
+        return 0;
+    }
     else
     {
         cpu_set_t cpuSet;
@@ -179,13 +195,94 @@ numa_setInterleaved(const int* processorList, int numberOfProcessors)
     return funcs.numa_setInterleaved(processorList, numberOfProcessors);
 }
 
-void
+int
 numa_membind(void* ptr, size_t size, int domainId)
 {
     const struct numa_functions funcs = numa_funcs;
     return funcs.numa_membind(ptr, size, domainId);
 }
 
+int
+numa_getProcessPagePlacement(int pid, void* ptr, size_t size, uint64_t* counts)
+{
+#ifdef SYS_move_pages
+    void* pages[NUMA_PLACEMENT_BATCH];
+    int status[NUMA_PLACEMENT_BATCH];
+    size_t pagesize = sysconf(_SC_PAGESIZE);
+    uintptr_t start = ((uintptr_t)ptr) & ~(pagesize - 1);
+    uint64_t numPages = 0;
+    uint64_t stride = 1;
+    uint64_t samples = 0;
+
+    if ((ptr == NULL) || (size == 0) || (counts == NULL))
+    {
+        return -EINVAL;
+    }
+    if ((!numaInitialized) || (numa_info.numberOfNodes == 0))
+    {
+        return -EFAULT;
+    }
+    numPages = ((uintptr_t)ptr + size - start + pagesize - 1) / pagesize;
+    if (numPages > NUMA_PLACEMENT_MAX_SAMPLES)
+    {
+        stride = (numPages + NUMA_PLACEMENT_MAX_SAMPLES - 1) / NUMA_PLACEMENT_MAX_SAMPLES;
+    }
+    for (int i = 0; i < numa_info.numberOfNodes; i++)
+    {
+        counts[i] = 0;
+    }
+
+    for (uint64_t p = 0; p < numPages; )
+    {
+        int batch = 0;
+        for (; (batch < NUMA_PLACEMENT_BATCH) && (p < numPages); batch++, p += stride)
+        {
+            pages[batch] = (void*)(start + p * pagesize);
+            status[batch] = -ENOENT;
+        }
+        /* without target nodes move_pages only reports the current node */
+        if (syscall(SYS_move_pages, pid, (unsigned long)batch, pages, NULL, status, 0) < 0)
+        {
+            int err = errno;
+            DEBUG_PRINT(DEBUGLEV_DEVELOP, move_pages failed for PID %d: %s, pid, strerror(err));
+            return -err;
+        }
+        samples += batch;
+        for (int i = 0; i < batch; i++)
+        {
+            if (status[i] < 0)
+            {
+                continue;
+            }
+            for (int j = 0; j < numa_info.numberOfNodes; j++)
+            {
+                if (numa_info.nodes[j].id == status[i])
+                {
+                    counts[j]++;
+                    break;
+                }
+            }
+        }
+    }
+    if (stride > 1)
+    {
+        for (int i = 0; i < numa_info.numberOfNodes; i++)
+        {
+            counts[i] = (counts[i] * numPages) / samples;
+        }
+    }
+    return (int) MIN(numPages, (uint64_t)INT_MAX);
+#else
+    return -ENOSYS;
+#endif
+}
+
+int
+numa_getPagePlacement(void* ptr, size_t size, uint64_t* counts)
+{
+    return numa_getProcessPagePlacement(0, ptr, size, counts);
+}
+
 #ifndef HAS_MEMPOLICY
 void
 numa_finalize(void)
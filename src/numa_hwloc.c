@@ -353,7 +353,7 @@ hwloc_numa_init(void)
     }
 }
 
-void
+int
 hwloc_numa_membind(void* ptr, size_t size, int domainId)
 {
     int ret = 0;
@@ -361,13 +361,20 @@ hwloc_numa_membind(void* ptr, size_t size, int domainId)
     hwloc_nodeset_t nodeset = likwid_hwloc_bitmap_alloc();
     likwid_hwloc_bitmap_zero(nodeset);
     likwid_hwloc_bitmap_set(nodeset, domainId);
+    if (!hwloc_topology)
+    {
+        likwid_hwloc_topology_init(&hwloc_topology);
+        likwid_hwloc_topology_load(hwloc_topology);
+    }
     ret = likwid_hwloc_set_area_membind_nodeset(hwloc_topology, ptr, size, nodeset, HWLOC_MEMBIND_BIND, flags);
     likwid_hwloc_bitmap_free(nodeset);
 
     if (ret < 0)
     {
-        ERROR;
+        ret = -errno;
+        ERRNO_PRINT;
     }
+    return ret;
 }
 
 void
@@ -378,6 +385,11 @@ hwloc_numa_setInterleaved(int* processorList, int numberOfProcessors)
     likwid_hwloc_cpuset_t cpuset = hwloc_bitmap_alloc();
     likwid_hwloc_membind_flags_t flags = HWLOC_MEMBIND_STRICT|HWLOC_MEMBIND_PROCESS;
     likwid_hwloc_bitmap_zero(cpuset);
+    if (!hwloc_topology)
+    {
+        likwid_hwloc_topology_init(&hwloc_topology);
+        likwid_hwloc_topology_load(hwloc_topology);
+    }
     for (i=0; i<numa_info.numberOfNodes; i++)
     {
         for (j=0; j<numberOfProcessors; j++)
@@ -402,10 +414,10 @@ hwloc_numa_init(void)
     return 1;
 }
 
-void
+int
 hwloc_numa_membind(void* ptr, size_t size, int domainId)
 {
-    return;
+    return -ENOSYS;
 }
 
 void hwloc_numa_setInterleaved(int* processorList, int numberOfProcessors)
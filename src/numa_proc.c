@@ -366,7 +366,7 @@ proc_numa_setInterleaved(const int* processorList, int numberOfProcessors)
     }
 }
 
-void
+int
 proc_numa_membind(void* ptr, size_t size, int domainId)
 {
     int ret=0;
@@ -376,11 +376,14 @@ proc_numa_membind(void* ptr, size_t size, int domainId)
     flags |= MPOL_MF_STRICT;
     mask |= (1UL<<domainId);
 
-    ret = mbind(ptr, size, &mask, numa_info.numberOfNodes+1, flags);
+    /* The mask is indexed by node ID, which may exceed the node count */
+    ret = mbind(ptr, size, &mask, sizeof(mask) * 8, flags);
 
     if (ret < 0)
     {
-        ERROR;
+        ret = -errno;
+        ERRNO_PRINT;
     }
+    return ret;
 }
 
@@ -37,6 +37,8 @@
 #include <math.h>
 #include <float.h>
 #include <unistd.h>
+#include <time.h>
+#include <pthread.h>
 #include <sys/types.h>
 
 #include <types.h>
@@ -47,6 +49,7 @@
 #include <perfmon.h>
 #include <registers.h>
 #include <topology.h>
+#include <affinity.h>
 #include <access.h>
 #include <perfgroup.h>
 #include <cpuid.h>
@@ -94,6 +97,17 @@ PerfmonGroupSet* groupSet = NULL;
 LikwidResults* markerResults = NULL;
 int markerRegions = 0;
 
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+/* Serializes counter updates of a thread between the caller and the overflow guard */
+static pthread_mutex_t* threadCounterLocks = NULL;
+
+static pthread_t guardThread;
+static pthread_mutex_t guardLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t guardCond = PTHREAD_COND_INITIALIZER;
+static int guardRunning = 0;
+static double guardPeriod = 0.0;
+
 int (*perfmon_startCountersThread) (int thread_id, PerfmonEventSet* eventSet);
 int (*perfmon_stopCountersThread) (int thread_id, PerfmonEventSet* eventSet);
 int (*perfmon_readCountersThread) (int thread_id, PerfmonEventSet* eventSet);
@@ -583,38 +597,288 @@ parseOptions(struct bstrList* tokens, PerfmonEvent* event, RegisterIndex index)
     return event->numberOfOptions;
 }
 
-static double
-calculateResult(int groupId, int eventId, int threadId)
+static void*
+allocCounterArray(size_t count, size_t size)
 {
-    PerfmonEventSetEntry* event;
-    PerfmonCounter* counter;
-    int cpu_id;
-    double result = 0.0;
-    if (groupSet->groups[groupId].events[eventId].type == NOTYPE)
-        return result;
-
-    event = &(groupSet->groups[groupId].events[eventId]);
-    counter = &(event->threadCounter[threadId]);
-    if (counter->overflows == 0)
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, 64, count * size) != 0)
     {
-        result = (double) (counter->counterData - counter->startData);
+        return NULL;
+    }
+    memset(ptr, 0, count * size);
+    return ptr;
+}
+
+static void
+freeCounters(PerfmonCounter* counters)
+{
+    if (counters->init) free(counters->init);
+    if (counters->overflows) free(counters->overflows);
+    if (counters->foldedOverflows) free(counters->foldedOverflows);
+    if (counters->startData) free(counters->startData);
+    if (counters->counterData) free(counters->counterData);
+    if (counters->lastResult) free(counters->lastResult);
+    if (counters->fullResult) free(counters->fullResult);
+    if (counters->maxValue) free(counters->maxValue);
+    if (counters->multiplier) free(counters->multiplier);
+    if (counters->isState) free(counters->isState);
+    memset(counters, 0, sizeof(PerfmonCounter));
+}
+
+static int
+allocCounters(PerfmonCounter* counters, int numberOfEvents, int numberOfThreads)
+{
+    int stride = ((numberOfEvents + PERFMON_COUNTER_ALIGN - 1) / PERFMON_COUNTER_ALIGN) * PERFMON_COUNTER_ALIGN;
+    size_t count = (size_t)stride * numberOfThreads;
+    memset(counters, 0, sizeof(PerfmonCounter));
+    counters->stride = stride;
+    counters->init = (int*) allocCounterArray(count, sizeof(int));
+    counters->overflows = (int*) allocCounterArray(count, sizeof(int));
+    counters->foldedOverflows = (uint64_t*) allocCounterArray(count, sizeof(uint64_t));
+    counters->startData = (uint64_t*) allocCounterArray(count, sizeof(uint64_t));
+    counters->counterData = (uint64_t*) allocCounterArray(count, sizeof(uint64_t));
+    counters->lastResult = (double*) allocCounterArray(count, sizeof(double));
+    counters->fullResult = (double*) allocCounterArray(count, sizeof(double));
+    counters->maxValue = (double*) allocCounterArray(stride, sizeof(double));
+    counters->multiplier = (double*) allocCounterArray(stride, sizeof(double));
+    counters->isState = (int*) allocCounterArray(stride, sizeof(int));
+    if ((!counters->init) || (!counters->overflows) || (!counters->foldedOverflows) ||
+        (!counters->startData) || (!counters->counterData) || (!counters->lastResult) ||
+        (!counters->fullResult) || (!counters->maxValue) || (!counters->multiplier) ||
+        (!counters->isState))
+    {
+        freeCounters(counters);
+        return -ENOMEM;
     }
-    else if (counter->overflows > 0)
+    return 0;
+}
+
+static void
+setupCounterConstants(PerfmonEventSet* eventSet, int eventId)
+{
+    PerfmonEventSetEntry* event = &eventSet->events[eventId];
+    eventSet->counters.maxValue[eventId] = 0.0;
+    eventSet->counters.multiplier[eventId] = 0.0;
+    eventSet->counters.isState[eventId] = 0;
+    if (event->type == NOTYPE)
     {
-        result += (double) ((perfmon_getMaxCounterValue(counter_map[event->index].type) -
-                    counter->startData) + counter->counterData);
-        counter->overflows--;
+        return;
     }
-    result += (double) (counter->overflows * perfmon_getMaxCounterValue(counter_map[event->index].type));
+    eventSet->counters.maxValue[eventId] =
+            (double) perfmon_getMaxCounterValue(counter_map[event->index].type);
+    eventSet->counters.multiplier[eventId] = 1.0;
     if (counter_map[event->index].type == POWER)
     {
-        result *= power_getEnergyUnit(getCounterTypeOffset(event->index));
+        eventSet->counters.multiplier[eventId] =
+                power_getEnergyUnit(getCounterTypeOffset(event->index));
     }
     else if (counter_map[event->index].type == THERMAL)
     {
-        result = (double)counter->counterData;
+        eventSet->counters.isState[eventId] = 1;
+    }
+}
+
+static void
+calculateResults(PerfmonEventSet* eventSet, int threadId, int restart)
+{
+    int i;
+    const int numberOfEvents = eventSet->numberOfEvents;
+    const size_t offset = (size_t)threadId * eventSet->counters.stride;
+    uint64_t* startData = eventSet->counters.startData + offset;
+    const uint64_t* counterData = eventSet->counters.counterData + offset;
+    int* overflows = eventSet->counters.overflows + offset;
+    uint64_t* foldedOverflows = eventSet->counters.foldedOverflows + offset;
+    double* lastResult = eventSet->counters.lastResult + offset;
+    double* fullResult = eventSet->counters.fullResult + offset;
+    const double* maxValue = eventSet->counters.maxValue;
+    const double* multiplier = eventSet->counters.multiplier;
+    const int* isState = eventSet->counters.isState;
+
+    /* Branch-free over contiguous arrays so the compiler can vectorize it.
+     * After a wrap (counterData < startData) the signed difference is negative,
+     * it is only correct if the overflow handling counted the wrap in
+     * overflows, which adds one full counter range. */
+    for (i = 0; i < numberOfEvents; i++)
+    {
+        double delta = (double)(int64_t)(counterData[i] - startData[i]);
+        double result = (delta + (double)overflows[i] * maxValue[i]) * multiplier[i];
+        result = (isState[i] ? (double)counterData[i] : result);
+        lastResult[i] = result;
+        fullResult[i] += result;
+    }
+    if (restart)
+    {
+        for (i = 0; i < numberOfEvents; i++)
+        {
+            startData[i] = counterData[i];
+            foldedOverflows[i] += overflows[i];
+            overflows[i] = 0;
+        }
     }
-    return result;
+}
+
+static inline void
+lockThreadCounters(int thread_id)
+{
+    if (threadCounterLocks != NULL)
+    {
+        pthread_mutex_lock(&threadCounterLocks[thread_id]);
+    }
+}
+
+static inline void
+unlockThreadCounters(int thread_id)
+{
+    if (threadCounterLocks != NULL)
+    {
+        pthread_mutex_unlock(&threadCounterLocks[thread_id]);
+    }
+}
+
+/* Returns the maximal expected increment rate per second of a counter register
+ * whose overflows can only be detected by comparing consecutive reads. Counters
+ * with hardware overflow status bits return 0 and are not guarded. */
+static double
+guardMaxRate(PerfmonEventSetEntry* event)
+{
+    int domain = 0;
+    double unit = 0.0;
+    double watts = 0.0;
+    if (event->type != POWER)
+    {
+        return 0.0;
+    }
+    domain = getCounterTypeOffset(event->index);
+    unit = power_getEnergyUnit(domain);
+    if ((unit <= 0.0) || (domain >= NUM_POWER_DOMAINS))
+    {
+        return 0.0;
+    }
+    watts = power_info.domains[domain].maxPower;
+    if ((watts <= 0.0) && (domain != DRAM) && (domain != PLATFORM))
+    {
+        /* PP0 and PP1 are part of the package, PKG limits them */
+        watts = power_info.domains[PKG].maxPower;
+    }
+    if (watts <= 0.0)
+    {
+        watts = 2 * power_info.domains[domain].tdp;
+    }
+    if (watts <= 0.0)
+    {
+        watts = PERFMON_GUARD_DEFAULT_POWER;
+    }
+    return watts/unit;
+}
+
+static double
+guardGetPeriod(void)
+{
+    int i, j;
+    double period = PERFMON_GUARD_MAX_PERIOD;
+    int found = 0;
+    for (i = 0; i < groupSet->numberOfActiveGroups; i++)
+    {
+        for (j = 0; j < groupSet->groups[i].numberOfEvents; j++)
+        {
+            PerfmonEventSetEntry* event = &groupSet->groups[i].events[j];
+            double rate = guardMaxRate(event);
+            if (rate > 0.0)
+            {
+                double wrap = ldexp(1.0, box_map[event->type].regWidth) / rate;
+                if (wrap/PERFMON_GUARD_SAFETY < period)
+                {
+                    period = wrap/PERFMON_GUARD_SAFETY;
+                }
+                found = 1;
+            }
+        }
+    }
+    if (!found)
+    {
+        return 0.0;
+    }
+    if (period < PERFMON_GUARD_MIN_PERIOD)
+    {
+        period = PERFMON_GUARD_MIN_PERIOD;
+    }
+    return period;
+}
+
+static void
+guardCheckCounters(int groupId)
+{
+    int i, j;
+    PerfmonEventSet* eventSet = &groupSet->groups[groupId];
+    for (i = 0; i < groupSet->numberOfThreads; i++)
+    {
+        int cpu_id = groupSet->threads[i].processorId;
+        if (socket_lock[affinity_core2node_lookup[cpu_id]] != cpu_id)
+        {
+            continue;
+        }
+        lockThreadCounters(i);
+        if (eventSet->state != STATE_START)
+        {
+            unlockThreadCounters(i);
+            return;
+        }
+        for (j = 0; j < eventSet->numberOfEvents; j++)
+        {
+            PerfmonEventSetEntry* event = &eventSet->events[j];
+            uint32_t tmp = 0x0U;
+            uint64_t value = 0x0ULL;
+            if ((THREADCOUNTER(eventSet, j, i, init) != TRUE) || (guardMaxRate(event) <= 0.0))
+            {
+                continue;
+            }
+            if (power_read(cpu_id, counter_map[event->index].counterRegister, &tmp) != 0)
+            {
+                continue;
+            }
+            value = field64(tmp, 0, box_map[event->type].regWidth);
+            if (value < THREADCOUNTER(eventSet, j, i, counterData))
+            {
+                DEBUG_PRINT(DEBUGLEV_DEVELOP, Overflow guard detected wrap of %s on CPU %d,
+                            counter_map[event->index].key, cpu_id);
+                THREADCOUNTER(eventSet, j, i, overflows)++;
+            }
+            THREADCOUNTER(eventSet, j, i, counterData) = value;
+        }
+        unlockThreadCounters(i);
+    }
+}
+
+static void*
+guardMain(void* arg)
+{
+    struct timespec deadline;
+    pthread_mutex_lock(&guardLock);
+    while (guardRunning)
+    {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += (time_t)guardPeriod;
+        deadline.tv_nsec += (long)((guardPeriod - floor(guardPeriod)) * 1.0E9);
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (guardRunning &&
+               pthread_cond_timedwait(&guardCond, &guardLock, &deadline) != ETIMEDOUT);
+        if (!guardRunning)
+        {
+            break;
+        }
+        pthread_mutex_unlock(&guardLock);
+        if (groupSet->activeGroup >= 0)
+        {
+            guardCheckCounters(groupSet->activeGroup);
+        }
+        pthread_mutex_lock(&guardLock);
+    }
+    pthread_mutex_unlock(&guardLock);
+    return NULL;
 }
 
 int
@@ -1325,6 +1589,18 @@ perfmon_init(int nrThreads, const int* threadsToCpu)
         free(groupSet);
         return -ENOMEM;
     }
+    threadCounterLocks = (pthread_mutex_t*) malloc(nrThreads * sizeof(pthread_mutex_t));
+    if (threadCounterLocks == NULL)
+    {
+        ERROR_PLAIN_PRINT(Cannot allocate thread locks);
+        free(groupSet->threads);
+        free(groupSet);
+        return -ENOMEM;
+    }
+    for(i=0; i<nrThreads; i++)
+    {
+        pthread_mutex_init(&threadCounterLocks[i], NULL);
+    }
     groupSet->numberOfThreads = nrThreads;
     groupSet->numberOfGroups = 0;
     groupSet->numberOfActiveGroups = 0;
@@ -1401,7 +1677,7 @@ perfmon_init(int nrThreads, const int* threadsToCpu)
 void
 perfmon_finalize(void)
 {
-    int group, event;
+    int group;
     int thread;
     if (perfmon_initialized == 0)
     {
@@ -1411,17 +1687,14 @@ perfmon_finalize(void)
     {
         return;
     }
+    perfmon_stopOverflowGuard();
     for(group=0;group < groupSet->numberOfActiveGroups; group++)
     {
         for (thread=0;thread< groupSet->numberOfThreads; thread++)
         {
             perfmon_finalizeCountersThread(thread, &(groupSet->groups[group]));
         }
-        for (event=0;event < groupSet->groups[group].numberOfEvents; event++)
-        {
-            if (groupSet->groups[group].events[event].threadCounter)
-                free(groupSet->groups[group].events[event].threadCounter);
-        }
+        freeCounters(&groupSet->groups[group].counters);
         if (groupSet->groups[group].events != NULL)
             free(groupSet->groups[group].events);
         perfmon_delEventSet(group);
@@ -1429,6 +1702,15 @@ perfmon_finalize(void)
     }
     if (groupSet->groups != NULL)
         free(groupSet->groups);
+    if (threadCounterLocks != NULL)
+    {
+        for (thread=0;thread< groupSet->numberOfThreads; thread++)
+        {
+            pthread_mutex_destroy(&threadCounterLocks[thread]);
+        }
+        free(threadCounterLocks);
+        threadCounterLocks = NULL;
+    }
     if (groupSet->threads != NULL)
         free(groupSet->threads);
     groupSet->activeGroup = -1;
@@ -1451,10 +1733,70 @@ perfmon_finalize(void)
     return;
 }
 
+int
+perfmon_startOverflowGuard(void)
+{
+    int ret = 0;
+    if (perfmon_initialized != 1)
+    {
+        ERROR_PLAIN_PRINT(Perfmon module not properly initialized);
+        return -EINVAL;
+    }
+    pthread_mutex_lock(&guardLock);
+    if (guardRunning)
+    {
+        pthread_mutex_unlock(&guardLock);
+        return 0;
+    }
+    guardPeriod = guardGetPeriod();
+    if (guardPeriod <= 0.0)
+    {
+        DEBUG_PLAIN_PRINT(DEBUGLEV_DETAIL, No counter registers need an overflow guard);
+        pthread_mutex_unlock(&guardLock);
+        return 0;
+    }
+    guardRunning = 1;
+    ret = pthread_create(&guardThread, NULL, guardMain, NULL);
+    if (ret != 0)
+    {
+        ERROR_PLAIN_PRINT(Cannot create overflow guard thread);
+        guardRunning = 0;
+        guardPeriod = 0.0;
+        pthread_mutex_unlock(&guardLock);
+        return -ret;
+    }
+    DEBUG_PRINT(DEBUGLEV_INFO, Overflow guard reads counters every %f seconds, guardPeriod);
+    pthread_mutex_unlock(&guardLock);
+    return 0;
+}
+
+int
+perfmon_stopOverflowGuard(void)
+{
+    pthread_mutex_lock(&guardLock);
+    if (!guardRunning)
+    {
+        pthread_mutex_unlock(&guardLock);
+        return 0;
+    }
+    guardRunning = 0;
+    pthread_cond_signal(&guardCond);
+    pthread_mutex_unlock(&guardLock);
+    pthread_join(guardThread, NULL);
+    guardPeriod = 0.0;
+    return 0;
+}
+
+double
+perfmon_getOverflowGuardPeriod(void)
+{
+    return guardPeriod;
+}
+
 int
 perfmon_addEventSet(const char* eventCString)
 {
-    int i, j, err, isPerfGroup = 0;
+    int i, err, isPerfGroup = 0;
     bstring eventBString;
     struct bstrList* eventtokens;
     PerfmonEventSet* eventSet;
@@ -1504,6 +1846,7 @@ perfmon_addEventSet(const char* eventCString)
         /* Only one group exists by now */
         groupSet->groups[0].rdtscTime = 0;
         groupSet->groups[0].runTime = 0;
+        groupSet->groups[0].startCount = 0;
         groupSet->groups[0].numberOfEvents = 0;
     }
 
@@ -1518,6 +1861,7 @@ perfmon_addEventSet(const char* eventCString)
         }
         groupSet->groups[groupSet->numberOfActiveGroups].rdtscTime = 0;
         groupSet->groups[groupSet->numberOfActiveGroups].runTime = 0;
+        groupSet->groups[groupSet->numberOfActiveGroups].startCount = 0;
         groupSet->groups[groupSet->numberOfActiveGroups].numberOfEvents = 0;
         DEBUG_PLAIN_PRINT(DEBUGLEV_INFO, Allocating new group structure for group.);
     }
@@ -1570,6 +1914,13 @@ perfmon_addEventSet(const char* eventCString)
         return -ENOMEM;
     }
     eventSet->numberOfEvents = 0;
+    if (allocCounters(&eventSet->counters, eventtokens->qty, groupSet->numberOfThreads) < 0)
+    {
+        ERROR_PRINT(Cannot allocate counter for all threads in group %d,groupSet->numberOfActiveGroups);
+        free(eventSet->events);
+        eventSet->events = NULL;
+        return -ENOMEM;
+    }
 
     eventSet->regTypeMask1 = 0x0ULL;
     eventSet->regTypeMask2 = 0x0ULL;
@@ -1641,25 +1992,7 @@ perfmon_addEventSet(const char* eventCString)
 
             SETTYPE(eventSet, event->type);
 past_checks:
-            event->threadCounter = (PerfmonCounter*) malloc(
-                groupSet->numberOfThreads * sizeof(PerfmonCounter));
-
-            if (event->threadCounter == NULL)
-            {
-                ERROR_PRINT(Cannot allocate counter for all threads in group %d,groupSet->numberOfActiveGroups);
-                //bstrListDestroy(subtokens);
-                continue;
-            }
-            for(j=0;j<groupSet->numberOfThreads;j++)
-            {
-                event->threadCounter[j].counterData = 0;
-                event->threadCounter[j].startData = 0;
-                event->threadCounter[j].fullResult = 0.0;
-                event->threadCounter[j].lastResult = 0.0;
-                event->threadCounter[j].overflows = 0;
-                event->threadCounter[j].init = FALSE;
-            }
-
+            setupCounterConstants(eventSet, i);
             eventSet->numberOfEvents++;
 
             if (event->type != NOTYPE)
@@ -1700,6 +2033,10 @@ past_checks:
         fprintf(stderr,"       Either the events or counters do not exist for the\n");
         fprintf(stderr,"       current architecture. If event options are set, they might\n");
         fprintf(stderr,"       be invalid.\n");
+        freeCounters(&eventSet->counters);
+        free(eventSet->events);
+        eventSet->events = NULL;
+        eventSet->numberOfEvents = 0;
         return -EINVAL;
     }
 }
@@ -1784,15 +2121,21 @@ __perfmon_startCounters(int groupId)
     }
     for(;i<groupSet->numberOfThreads;i++)
     {
+        lockThreadCounters(i);
         for (j=0; j<perfmon_getNumberOfEvents(groupId); j++)
-            groupSet->groups[groupId].events[j].threadCounter[i].overflows = 0;
+        {
+            THREADCOUNTER(&groupSet->groups[groupId], j, i, overflows) = 0;
+            THREADCOUNTER(&groupSet->groups[groupId], j, i, foldedOverflows) = 0;
+        }
         ret = perfmon_startCountersThread(groupSet->threads[i].thread_id, &groupSet->groups[groupId]);
+        unlockThreadCounters(i);
         if (ret)
         {
             return -groupSet->threads[i].thread_id-1;
         }
     }
     groupSet->groups[groupId].state = STATE_START;
+    groupSet->groups[groupId].startCount++;
     timer_start(&groupSet->groups[groupId].timer);
     return 0;
 }
@@ -1846,7 +2189,6 @@ __perfmon_stopCounters(int groupId)
     int i = 0;
     int j = 0;
     int ret = 0;
-    double result = 0.0;
 
     if (!lock_check())
     {
@@ -1855,26 +2197,23 @@ __perfmon_stopCounters(int groupId)
     }
 
     timer_stop(&groupSet->groups[groupId].timer);
+    groupSet->groups[groupId].state = STATE_SETUP;
 
     for (i = 0; i<groupSet->numberOfThreads; i++)
     {
+        lockThreadCounters(i);
         ret = perfmon_stopCountersThread(groupSet->threads[i].thread_id, &groupSet->groups[groupId]);
+        unlockThreadCounters(i);
         if (ret)
         {
             return -groupSet->threads[i].thread_id-1;
         }
     }
 
-    for (i=0; i<perfmon_getNumberOfEvents(groupId); i++)
+    for (j=0; j<groupSet->numberOfThreads; j++)
     {
-        for (j=0; j<perfmon_getNumberOfThreads(); j++)
-        {
-            result = (double)calculateResult(groupId, i, j);
-            groupSet->groups[groupId].events[i].threadCounter[j].lastResult = result;
-            groupSet->groups[groupId].events[i].threadCounter[j].fullResult += result;
-        }
+        calculateResults(&groupSet->groups[groupId], j, 0);
     }
-    groupSet->groups[groupId].state = STATE_SETUP;
     groupSet->groups[groupId].rdtscTime =
                 timer_print(&groupSet->groups[groupId].timer);
     groupSet->groups[groupId].runTime += groupSet->groups[groupId].rdtscTime;
@@ -1937,8 +2276,7 @@ int
 __perfmon_readCounters(int groupId, int threadId)
 {
     int ret = 0;
-    int i = 0, j = 0;
-    double result = 0.0;
+    int i = 0;
     if (perfmon_initialized != 1)
     {
         ERROR_PLAIN_PRINT(Perfmon module not properly initialized);
@@ -1959,46 +2297,190 @@ __perfmon_readCounters(int groupId, int threadId)
     {
         for (threadId = 0; threadId<groupSet->numberOfThreads; threadId++)
         {
+            lockThreadCounters(threadId);
             ret = perfmon_readCountersThread(threadId, &groupSet->groups[groupId]);
             if (ret)
             {
+                unlockThreadCounters(threadId);
                 return -threadId-1;
             }
-            for (j=0; j < groupSet->groups[groupId].numberOfEvents; j++)
-            {
-                if (groupSet->groups[groupId].events[j].type != NOTYPE)
-                {
-                    result = (double)calculateResult(groupId, j, threadId);
-                    groupSet->groups[groupId].events[j].threadCounter[threadId].lastResult = result;
-                    groupSet->groups[groupId].events[j].threadCounter[threadId].fullResult += result;
-                    groupSet->groups[groupId].events[j].threadCounter[threadId].startData =
-                        groupSet->groups[groupId].events[j].threadCounter[threadId].counterData;
-                    groupSet->groups[groupId].events[j].threadCounter[threadId].overflows = 0;
-                }
-            }
+            calculateResults(&groupSet->groups[groupId], threadId, 1);
+            unlockThreadCounters(threadId);
         }
     }
     else if ((threadId >= 0) && (threadId < groupSet->numberOfThreads))
     {
+        lockThreadCounters(threadId);
         ret = perfmon_readCountersThread(threadId, &groupSet->groups[groupId]);
         if (ret)
         {
+            unlockThreadCounters(threadId);
             return -threadId-1;
         }
-        for (j=0; j < groupSet->groups[groupId].numberOfEvents; j++)
-        {
-            result = (double)calculateResult(groupId, j, threadId);
-            groupSet->groups[groupId].events[j].threadCounter[threadId].lastResult = result;
-            groupSet->groups[groupId].events[j].threadCounter[threadId].fullResult += result;
-            groupSet->groups[groupId].events[j].threadCounter[threadId].startData =
-                groupSet->groups[groupId].events[j].threadCounter[threadId].counterData;
-            groupSet->groups[groupId].events[j].threadCounter[threadId].overflows = 0;
-        }
+        calculateResults(&groupSet->groups[groupId], threadId, 1);
+        unlockThreadCounters(threadId);
 }
     timer_start(&groupSet->groups[groupId].timer);
     return 0;
 }
 
+int
+perfmon_captureSnapshot(int groupId, perfmon_snapshot_t* snapshot)
+{
+    int i, j, ret = 0;
+    int nevents, nthreads;
+    TimerData timestamp;
+    PerfmonEventSet* eventSet;
+    perfmon_snapshot_t snap;
+    if (perfmon_initialized != 1)
+    {
+        ERROR_PLAIN_PRINT(Perfmon module not properly initialized);
+        return -EINVAL;
+    }
+    if ((unlikely(groupSet == NULL)) || (snapshot == NULL))
+    {
+        return -EINVAL;
+    }
+    if ((groupId < 0) && (groupSet->activeGroup >= 0))
+    {
+        groupId = groupSet->activeGroup;
+    }
+    if ((groupId < 0) || (groupId >= groupSet->numberOfActiveGroups))
+    {
+        ERROR_PRINT(Group %d does not exist in groupSet, groupId);
+        return -ENOENT;
+    }
+    eventSet = &groupSet->groups[groupId];
+    if (eventSet->state != STATE_START)
+    {
+        return -EINVAL;
+    }
+    nevents = eventSet->numberOfEvents;
+    nthreads = groupSet->numberOfThreads;
+    snap = (perfmon_snapshot_t) malloc(sizeof(PerfmonSnapshot));
+    if (snap == NULL)
+    {
+        return -ENOMEM;
+    }
+    snap->values = (uint64_t*) malloc(nevents * nthreads * sizeof(uint64_t));
+    snap->overflows = (uint64_t*) malloc(nevents * nthreads * sizeof(uint64_t));
+    if ((snap->values == NULL) || (snap->overflows == NULL))
+    {
+        perfmon_freeSnapshot(snap);
+        return -ENOMEM;
+    }
+    snap->groupId = groupId;
+    snap->numberOfEvents = nevents;
+    snap->numberOfThreads = nthreads;
+    snap->startCount = eventSet->startCount;
+    timer_start(&timestamp);
+    snap->tsc = timestamp.start.int64;
+    for (i = 0; i < nthreads; i++)
+    {
+        lockThreadCounters(i);
+        ret = perfmon_readCountersThread(i, eventSet);
+        if (ret)
+        {
+            unlockThreadCounters(i);
+            perfmon_freeSnapshot(snap);
+            return -i-1;
+        }
+        for (j = 0; j < nevents; j++)
+        {
+            snap->values[j*nthreads+i] = THREADCOUNTER(eventSet, j, i, counterData);
+            snap->overflows[j*nthreads+i] = THREADCOUNTER(eventSet, j, i, foldedOverflows) +
+                                            THREADCOUNTER(eventSet, j, i, overflows);
+        }
+        unlockThreadCounters(i);
+    }
+    *snapshot = snap;
+    return 0;
+}
+
+int
+perfmon_diffSnapshots(perfmon_snapshot_t start, perfmon_snapshot_t stop, double* results, double* time)
+{
+    int i, j;
+    PerfmonEventSet* eventSet;
+    if ((start == NULL) || (stop == NULL) || (results == NULL))
+    {
+        return -EINVAL;
+    }
+    if ((start->groupId != stop->groupId) || (start->startCount != stop->startCount) ||
+        (start->numberOfEvents != stop->numberOfEvents) ||
+        (start->numberOfThreads != stop->numberOfThreads))
+    {
+        ERROR_PLAIN_PRINT(Snapshots belong to different groups or measurement runs);
+        return -EINVAL;
+    }
+    if ((unlikely(groupSet == NULL)) || (start->groupId >= groupSet->numberOfActiveGroups))
+    {
+        return -ENOENT;
+    }
+    eventSet = &groupSet->groups[start->groupId];
+    for (j = 0; j < start->numberOfEvents; j++)
+    {
+        RegisterType type = eventSet->events[j].type;
+        RegisterIndex index = eventSet->events[j].index;
+        double maxValue = 0.0;
+        if (type != NOTYPE)
+        {
+            maxValue = (double)perfmon_getMaxCounterValue(counter_map[index].type);
+        }
+        for (i = 0; i < start->numberOfThreads; i++)
+        {
+            int idx = j*start->numberOfThreads+i;
+            double result = 0.0;
+            if (type == NOTYPE)
+            {
+                results[idx] = 0.0;
+                continue;
+            }
+            if ((type == THERMAL) ||
+                (type == QBOX0FIX) || (type == QBOX1FIX) || (type == QBOX2FIX) ||
+                (type == SBOX0FIX) || (type == SBOX1FIX) || (type == SBOX2FIX))
+            {
+                /* Current state values, not accumulating counters */
+                results[idx] = (double)stop->values[idx];
+                continue;
+            }
+            result = ((double)stop->values[idx] - (double)start->values[idx]);
+            result += (double)(stop->overflows[idx] - start->overflows[idx]) * maxValue;
+            if (counter_map[index].type == POWER)
+            {
+                result *= power_getEnergyUnit(getCounterTypeOffset(index));
+            }
+            results[idx] = result;
+        }
+    }
+    if (time != NULL)
+    {
+        TimerData interval;
+        interval.start.int64 = start->tsc;
+        interval.stop.int64 = stop->tsc;
+        *time = timer_print(&interval);
+    }
+    return start->numberOfEvents * start->numberOfThreads;
+}
+
+void
+perfmon_freeSnapshot(perfmon_snapshot_t snapshot)
+{
+    if (snapshot == NULL)
+    {
+        return;
+    }
+    if (snapshot->values != NULL)
+    {
+        free(snapshot->values);
+    }
+    if (snapshot->overflows != NULL)
+    {
+        free(snapshot->overflows);
+    }
+    free(snapshot);
+}
+
 int
 perfmon_readCounters(void)
 {
@@ -2109,7 +2591,7 @@ perfmon_getResult(int groupId, int eventId, int threadId)
     if (groupSet->groups[groupId].events[eventId].type == NOTYPE)
         return 0;
 
-    if ((groupSet->groups[groupId].events[eventId].threadCounter[threadId].fullResult == 0) ||
+    if ((THREADCOUNTER(&groupSet->groups[groupId], eventId, threadId, fullResult) == 0) ||
         (groupSet->groups[groupId].events[eventId].type == THERMAL) ||
         (groupSet->groups[groupId].events[eventId].type == QBOX0FIX) ||
         (groupSet->groups[groupId].events[eventId].type == QBOX1FIX) ||
@@ -2118,9 +2600,9 @@ perfmon_getResult(int groupId, int eventId, int threadId)
         (groupSet->groups[groupId].events[eventId].type == SBOX1FIX) ||
         (groupSet->groups[groupId].events[eventId].type == SBOX2FIX))
     {
-        return groupSet->groups[groupId].events[eventId].threadCounter[threadId].lastResult;
+        return THREADCOUNTER(&groupSet->groups[groupId], eventId, threadId, lastResult);
     }
-    return groupSet->groups[groupId].events[eventId].threadCounter[threadId].fullResult;
+    return THREADCOUNTER(&groupSet->groups[groupId], eventId, threadId, fullResult);
 }
 
 double
@@ -2156,7 +2638,7 @@ perfmon_getLastResult(int groupId, int eventId, int threadId)
     if (groupSet->groups[groupId].events[eventId].type == NOTYPE)
         return 0;
 
-    return groupSet->groups[groupId].events[eventId].threadCounter[threadId].lastResult;
+    return THREADCOUNTER(&groupSet->groups[groupId], eventId, threadId, lastResult);
 }
 
 double
@@ -2352,7 +2834,7 @@ __perfmon_switchActiveGroupThread(int thread_id, int new_group)
     {
         for(i=0; i<groupSet->groups[groupSet->activeGroup].numberOfEvents;i++)
         {
-            groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].init = FALSE;
+            THREADCOUNTER(&groupSet->groups[groupSet->activeGroup], i, thread_id, init) = FALSE;
         }
     }
     ret = perfmon_setupCounters(new_group);
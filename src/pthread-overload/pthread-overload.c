@@ -34,7 +34,7 @@
 #include <stdint.h>
 #include <dlfcn.h>
 #include <sched.h>
-#include <bits/pthreadtypes.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <errno.h>
 #include <dirent.h>
@@ -48,6 +48,7 @@
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
 #define LLU_CAST  (unsigned long long)
+#define MAX_PATTERNS 32
 
 extern int pthread_setaffinity_np(pthread_t thread, size_t cpusetsize, const cpu_set_t *cpuset);
 
@@ -73,102 +74,452 @@ static char * sosearchpaths[] = {
     } while(0)
 #endif
 
-int __attribute__ ((visibility ("default") ))
-pthread_create(pthread_t* thread,
-        const pthread_attr_t* attr,
-        void* (*start_routine)(void *),
-        void * arg)
+/* Pinning state shared by the overloaded functions */
+typedef struct {
+    pthread_t thread;
+    int slot;
+} PinnedThread;
+
+/* Start routine and argument of a thread wrapped to track its exit.
+ * pinned is set by the creating thread once the thread is remembered. */
+typedef struct {
+    void* (*start_routine)(void*);
+    void* arg;
+    int pinned;
+} ThreadStart;
+
+static pthread_mutex_t pin_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pin_cond = PTHREAD_COND_INITIALIZER;
+static int initialized = 0;
+static int silent = 0;
+static int ncpus = 0;
+static int npinned = 0;
+static int ncalled = 0;
+static int overflow = 0;
+static int overflowed = 0;
+static int leastloaded = 0;
+static int pin_ids[MAX_NUM_THREADS];
+static int pin_package[MAX_NUM_THREADS];
+static int pin_load[MAX_NUM_THREADS];
+/* skip mask of arbitrary length, bit i belongs to the i-th created thread */
+static uint8_t* skipMask = NULL;
+static int skipMaskBits = 0;
+static char* callerPatterns[MAX_PATTERNS];
+static int numCallerPatterns = 0;
+static char* namePatterns[MAX_PATTERNS];
+static int numNamePatterns = 0;
+/* pin slots given back by threads identified as helpers by their name */
+static int freeSlots[MAX_NUM_THREADS];
+static int numFreeSlots = 0;
+static PinnedThread* pinnedThreads = NULL;
+static int numPinnedThreads = 0;
+static int maxPinnedThreads = 0;
+
+static void
+parseSkipMask(const char* str)
 {
-    void *handle;
-    char *error;
-    int (*rptc) (pthread_t *, const pthread_attr_t *, void* (*start_routine)(void *), void *);
-    int ret;
-    static int reallpthrindex = 0;
-    static int npinned = 0;
-    static int ncalled = 0;
-    static int overflow = 0;
-    static int overflowed = 0;
-    static int silent = 0;
-    static int pin_ids[MAX_NUM_THREADS];
-    static uint64_t skipMask = 0x0;
-    static int ncpus = 0;
+    int len = 0;
+    if ((str[0] == '0') && ((str[1] == 'x') || (str[1] == 'X')))
+    {
+        str += 2;
+    }
+    len = strlen(str);
+    skipMaskBits = 4 * len;
+    skipMask = (uint8_t*) calloc((skipMaskBits + 7) / 8 + 1, sizeof(uint8_t));
+    if (!skipMask)
+    {
+        skipMaskBits = 0;
+        return;
+    }
+    for (int i = 0; i < len; i++)
+    {
+        char c = str[len - 1 - i];
+        int digit = 0;
+        if ((c >= '0') && (c <= '9'))
+            digit = c - '0';
+        else if ((c >= 'a') && (c <= 'f'))
+            digit = c - 'a' + 10;
+        else if ((c >= 'A') && (c <= 'F'))
+            digit = c - 'A' + 10;
+        skipMask[(4*i)/8] |= (uint8_t)(digit << ((4*i)%8));
+    }
+}
 
-    /* On first entry: Get Evironment Variable and initialize pin_ids */
-    if (ncalled == 0)
+static int
+skipByMask(int index)
+{
+    if ((skipMask == NULL) || (index >= skipMaskBits))
     {
-        char *str;
-        char *token, *saveptr;
-        char *delimiter = ",";
-        int i = 0;
-        cpu_set_t cpuset;
+        return 0;
+    }
+    return (skipMask[index/8] >> (index%8)) & 0x1;
+}
 
-        str = getenv("LIKWID_SKIP");
-        if (str != NULL)
+static int
+parsePatterns(const char* str, char** patterns)
+{
+    int count = 0;
+    char *copy, *token, *saveptr;
+    if (str == NULL)
+    {
+        return 0;
+    }
+    copy = strdup(str);
+    if (!copy)
+    {
+        return 0;
+    }
+    token = strtok_r(copy, ",", &saveptr);
+    while (token && count < MAX_PATTERNS)
+    {
+        patterns[count++] = strdup(token);
+        token = strtok_r(NULL, ",", &saveptr);
+    }
+    free(copy);
+    return count;
+}
+
+static int
+matchPatterns(const char* str, char** patterns, int numPatterns)
+{
+    if (str == NULL)
+    {
+        return 0;
+    }
+    for (int i = 0; i < numPatterns; i++)
+    {
+        if (patterns[i] && strstr(str, patterns[i]))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Check whether the caller of pthread_create or the start routine belong to
+ * a library or function listed in LIKWID_SKIP_CALLER */
+static int
+skipByCaller(void* caller, void* routine)
+{
+    Dl_info info;
+    void* addrs[2] = {caller, routine};
+    if (numCallerPatterns == 0)
+    {
+        return 0;
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        if (addrs[i] && dladdr(addrs[i], &info))
         {
-            skipMask = strtoul(str, &str, 16);
+            if (matchPatterns(info.dli_fname, callerPatterns, numCallerPatterns) ||
+                matchPatterns(info.dli_sname, callerPatterns, numCallerPatterns))
+            {
+                return 1;
+            }
         }
-        else if ( skipMask == 0x0 )
+    }
+    return 0;
+}
+
+static int
+readPackage(int cpu)
+{
+    char path[256];
+    int package = -1;
+    FILE* fp = NULL;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    fp = fopen(path, "r");
+    if (fp)
+    {
+        if (fscanf(fp, "%d", &package) != 1)
         {
-            dlerror();    /* Clear any existing error */
-            dlsym(RTLD_DEFAULT,"__kmpc_begin");
+            package = -1;
+        }
+        fclose(fp);
+    }
+    return package;
+}
 
-            if (( dlerror()) == NULL)  {
-                skipMask = 0x1;
+/* Select the pin slot with the fewest threads in the package of the
+ * creating thread. Falls back to all slots if none is in that package. */
+static int
+leastLoadedSlot(void)
+{
+    int cpu = sched_getcpu();
+    int package = (cpu >= 0 ? readPackage(cpu) : -1);
+    int best = -1;
+    for (int pass = 0; pass < 2 && best < 0; pass++)
+    {
+        for (int i = 0; i < ncpus; i++)
+        {
+            if ((pass == 0) && (pin_package[i] != package))
+            {
+                continue;
+            }
+            if ((best < 0) || (pin_load[i] < pin_load[best]))
+            {
+                best = i;
             }
         }
+    }
+    return (best < 0 ? 0 : best);
+}
 
+static void
+rememberThread(pthread_t thread, int slot)
+{
+    if (numPinnedThreads == maxPinnedThreads)
+    {
+        int newmax = (maxPinnedThreads ? 2 * maxPinnedThreads : 64);
+        PinnedThread* tmp = realloc(pinnedThreads, newmax * sizeof(PinnedThread));
+        if (!tmp)
+        {
+            return;
+        }
+        pinnedThreads = tmp;
+        maxPinnedThreads = newmax;
+    }
+    pinnedThreads[numPinnedThreads].thread = thread;
+    pinnedThreads[numPinnedThreads].slot = slot;
+    numPinnedThreads++;
+}
 
-        if (getenv("LIKWID_SILENT") != NULL)
+/* Called when a thread exits, its pin slot is no longer loaded and the
+ * pthread_t value may be reused by glibc for a new thread */
+static void
+forgetThread(void* arg)
+{
+    pthread_t self = pthread_self();
+
+    pthread_mutex_lock(&pin_lock);
+    for (int i = 0; i < numPinnedThreads; i++)
+    {
+        if (pthread_equal(pinnedThreads[i].thread, self))
         {
-            silent = 1;
+            pin_load[pinnedThreads[i].slot]--;
+            pinnedThreads[i] = pinnedThreads[--numPinnedThreads];
+            break;
         }
+    }
+    pthread_mutex_unlock(&pin_lock);
+}
+
+static void*
+trackedStart(void* arg)
+{
+    ThreadStart start;
+    void* ret = NULL;
 
+    /* Wait until the creating thread pinned and remembered this thread,
+     * otherwise an early exit could not be forgotten */
+    pthread_mutex_lock(&pin_lock);
+    while (!((ThreadStart*) arg)->pinned)
+    {
+        pthread_cond_wait(&pin_cond, &pin_lock);
+    }
+    pthread_mutex_unlock(&pin_lock);
+    start = *((ThreadStart*) arg);
+    free(arg);
+    pthread_cleanup_push(forgetThread, NULL);
+    ret = start.start_routine(start.arg);
+    pthread_cleanup_pop(1);
+    return ret;
+}
+
+static void
+initPinning(void)
+{
+    char *str;
+    char *token, *saveptr;
+    char *delimiter = ",";
+    int i = 0;
+    cpu_set_t cpuset;
+
+    str = getenv("LIKWID_SKIP");
+    if (str != NULL)
+    {
+        parseSkipMask(str);
+    }
+    else
+    {
+        dlerror();    /* Clear any existing error */
+        dlsym(RTLD_DEFAULT,"__kmpc_begin");
+
+        if (( dlerror()) == NULL)  {
+            parseSkipMask("0x1");
+        }
+    }
+    numCallerPatterns = parsePatterns(getenv("LIKWID_SKIP_CALLER"), callerPatterns);
+    numNamePatterns = parsePatterns(getenv("LIKWID_SKIP_NAME"), namePatterns);
+    str = getenv("LIKWID_PIN_OVERFLOW");
+    if ((str != NULL) && (strcmp(str, "leastloaded") == 0))
+    {
+        leastloaded = 1;
+    }
+
+    if (getenv("LIKWID_SILENT") != NULL)
+    {
+        silent = 1;
+    }
+
+    if (!silent)
+    {
+        color_print("[pthread wrapper] \n");
+    }
+
+    str = getenv("LIKWID_PIN");
+    if (str != NULL)
+    {
+        str = strdup(str);
+        token = (str ? strtok_r(str,delimiter,&saveptr) : NULL);
+        while (token && ncpus < MAX_NUM_THREADS)
+        {
+            ncpus++;
+            pin_ids[i] = strtoul(token, NULL, 10);
+            pin_package[i] = readPackage(pin_ids[i]);
+            pin_load[i] = 0;
+            i++;
+            token = strtok_r(NULL,delimiter,&saveptr);
+        }
+        free(str);
+    }
+    if (ncpus > 0)
+    {
+        CPU_ZERO(&cpuset);
+        CPU_SET(pin_ids[ncpus-1], &cpuset);
+        sched_setaffinity(getpid(), sizeof(cpu_set_t), &cpuset);
         if (!silent)
         {
-            color_print("[pthread wrapper] \n");
+            color_print("[pthread wrapper] MAIN -> %d\n",pin_ids[ncpus-1]);
         }
+        //ncpus--; /* last ID is the first (the process was pinned to) */
+    }
+    else
+    {
+        color_print("[pthread wrapper] ERROR: Environment Variabel LIKWID_PIN not set!\n");
+    }
+
+    if (!silent)
+    {
+        color_print("[pthread wrapper] PIN_MASK: ");
 
-        str = getenv("LIKWID_PIN");
-        if (str != NULL)
+        for (int i=0;i<ncpus-1;i++)
         {
-            token = str;
-            while (token)
-            {
-                token = strtok_r(str,delimiter,&saveptr);
-                str = NULL;
-                if (token)
-                {
-                    ncpus++;
-                    pin_ids[i++] = strtoul(token, &token, 10);
-                }
-            }
-            CPU_ZERO(&cpuset);
-            CPU_SET(pin_ids[ncpus-1], &cpuset);
-            ret = sched_setaffinity(getpid(), sizeof(cpu_set_t), &cpuset);
-            if (!silent)
-            {
-                color_print("[pthread wrapper] MAIN -> %d\n",pin_ids[ncpus-1]);
-            }
-            //ncpus--; /* last ID is the first (the process was pinned to) */
+            color_print("%d->%d  ",i,pin_ids[i]);
         }
-        else
+        color_print("\n[pthread wrapper] SKIP MASK: 0x");
+        if (skipMaskBits == 0)
         {
-            color_print("[pthread wrapper] ERROR: Environment Variabel LIKWID_PIN not set!\n");
+            color_print("0");
         }
+        for (int i=((skipMaskBits+7)/8)-1; i>=0; i--)
+        {
+            color_print("%02X", skipMask[i]);
+        }
+        color_print("\n");
+        if (numCallerPatterns > 0)
+        {
+            color_print("[pthread wrapper] SKIP CALLER: %s\n", getenv("LIKWID_SKIP_CALLER"));
+        }
+        if (numNamePatterns > 0)
+        {
+            color_print("[pthread wrapper] SKIP NAME: %s\n", getenv("LIKWID_SKIP_NAME"));
+        }
+    }
 
+    overflow = ncpus-1;
+    initialized = 1;
+}
+
+/* Pin a newly created thread. Returns the pin slot or -1 if skipped. */
+static int
+pinThread(pthread_t thread, int skip)
+{
+    cpu_set_t cpuset;
+    int slot = 0;
+
+    if (skip || (ncpus == 0))
+    {
         if (!silent)
         {
-            color_print("[pthread wrapper] PIN_MASK: ");
-
-            for (int i=0;i<ncpus-1;i++)
-            {
-                color_print("%d->%d  ",i,pin_ids[i]);
-            }
-            color_print("\n[pthread wrapper] SKIP MASK: 0x%llX\n",LLU_CAST skipMask);
+            color_print("\tthreadid %lu -> SKIP \n", thread);
         }
+        return -1;
+    }
+    if (numFreeSlots > 0)
+    {
+        slot = freeSlots[--numFreeSlots];
+        if (!silent)
+        {
+            color_print("\tthreadid %lu -> core %d - OK", thread, pin_ids[slot]);
+        }
+    }
+    else if ((npinned == overflow) && (!overflowed))
+    {
+        slot = npinned%ncpus;
+        if (!silent)
+        {
+            color_print("Roundrobin placement triggered\n\tthreadid %lu -> core %d - OK", thread, pin_ids[slot]);
+        }
+        overflowed = 1;
+        npinned = (npinned+1)%ncpus;
+    }
+    else if (overflowed && leastloaded)
+    {
+        /* late created pool threads go to the least loaded core */
+        slot = leastLoadedSlot();
+        if (!silent)
+        {
+            color_print("\tthreadid %lu -> core %d (least loaded) - OK", thread, pin_ids[slot]);
+        }
+    }
+    else
+    {
+        slot = npinned%ncpus;
+        if (!silent)
+        {
+            color_print("\tthreadid %lu -> core %d - OK", thread, pin_ids[slot]);
+        }
+        npinned++;
+        if ((npinned >= ncpus) && (overflowed))
+        {
+            npinned = 0;
+        }
+    }
+    CPU_ZERO(&cpuset);
+    CPU_SET(pin_ids[slot], &cpuset);
+    pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
+    pin_load[slot]++;
+    rememberThread(thread, slot);
 
-        overflow = ncpus-1;
+    if (!silent)
+    {
+        color_print("\n");
     }
+    return slot;
+}
+
+int __attribute__ ((visibility ("default") ))
+pthread_create(pthread_t* thread,
+        const pthread_attr_t* attr,
+        void* (*start_routine)(void *),
+        void * arg)
+{
+    void *handle;
+    char *error;
+    int (*rptc) (pthread_t *, const pthread_attr_t *, void* (*start_routine)(void *), void *);
+    int ret;
+    static int reallpthrindex = 0;
+    ThreadStart* start = NULL;
+    void* caller = __builtin_return_address(0);
+
+    /* On first entry: Get Evironment Variable and initialize pin_ids */
+    pthread_mutex_lock(&pin_lock);
+    if (!initialized)
+    {
+        initPinning();
+    }
+    pthread_mutex_unlock(&pin_lock);
 
     /* Handle dll related stuff */
     do
@@ -201,58 +552,84 @@ pthread_create(pthread_t* thread,
         return -2;
     }
 
-    ret = (*rptc)(thread, attr, start_routine, arg);
+    start = malloc(sizeof(ThreadStart));
+    if (!start)
+    {
+        dlclose(handle);
+        return EAGAIN;
+    }
+    start->start_routine = start_routine;
+    start->arg = arg;
+    start->pinned = 0;
 
-    /* After thread creation pin the thread */
+    ret = (*rptc)(thread, attr, trackedStart, start);
+
+    /* After thread creation pin the thread, it waits in trackedStart
+     * until it is remembered */
     if (ret == 0)
     {
-        cpu_set_t cpuset;
+        pthread_mutex_lock(&pin_lock);
+        pinThread(*thread, skipByMask(ncalled) ||
+                           skipByCaller(caller, (void*)start_routine));
+        ncalled++;
+        start->pinned = 1;
+        pthread_cond_broadcast(&pin_cond);
+        pthread_mutex_unlock(&pin_lock);
+    }
+    else
+    {
+        free(start);
+    }
 
-        if ((ncalled<64) && (skipMask&(1ULL<<(ncalled))))
-        {
-            if (!silent)
-            {
-                color_print("\tthreadid %lu -> SKIP \n", *thread);
-            }
-        }
-        else
+    fflush(stdout);
+    dlclose(handle);
+
+    return ret;
+}
+
+/* Threads named like a helper thread (LIKWID_SKIP_NAME) give their pin slot
+ * back and are moved to the CPU of the main thread like skipped threads. */
+int __attribute__ ((visibility ("default") ))
+pthread_setname_np(pthread_t thread, const char* name)
+{
+    int (*rpsn) (pthread_t, const char*);
+    int ret;
+
+    rpsn = dlsym(RTLD_NEXT, "pthread_setname_np");
+    if (rpsn == NULL)
+    {
+        return ENOSYS;
+    }
+    ret = (*rpsn)(thread, name);
+    if ((ret != 0) || (numNamePatterns == 0) ||
+        (!matchPatterns(name, namePatterns, numNamePatterns)))
+    {
+        return ret;
+    }
+
+    pthread_mutex_lock(&pin_lock);
+    for (int i = 0; i < numPinnedThreads; i++)
+    {
+        if (pthread_equal(pinnedThreads[i].thread, thread))
         {
+            cpu_set_t cpuset;
+            int slot = pinnedThreads[i].slot;
             CPU_ZERO(&cpuset);
-            CPU_SET(pin_ids[npinned%ncpus], &cpuset);
-            pthread_setaffinity_np(*thread, sizeof(cpu_set_t), &cpuset);
-            if ((npinned == overflow) && (!overflowed))
-            {
-                if (!silent)
-                {
-                    color_print("Roundrobin placement triggered\n\tthreadid %lu -> core %d - OK", *thread, pin_ids[npinned%ncpus]);
-                }
-                overflowed = 1;
-                npinned = (npinned+1)%ncpus;
-            }
-            else
+            CPU_SET(pin_ids[ncpus-1], &cpuset);
+            pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
+            pin_load[slot]--;
+            if (numFreeSlots < MAX_NUM_THREADS)
             {
-                if (!silent)
-                {
-                    color_print("\tthreadid %lu -> core %d - OK", *thread, pin_ids[npinned%ncpus]);
-                }
-                npinned++;
-                if ((npinned >= ncpus) && (overflowed))
-                {
-                    npinned = 0;
-                }
+                freeSlots[numFreeSlots++] = slot;
             }
-
+            pinnedThreads[i] = pinnedThreads[--numPinnedThreads];
             if (!silent)
             {
-                color_print("\n");
+                color_print("\tthreadid %lu (%s) -> SKIP, core %d released\n", thread, name, pin_ids[slot]);
             }
+            break;
         }
     }
-
-    fflush(stdout);
-    ncalled++;
-    dlclose(handle);
-
+    pthread_mutex_unlock(&pin_lock);
     return ret;
 }
-
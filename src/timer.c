@@ -32,8 +32,12 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
 #include <unistd.h>
 #include <sys/time.h>
+#include <sys/stat.h>
 #include <time.h>
 
 #include <types.h>
@@ -41,6 +45,21 @@
 #include <likwid.h>
 #include <cpuid.h>
 
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define TSC_CACHE_VERSION 1
+#define TSC_VERIFY_NSEC 20000000 /* verification window for nominal frequency: 20 ms */
+#define TSC_VERIFY_TOLERANCE 0.002
+#define TSC_BOOTID_LENGTH 64
+
+/* #####   TYPE DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ############## */
+
+typedef struct {
+    uint32_t signature;
+    uint64_t microcode;
+    char bootId[TSC_BOOTID_LENGTH];
+} TscCacheKey;
+
 /* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
 
 static uint64_t baseline = 0ULL;
@@ -207,6 +226,214 @@ _timer_print( const TimerData* time )
     return  ((double) cycles / (double) cyclesClock);
 }
 
+#if defined(__x86_64) || defined(__i386__)
+static int
+readFirstLine(const char* path, char* buff, int len)
+{
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        return -ENOENT;
+    }
+    if (fgets(buff, len, fp) == NULL)
+    {
+        fclose(fp);
+        return -EIO;
+    }
+    fclose(fp);
+    buff[strcspn(buff, "\n")] = '\0';
+    return 0;
+}
+
+/* The TSC frequency is fixed for a CPU model but can change with microcode
+ * updates and is only guaranteed to be stable within one boot. */
+static int
+getTscCacheKey(TscCacheKey* key)
+{
+    uint32_t eax = 0x1, ebx = 0x0, ecx = 0x0, edx = 0x0;
+    char buff[256];
+    FILE* fp = NULL;
+
+    memset(key, 0, sizeof(TscCacheKey));
+    CPUID(eax, ebx, ecx, edx);
+    key->signature = eax;
+
+    if (readFirstLine("/sys/devices/system/cpu/cpu0/microcode/version", buff, sizeof(buff)) == 0)
+    {
+        key->microcode = strtoull(buff, NULL, 16);
+    }
+    else if ((fp = fopen("/proc/cpuinfo", "r")) != NULL)
+    {
+        while (fgets(buff, sizeof(buff), fp) != NULL)
+        {
+            char* ptr = strchr(buff, ':');
+            if ((ptr != NULL) && (strncmp(buff, "microcode", 9) == 0))
+            {
+                key->microcode = strtoull(ptr+1, NULL, 16);
+                break;
+            }
+        }
+        fclose(fp);
+    }
+
+    if (readFirstLine("/proc/sys/kernel/random/boot_id", key->bootId, TSC_BOOTID_LENGTH) != 0)
+    {
+        return -ENOENT;
+    }
+    return 0;
+}
+
+static void
+getTscCachePath(char* path, size_t len)
+{
+    snprintf(path, len, "%s-%d", TOSTRING(TSCFILE), (int)getuid());
+}
+
+static uint64_t
+readTscCache(const TscCacheKey* key)
+{
+    FILE* fp = NULL;
+    struct stat st;
+    char path[1024];
+    char line[256];
+    char value[TSC_BOOTID_LENGTH];
+    int version = 0;
+    int matches = 0;
+    uint64_t hz = 0ULL;
+
+    getTscCachePath(path, sizeof(path));
+    fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        return 0ULL;
+    }
+    if ((fstat(fileno(fp), &st) != 0) || (st.st_uid != getuid()))
+    {
+        fclose(fp);
+        return 0ULL;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (sscanf(line, "version %d", &version) == 1)
+        {
+            continue;
+        }
+        if ((sscanf(line, "signature %63s", value) == 1) &&
+            ((uint32_t)strtoul(value, NULL, 16) == key->signature))
+        {
+            matches++;
+        }
+        else if ((sscanf(line, "microcode %63s", value) == 1) &&
+                 (strtoull(value, NULL, 16) == key->microcode))
+        {
+            matches++;
+        }
+        else if ((sscanf(line, "boot_id %63s", value) == 1) &&
+                 (strcmp(value, key->bootId) == 0))
+        {
+            matches++;
+        }
+        else if (sscanf(line, "tsc_hz %63s", value) == 1)
+        {
+            hz = strtoull(value, NULL, 10);
+        }
+    }
+    fclose(fp);
+    if ((version != TSC_CACHE_VERSION) || (matches != 3))
+    {
+        return 0ULL;
+    }
+    DEBUG_PRINT(DEBUGLEV_DEVELOP, Using TSC frequency %llu Hz from %s, LLU_CAST hz, path);
+    return hz;
+}
+
+static void
+writeTscCache(const TscCacheKey* key, uint64_t hz)
+{
+    FILE* fp = NULL;
+    char path[1024];
+    char tmpfile[1040];
+
+    /* Write to a private file and rename it, so concurrently starting
+     * processes never read a partially written cache. */
+    getTscCachePath(path, sizeof(path));
+    snprintf(tmpfile, sizeof(tmpfile), "%s.%d", path, getpid());
+    fp = fopen(tmpfile, "w");
+    if (fp == NULL)
+    {
+        return;
+    }
+    fprintf(fp, "version %d\n", TSC_CACHE_VERSION);
+    fprintf(fp, "signature 0x%x\n", key->signature);
+    fprintf(fp, "microcode 0x%llx\n", LLU_CAST key->microcode);
+    fprintf(fp, "boot_id %s\n", key->bootId);
+    fprintf(fp, "tsc_hz %llu\n", LLU_CAST hz);
+    if ((fclose(fp) != 0) || (rename(tmpfile, path) != 0))
+    {
+        unlink(tmpfile);
+    }
+}
+
+/* TSC frequency as reported by the hardware or the kernel, 0 if unknown */
+static uint64_t
+getNominalTscHz(void)
+{
+    uint32_t eax = 0x0, ebx = 0x0, ecx = 0x0, edx = 0x0;
+    uint32_t maxLeaf = 0;
+    char buff[256];
+
+    CPUID(eax, ebx, ecx, edx);
+    maxLeaf = eax;
+    /* Leaf 0x15 and 0x16 are only defined for Intel ("GenuineIntel") */
+    if ((ebx == 0x756e6547) && (maxLeaf >= 0x15))
+    {
+        eax = 0x15; ebx = 0x0; ecx = 0x0; edx = 0x0;
+        CPUID(eax, ebx, ecx, edx);
+        if ((eax != 0) && (ebx != 0) && (ecx != 0))
+        {
+            return ((uint64_t)ecx * ebx) / eax;
+        }
+        if (maxLeaf >= 0x16)
+        {
+            eax = 0x16; ebx = 0x0; ecx = 0x0; edx = 0x0;
+            CPUID(eax, ebx, ecx, edx);
+            if ((eax & 0xFFFF) != 0)
+            {
+                return (uint64_t)(eax & 0xFFFF) * 1000000ULL;
+            }
+        }
+    }
+    if (readFirstLine("/sys/devices/system/cpu/cpu0/tsc_freq_khz", buff, sizeof(buff)) == 0)
+    {
+        return strtoull(buff, NULL, 10) * 1000ULL;
+    }
+    return 0ULL;
+}
+
+static uint64_t
+measureTscHz(long nsec)
+{
+    TimerData data;
+    struct timespec ts1;
+    struct timespec ts2;
+    struct timespec delay = { nsec / 1000000000L, nsec % 1000000000L };
+    uint64_t ns = 0ULL;
+
+    _timer_start(&data);
+    clock_gettime(CLOCK_MONOTONIC, &ts1);
+    nanosleep(&delay, NULL);
+    _timer_stop(&data);
+    clock_gettime(CLOCK_MONOTONIC, &ts2);
+    ns = ((uint64_t)ts2.tv_sec * 1000000000ULL + ts2.tv_nsec) -
+         ((uint64_t)ts1.tv_sec * 1000000000ULL + ts1.tv_nsec);
+    if (ns == 0)
+    {
+        return 0ULL;
+    }
+    return (uint64_t)(((double)(data.stop.int64 - data.start.int64) * 1E9) / (double)ns);
+}
+#endif
+
 static void
 getCpuSpeed(void)
 {
@@ -216,6 +443,9 @@ getCpuSpeed(void)
     TscCounter start;
     TscCounter stop;
     uint64_t result = 0xFFFFFFFFFFFFFFFFULL;
+    uint64_t nominal = 0ULL;
+    TscCacheKey key;
+    int validKey = 0;
     struct timeval tv1;
     struct timeval tv2;
     struct timezone tzp;
@@ -229,6 +459,36 @@ getCpuSpeed(void)
     }
 
     baseline = result;
+
+    validKey = (getTscCacheKey(&key) == 0);
+    if (validKey)
+    {
+        cpuClock = readTscCache(&key);
+        if (cpuClock > 0)
+        {
+            cyclesClock = cpuClock;
+            return;
+        }
+    }
+
+    nominal = getNominalTscHz();
+    if (nominal > 0)
+    {
+        uint64_t measured = measureTscHz(TSC_VERIFY_NSEC);
+        if (fabs((double)measured - (double)nominal) <= TSC_VERIFY_TOLERANCE * (double)nominal)
+        {
+            cpuClock = nominal;
+            cyclesClock = cpuClock;
+            if (validKey)
+            {
+                writeTscCache(&key, cpuClock);
+            }
+            return;
+        }
+        DEBUG_PRINT(DEBUGLEV_DEVELOP, Nominal TSC frequency %llu Hz does not match measured %llu Hz,
+                    LLU_CAST nominal, LLU_CAST measured);
+    }
+
     result = 0xFFFFFFFFFFFFFFFFULL;
     data.stop.int64 = 0;
     data.start.int64 = 0;
@@ -248,6 +508,10 @@ getCpuSpeed(void)
         (((uint64_t)tv2.tv_sec * 1000000 + tv2.tv_usec) -
          ((uint64_t)tv1.tv_sec * 1000000 + tv1.tv_usec));
     cyclesClock = cpuClock;
+    if (validKey)
+    {
+        writeTscCache(&key, cpuClock);
+    }
 #endif
 #ifdef _ARCH_PPC
     FILE *fpipe;
@@ -40,6 +40,7 @@
 #include <likwid.h>
 
 #include <topology.h>
+#include <topology_cache.h>
 #include <error.h>
 #include <tree.h>
 #include <bitUtil.h>
@@ -823,6 +824,21 @@ topology_functions topology_funcs = {
 };
 
 
+static void
+topology_setActiveThreads(cpu_set_t* cpuSet)
+{
+    cpuid_topology.activeHWThreads = 0;
+    for (int i=0;i<cpuid_topology.numHWThreads;i++)
+    {
+        cpuid_topology.threadPool[i].inCpuSet = 0;
+        if (CPU_ISSET(cpuid_topology.threadPool[i].apicId, cpuSet))
+        {
+            cpuid_topology.activeHWThreads++;
+            cpuid_topology.threadPool[i].inCpuSet = 1;
+        }
+    }
+}
+
 void topology_setupTree(void)
 {
     uint32_t i;
@@ -893,6 +909,16 @@ topology_init(void)
 
     if ((config.topologyCfgFileName == NULL) || access(config.topologyCfgFileName, R_OK))
     {
+        if (topology_cache_load() == 0)
+        {
+            CPU_ZERO(&cpuSet);
+            sched_getaffinity(0,sizeof(cpu_set_t), &cpuSet);
+            topology_setActiveThreads(&cpuSet);
+            topology_setName();
+            topology_setupTree();
+            topology_initialized = 1;
+            return EXIT_SUCCESS;
+        }
 standard_init:
         CPU_ZERO(&cpuSet);
         sched_getaffinity(0,sizeof(cpu_set_t), &cpuSet);
@@ -927,15 +953,7 @@ standard_init:
         ret = readTopologyFile(config.topologyCfgFileName);
         if (ret < 0)
             goto standard_init;
-        cpuid_topology.activeHWThreads = 0;
-        for (int i=0;i<cpuid_topology.numHWThreads;i++)
-        {
-            if (CPU_ISSET(cpuid_topology.threadPool[i].apicId, &cpuSet))
-            {
-                cpuid_topology.activeHWThreads++;
-                cpuid_topology.threadPool[i].inCpuSet = 1;
-            }
-        }
+        topology_setActiveThreads(&cpuSet);
         topology_setName();
         topology_setupTree();
     }
@@ -983,6 +1001,7 @@ topology_finalize(void)
     {
         topology_funcs.close_topology();
     }
+    topology_cache_finalize();
     cpuid_info.family = 0;
     cpuid_info.model = 0;
     cpuid_info.stepping = 0;
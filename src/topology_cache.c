@@ -0,0 +1,608 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  topology_cache.c
+ *
+ *      Description:  Cached snapshot of CPU topology, NUMA, PCI and affinity domains
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Roehl (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/utsname.h>
+
+#include <types.h>
+#include <error.h>
+#include <likwid.h>
+#include <bstrlib.h>
+#include <configuration.h>
+#include <topology.h>
+#include <topology_cache.h>
+#ifdef LIKWID_USE_HWLOC
+#include <topology_hwloc.h>
+#endif
+
+/* #####   TYPE DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ############## */
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+    int failed;
+} CacheBuffer;
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+static char* cacheData = NULL;
+static size_t cacheSize = 0;
+static int cacheLoaded = 0;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static void
+getCachePath(char* path, size_t len)
+{
+    snprintf(path, len, "%s-%d", TOSTRING(TOPOCACHE), (int)getuid());
+}
+
+static int
+getFingerprint(TopologyCacheFingerprint* fp)
+{
+    FILE* file = NULL;
+    struct utsname uts;
+
+    memset(fp, 0, sizeof(TopologyCacheFingerprint));
+    file = fopen("/proc/sys/kernel/random/boot_id", "r");
+    if (file == NULL)
+    {
+        return -ENOENT;
+    }
+    if (fgets(fp->bootId, sizeof(fp->bootId), file) == NULL)
+    {
+        fclose(file);
+        return -EIO;
+    }
+    fclose(file);
+    fp->bootId[strcspn(fp->bootId, "\n")] = '\0';
+    if (uname(&uts) != 0)
+    {
+        return -errno;
+    }
+    snprintf(fp->kernelRelease, sizeof(fp->kernelRelease), "%s", uts.release);
+    snprintf(fp->kernelVersion, sizeof(fp->kernelVersion), "%s", uts.version);
+    fp->numHWThreads = sysconf(_SC_NPROCESSORS_CONF);
+    return 0;
+}
+
+static int
+validRange(uint64_t offset, uint64_t count, uint64_t size)
+{
+    if ((offset == 0) || (offset > cacheSize))
+    {
+        return 0;
+    }
+    if ((size != 0) && (count > (cacheSize - offset) / size))
+    {
+        return 0;
+    }
+    return 1;
+}
+
+static char*
+copyString(uint64_t offset)
+{
+    if ((!validRange(offset, 1, 1)) ||
+        (memchr(cacheData + offset, '\0', cacheSize - offset) == NULL))
+    {
+        return NULL;
+    }
+    return strdup(cacheData + offset);
+}
+
+static void*
+copyArray(uint64_t offset, uint64_t count, size_t size)
+{
+    void* ptr = NULL;
+    if ((count == 0) || (!validRange(offset, count, size)))
+    {
+        return NULL;
+    }
+    ptr = malloc(count * size);
+    if (ptr != NULL)
+    {
+        memcpy(ptr, cacheData + offset, count * size);
+    }
+    return ptr;
+}
+
+static void
+refreshFreeMemory(NumaNode* node)
+{
+    FILE* fp = NULL;
+    char filename[256];
+    char line[256];
+    unsigned long long value = 0;
+
+    snprintf(filename, sizeof(filename), "/sys/devices/system/node/node%u/meminfo", node->id);
+    fp = fopen(filename, "r");
+    if (fp == NULL)
+    {
+        return;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        char* ptr = strstr(line, "MemFree:");
+        if ((ptr != NULL) && (sscanf(ptr, "MemFree: %llu", &value) == 1))
+        {
+            node->freeMemory = value;
+            break;
+        }
+    }
+    fclose(fp);
+}
+
+static uint64_t
+appendData(CacheBuffer* buf, const void* data, size_t size)
+{
+    size_t offset = (buf->size + 7) & ~((size_t)7);
+    if (buf->failed)
+    {
+        return 0;
+    }
+    if (offset + size > buf->capacity)
+    {
+        size_t capacity = (buf->capacity > 0 ? buf->capacity : 65536);
+        char* tmp = NULL;
+        while (offset + size > capacity)
+        {
+            capacity *= 2;
+        }
+        tmp = realloc(buf->data, capacity);
+        if (tmp == NULL)
+        {
+            buf->failed = 1;
+            return 0;
+        }
+        memset(tmp + buf->capacity, 0, capacity - buf->capacity);
+        buf->data = tmp;
+        buf->capacity = capacity;
+    }
+    if (data != NULL)
+    {
+        memcpy(buf->data + offset, data, size);
+    }
+    buf->size = offset + size;
+    return offset;
+}
+
+static uint64_t
+appendString(CacheBuffer* buf, const char* str)
+{
+    if (str == NULL)
+    {
+        return 0;
+    }
+    return appendData(buf, str, strlen(str) + 1);
+}
+
+static void
+appendPciDevices(CacheBuffer* buf, TopologyCacheHeader* hdr)
+{
+#ifdef LIKWID_USE_HWLOC
+    int i;
+    int count = 0;
+    hwloc_obj_t obj;
+    hwloc_topology_t topo = hwloc_topology;
+    TopologyCachePciDevice dev;
+
+    /* A topology loaded only for the PCI devices is not kept */
+    if (!topo)
+    {
+        likwid_hwloc_topology_init(&topo);
+        likwid_hwloc_topology_set_flags(topo, HWLOC_TOPOLOGY_FLAG_WHOLE_IO );
+        likwid_hwloc_topology_load(topo);
+    }
+    count = likwid_hwloc_get_nbobjs_by_type(topo, HWLOC_OBJ_PCI_DEVICE);
+    for (i = 0; i < count; i++)
+    {
+        uint64_t offset;
+        obj = likwid_hwloc_get_obj_by_type(topo, HWLOC_OBJ_PCI_DEVICE, i);
+        memset(&dev, 0, sizeof(TopologyCachePciDevice));
+        dev.vendorId = obj->attr->pcidev.vendor_id;
+        dev.deviceId = obj->attr->pcidev.device_id;
+        dev.bus = obj->attr->pcidev.bus;
+        offset = appendData(buf, &dev, sizeof(TopologyCachePciDevice));
+        if (hdr->numberOfPciDevices == 0)
+        {
+            hdr->pciDevicesOffset = offset;
+        }
+        hdr->numberOfPciDevices++;
+    }
+    if (topo != hwloc_topology)
+    {
+        likwid_hwloc_topology_destroy(topo);
+    }
+#endif
+}
+
+static void
+releaseLoaded(void)
+{
+    uint32_t i;
+
+    free(cpuid_info.osname);
+    free(cpuid_info.features);
+    free(cpuid_topology.threadPool);
+    free(cpuid_topology.cacheLevels);
+    if (numa_info.nodes != NULL)
+    {
+        for (i = 0; i < numa_info.numberOfNodes; i++)
+        {
+            free(numa_info.nodes[i].processors);
+            free(numa_info.nodes[i].distances);
+        }
+        free(numa_info.nodes);
+    }
+    memset(&cpuid_info, 0, sizeof(CpuInfo));
+    memset(&cpuid_topology, 0, sizeof(CpuTopology));
+    memset(&numa_info, 0, sizeof(NumaTopology));
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+topology_cache_load(void)
+{
+    int fd = -1;
+    char path[1024];
+    struct stat st;
+    TopologyCacheFingerprint fingerprint;
+    TopologyCacheHeader* hdr = NULL;
+    TopologyCacheNode* nodes = NULL;
+    uint32_t i;
+
+    if (cacheLoaded)
+    {
+        return 0;
+    }
+    if (getFingerprint(&fingerprint) < 0)
+    {
+        return -ENOENT;
+    }
+    getCachePath(path, sizeof(path));
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -ENOENT;
+    }
+    if ((fstat(fd, &st) != 0) || (st.st_uid != getuid()) ||
+        (st.st_size < (off_t)sizeof(TopologyCacheHeader)))
+    {
+        close(fd);
+        return -EINVAL;
+    }
+    cacheSize = st.st_size;
+    cacheData = (char*) malloc(cacheSize);
+    if (cacheData == NULL)
+    {
+        close(fd);
+        cacheSize = 0;
+        return -ENOMEM;
+    }
+    for (size_t done = 0; done < cacheSize; )
+    {
+        ssize_t ret = read(fd, cacheData + done, cacheSize - done);
+        if (ret <= 0)
+        {
+            if ((ret < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            close(fd);
+            topology_cache_finalize();
+            return -EIO;
+        }
+        done += ret;
+    }
+    close(fd);
+    hdr = (TopologyCacheHeader*)cacheData;
+    if ((memcmp(hdr->magic, TOPOLOGY_CACHE_MAGIC, sizeof(hdr->magic)) != 0) ||
+        (hdr->version != TOPOLOGY_CACHE_VERSION) ||
+        (hdr->headerSize != sizeof(TopologyCacheHeader)) ||
+        (hdr->fileSize != cacheSize) ||
+        (memcmp(&hdr->fingerprint, &fingerprint, sizeof(TopologyCacheFingerprint)) != 0) ||
+        (!validRange(hdr->threadPoolOffset, hdr->cpuTopology.numHWThreads, sizeof(HWThread))) ||
+        (!validRange(hdr->cacheLevelsOffset, hdr->cpuTopology.numCacheLevels, sizeof(CacheLevel))) ||
+        (!validRange(hdr->nodesOffset, hdr->numberOfNodes, sizeof(TopologyCacheNode))) ||
+        (hdr->numberOfNodes == 0))
+    {
+        DEBUG_PRINT(DEBUGLEV_DEVELOP, Topology cache %s is outdated or invalid, path);
+        topology_cache_finalize();
+        return -EINVAL;
+    }
+    nodes = (TopologyCacheNode*)(cacheData + hdr->nodesOffset);
+    for (i = 0; i < hdr->numberOfNodes; i++)
+    {
+        if ((!validRange(nodes[i].processorsOffset, nodes[i].numberOfProcessors, sizeof(uint32_t))) ||
+            (!validRange(nodes[i].distancesOffset, nodes[i].numberOfDistances, sizeof(uint32_t))))
+        {
+            topology_cache_finalize();
+            return -EINVAL;
+        }
+    }
+
+    cpuid_info = hdr->cpuInfo;
+    cpuid_info.osname = copyString(hdr->osnameOffset);
+    cpuid_info.features = copyString(hdr->featuresOffset);
+    cpuid_info.name = NULL;
+    cpuid_info.short_name = NULL;
+
+    cpuid_topology = hdr->cpuTopology;
+    cpuid_topology.threadPool = copyArray(hdr->threadPoolOffset,
+                                          hdr->cpuTopology.numHWThreads, sizeof(HWThread));
+    cpuid_topology.cacheLevels = copyArray(hdr->cacheLevelsOffset,
+                                           hdr->cpuTopology.numCacheLevels, sizeof(CacheLevel));
+    cpuid_topology.topologyTree = NULL;
+
+    numa_info.numberOfNodes = hdr->numberOfNodes;
+    numa_info.nodes = (NumaNode*) calloc(hdr->numberOfNodes, sizeof(NumaNode));
+    if ((cpuid_topology.threadPool == NULL) || (cpuid_topology.cacheLevels == NULL) ||
+        (numa_info.nodes == NULL))
+    {
+        goto nomem;
+    }
+    for (i = 0; i < hdr->numberOfNodes; i++)
+    {
+        numa_info.nodes[i].id = nodes[i].id;
+        numa_info.nodes[i].totalMemory = nodes[i].totalMemory;
+        numa_info.nodes[i].freeMemory = nodes[i].freeMemory;
+        numa_info.nodes[i].numberOfProcessors = nodes[i].numberOfProcessors;
+        numa_info.nodes[i].numberOfDistances = nodes[i].numberOfDistances;
+        numa_info.nodes[i].processors = copyArray(nodes[i].processorsOffset,
+                                                  nodes[i].numberOfProcessors, sizeof(uint32_t));
+        numa_info.nodes[i].distances = copyArray(nodes[i].distancesOffset,
+                                                 nodes[i].numberOfDistances, sizeof(uint32_t));
+        if (((nodes[i].numberOfProcessors > 0) && (numa_info.nodes[i].processors == NULL)) ||
+            ((nodes[i].numberOfDistances > 0) && (numa_info.nodes[i].distances == NULL)))
+        {
+            goto nomem;
+        }
+        refreshFreeMemory(&numa_info.nodes[i]);
+    }
+    DEBUG_PRINT(DEBUGLEV_INFO, Reading topology information from cache %s, path);
+    cacheLoaded = 1;
+    return 0;
+nomem:
+    /* Leave nothing half filled behind for the regular topology discovery */
+    ERROR_PLAIN_PRINT(Cannot allocate topology structures from cache);
+    releaseLoaded();
+    topology_cache_finalize();
+    return -ENOMEM;
+}
+
+int
+topology_cache_isLoaded(void)
+{
+    return cacheLoaded;
+}
+
+int
+topology_cache_loadAffinity(AffinityDomains* affinity)
+{
+    TopologyCacheHeader* hdr = (TopologyCacheHeader*)cacheData;
+    TopologyCacheDomain* cached = NULL;
+    AffinityDomain* domains = NULL;
+    uint32_t i;
+
+    /* The domains only contain the HW threads of the process CPU set,
+     * the cached ones are valid for a process that may run everywhere. */
+    if ((!cacheLoaded) || (cpuid_topology.activeHWThreads != cpuid_topology.numHWThreads) ||
+        (hdr->affinity.numberOfAffinityDomains == 0) ||
+        (!validRange(hdr->domainsOffset, hdr->affinity.numberOfAffinityDomains, sizeof(TopologyCacheDomain))))
+    {
+        return -ENOENT;
+    }
+    cached = (TopologyCacheDomain*)(cacheData + hdr->domainsOffset);
+    for (i = 0; i < hdr->affinity.numberOfAffinityDomains; i++)
+    {
+        if ((cached[i].numberOfProcessors > 0) &&
+            (!validRange(cached[i].processorListOffset, cached[i].numberOfProcessors, sizeof(int))))
+        {
+            return -EINVAL;
+        }
+    }
+    domains = (AffinityDomain*) malloc(hdr->affinity.numberOfAffinityDomains * sizeof(AffinityDomain));
+    if (domains == NULL)
+    {
+        return -ENOMEM;
+    }
+    for (i = 0; i < hdr->affinity.numberOfAffinityDomains; i++)
+    {
+        domains[i].tag = blk2bstr(cached[i].tag, strnlen(cached[i].tag, sizeof(cached[i].tag)));
+        domains[i].numberOfProcessors = cached[i].numberOfProcessors;
+        domains[i].numberOfCores = cached[i].numberOfCores;
+        domains[i].processorList = (int*) malloc(MAX(cached[i].numberOfProcessors, 1) * sizeof(int));
+        if (domains[i].processorList != NULL && cached[i].numberOfProcessors > 0)
+        {
+            memcpy(domains[i].processorList, cacheData + cached[i].processorListOffset,
+                   cached[i].numberOfProcessors * sizeof(int));
+        }
+    }
+    *affinity = hdr->affinity;
+    affinity->domains = domains;
+    return 0;
+}
+
+int
+topology_cache_store(const AffinityDomains* affinity)
+{
+    int fd = -1;
+    uint32_t i;
+    char path[1024];
+    char tmppath[1100];
+    CacheBuffer buf = { NULL, 0, 0, 0 };
+    TopologyCacheHeader hdr;
+    TopologyCacheNode* nodes = NULL;
+    TopologyCacheDomain* domains = NULL;
+
+    /* Only complete views of the machine are cached */
+    if ((cacheLoaded) || (cpuid_topology.activeHWThreads != cpuid_topology.numHWThreads) ||
+        (numa_info.nodes == NULL) || (numa_info.numberOfNodes == 0) ||
+        ((config.topologyCfgFileName != NULL) && (!access(config.topologyCfgFileName, R_OK))))
+    {
+        return 0;
+    }
+    memset(&hdr, 0, sizeof(TopologyCacheHeader));
+    if (getFingerprint(&hdr.fingerprint) < 0)
+    {
+        return -ENOENT;
+    }
+    memcpy(hdr.magic, TOPOLOGY_CACHE_MAGIC, sizeof(hdr.magic));
+    hdr.version = TOPOLOGY_CACHE_VERSION;
+    hdr.headerSize = sizeof(TopologyCacheHeader);
+    hdr.cpuInfo = cpuid_info;
+    hdr.cpuTopology = cpuid_topology;
+
+    appendData(&buf, NULL, sizeof(TopologyCacheHeader));
+    hdr.osnameOffset = appendString(&buf, cpuid_info.osname);
+    hdr.featuresOffset = appendString(&buf, cpuid_info.features);
+    hdr.threadPoolOffset = appendData(&buf, cpuid_topology.threadPool,
+                                      cpuid_topology.numHWThreads * sizeof(HWThread));
+    hdr.cacheLevelsOffset = appendData(&buf, cpuid_topology.cacheLevels,
+                                       cpuid_topology.numCacheLevels * sizeof(CacheLevel));
+
+    hdr.numberOfNodes = numa_info.numberOfNodes;
+    hdr.nodesOffset = appendData(&buf, NULL, numa_info.numberOfNodes * sizeof(TopologyCacheNode));
+    for (i = 0; i < numa_info.numberOfNodes && !buf.failed; i++)
+    {
+        uint64_t processors = appendData(&buf, numa_info.nodes[i].processors,
+                                numa_info.nodes[i].numberOfProcessors * sizeof(uint32_t));
+        uint64_t distances = appendData(&buf, numa_info.nodes[i].distances,
+                                numa_info.nodes[i].numberOfDistances * sizeof(uint32_t));
+        nodes = (TopologyCacheNode*)(buf.data + hdr.nodesOffset);
+        nodes[i].id = numa_info.nodes[i].id;
+        nodes[i].numberOfProcessors = numa_info.nodes[i].numberOfProcessors;
+        nodes[i].numberOfDistances = numa_info.nodes[i].numberOfDistances;
+        nodes[i].totalMemory = numa_info.nodes[i].totalMemory;
+        nodes[i].freeMemory = numa_info.nodes[i].freeMemory;
+        nodes[i].processorsOffset = processors;
+        nodes[i].distancesOffset = distances;
+    }
+
+    if ((affinity != NULL) && (affinity->domains != NULL))
+    {
+        hdr.affinity = *affinity;
+        hdr.affinity.domains = NULL;
+        hdr.domainsOffset = appendData(&buf, NULL,
+                                affinity->numberOfAffinityDomains * sizeof(TopologyCacheDomain));
+        for (i = 0; i < affinity->numberOfAffinityDomains && !buf.failed; i++)
+        {
+            uint64_t list = appendData(&buf, affinity->domains[i].processorList,
+                                affinity->domains[i].numberOfProcessors * sizeof(int));
+            domains = (TopologyCacheDomain*)(buf.data + hdr.domainsOffset);
+            snprintf(domains[i].tag, sizeof(domains[i].tag), "%s",
+                     (affinity->domains[i].tag && bdata(affinity->domains[i].tag) ?
+                      bdata(affinity->domains[i].tag) : ""));
+            domains[i].numberOfProcessors = affinity->domains[i].numberOfProcessors;
+            domains[i].numberOfCores = affinity->domains[i].numberOfCores;
+            domains[i].processorListOffset = list;
+        }
+    }
+    appendPciDevices(&buf, &hdr);
+    if (buf.failed)
+    {
+        free(buf.data);
+        return -ENOMEM;
+    }
+    hdr.fileSize = buf.size;
+    memcpy(buf.data, &hdr, sizeof(TopologyCacheHeader));
+
+    /* Write to a private file and rename it, so concurrently starting
+     * processes never map a partially written snapshot. */
+    getCachePath(path, sizeof(path));
+    snprintf(tmppath, sizeof(tmppath), "%s.%d", path, getpid());
+    fd = open(tmppath, O_WRONLY|O_CREAT|O_EXCL, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+    if (fd < 0)
+    {
+        free(buf.data);
+        return -errno;
+    }
+    if ((write(fd, buf.data, buf.size) != (ssize_t)buf.size) ||
+        (close(fd) != 0) || (rename(tmppath, path) != 0))
+    {
+        unlink(tmppath);
+        free(buf.data);
+        return -EIO;
+    }
+    DEBUG_PRINT(DEBUGLEV_DEVELOP, Stored topology cache %s, path);
+    free(buf.data);
+    return 0;
+}
+
+int
+topology_cache_getPciBuses(uint16_t vendorId, uint16_t deviceId, char** socket_bus, int* nrSockets)
+{
+    TopologyCacheHeader* hdr = (TopologyCacheHeader*)cacheData;
+    TopologyCachePciDevice* devs = NULL;
+    uint32_t i;
+    int cntr = 0;
+
+    if ((!cacheLoaded) || (hdr->numberOfPciDevices == 0) ||
+        (!validRange(hdr->pciDevicesOffset, hdr->numberOfPciDevices, sizeof(TopologyCachePciDevice))))
+    {
+        return -ENOENT;
+    }
+    devs = (TopologyCachePciDevice*)(cacheData + hdr->pciDevicesOffset);
+    for (i = 0; i < hdr->numberOfPciDevices; i++)
+    {
+        if ((devs[i].vendorId == vendorId) && (devs[i].deviceId == deviceId))
+        {
+            socket_bus[cntr] = (char*)malloc(4);
+            sprintf(socket_bus[cntr++], "%02x/", devs[i].bus);
+        }
+    }
+    *nrSockets = cntr;
+    if (cntr == 0)
+    {
+        return -ENODEV;
+    }
+    return 0;
+}
+
+void
+topology_cache_finalize(void)
+{
+    free(cacheData);
+    cacheData = NULL;
+    cacheSize = 0;
+    cacheLoaded = 0;
+}
@@ -35,6 +35,7 @@
 #include <stdio.h>
 #include <sched.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include <error.h>
 #include <tree.h>
@@ -47,6 +48,17 @@
 /* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
 
 #define MAX_CACHE_LEVELS 4
+#define CPUID_PROBE_BATCH 64
+
+/* #####   TYPE DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ############## */
+
+/* CPUID leaves of one HW thread needed to build its HWThread entry */
+typedef struct {
+    int cpu;
+    int useBLeaf;
+    uint32_t leaf1Ebx;
+    uint32_t leafB[3][4];
+} CpuidProbe;
 
 /* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
 
@@ -519,6 +531,93 @@ cpuid_init_cpuFeatures(void)
     return;
 }
 
+static void
+probeCpuid(CpuidProbe* probe)
+{
+    uint32_t a, b, c, d;
+    a = 0x01;
+    c = 0;
+    CPUID(a, b, c, d);
+    probe->leaf1Ebx = b;
+    if (probe->useBLeaf)
+    {
+        for (int level = 0; level < 3; level++)
+        {
+            a = 0x0B;
+            c = level;
+            CPUID(a, b, c, d);
+            probe->leafB[level][0] = a;
+            probe->leafB[level][1] = b;
+            probe->leafB[level][2] = c;
+            probe->leafB[level][3] = d;
+        }
+    }
+}
+
+static void*
+probeCpuidThread(void* arg)
+{
+    probeCpuid((CpuidProbe*) arg);
+    return NULL;
+}
+
+/* Execute the CPUID probes on all HW threads. Instead of migrating the
+ * calling thread to each HW thread in turn, short-lived worker threads are
+ * created already pinned to their HW thread, CPUID_PROBE_BATCH at a time.
+ * HW threads for which no worker can be started are probed serially. */
+static void
+probeAllCpuid(CpuidProbe* probes, int numHWThreads)
+{
+    pthread_t threads[CPUID_PROBE_BATCH];
+    int started[CPUID_PROBE_BATCH];
+    cpu_set_t set;
+    cpu_set_t origSet;
+    int migrated = 0;
+
+    CPU_ZERO(&origSet);
+    sched_getaffinity(0, sizeof(cpu_set_t), &origSet);
+    for (int start = 0; start < numHWThreads; start += CPUID_PROBE_BATCH)
+    {
+        int end = MIN(start + CPUID_PROBE_BATCH, numHWThreads);
+        for (int i = start; i < end; i++)
+        {
+            pthread_attr_t attr;
+            started[i-start] = 0;
+            CPU_ZERO(&set);
+            CPU_SET(probes[i].cpu, &set);
+            if (pthread_attr_init(&attr) != 0)
+            {
+                continue;
+            }
+            if ((pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &set) == 0) &&
+                (pthread_create(&threads[i-start], &attr, probeCpuidThread, &probes[i]) == 0))
+            {
+                started[i-start] = 1;
+            }
+            pthread_attr_destroy(&attr);
+        }
+        for (int i = start; i < end; i++)
+        {
+            if (started[i-start])
+            {
+                pthread_join(threads[i-start], NULL);
+            }
+            else
+            {
+                CPU_ZERO(&set);
+                CPU_SET(probes[i].cpu, &set);
+                sched_setaffinity(0, sizeof(cpu_set_t), &set);
+                probeCpuid(&probes[i]);
+                migrated = 1;
+            }
+        }
+    }
+    if (migrated)
+    {
+        sched_setaffinity(0, sizeof(cpu_set_t), &origSet);
+    }
+}
+
 void
 cpuid_init_nodeTopology(cpu_set_t cpuSet)
 {
@@ -527,14 +626,22 @@ cpuid_init_nodeTopology(cpu_set_t cpuSet)
     int level;
     int prevOffset = 0;
     int currOffset = 0;
-    cpu_set_t set;
     HWThread* hwThreadPool;
     int hasBLeaf = 0;
     int maxNumLogicalProcs;
     int maxNumLogicalProcsPerCore;
     int maxNumCores;
     int width;
+    CpuidProbe* probes;
     hwThreadPool = (HWThread*) malloc(cpuid_topology.numHWThreads * sizeof(HWThread));
+    probes = (CpuidProbe*) calloc(cpuid_topology.numHWThreads, sizeof(CpuidProbe));
+    if ((hwThreadPool == NULL) || (probes == NULL))
+    {
+        ERROR_PLAIN_PRINT(Cannot allocate HW thread list);
+        free(hwThreadPool);
+        free(probes);
+        return;
+    }
     /* check if 0x0B cpuid leaf is supported */
     if (largest_function >= 0x0B)
     {
@@ -548,18 +655,19 @@ cpuid_init_nodeTopology(cpu_set_t cpuSet)
         }
     }
 
+    for (uint32_t i=0; i < cpuid_topology.numHWThreads; i++)
+    {
+        probes[i].cpu = i;
+        probes[i].useBLeaf = hasBLeaf;
+    }
+    probeAllCpuid(probes, cpuid_topology.numHWThreads);
+
     if (hasBLeaf)
     {
         for (uint32_t i=0; i < cpuid_topology.numHWThreads; i++)
         {
             int id;
-            CPU_ZERO(&set);
-            CPU_SET(i,&set);
-            sched_setaffinity(0, sizeof(cpu_set_t), &set);
-            eax = 0x0B;
-            ecx = 0;
-            CPUID(eax, ebx, ecx, edx);
-            apicId = edx;
+            apicId = probes[i].leafB[0][3];
             id = i;
             hwThreadPool[id].apicId = i;
             hwThreadPool[id].inCpuSet = 0;
@@ -570,10 +678,7 @@ cpuid_init_nodeTopology(cpu_set_t cpuSet)
 
             for (level=0; level < 3; level++)
             {
-                eax = 0x0B;
-                ecx = level;
-                CPUID(eax, ebx, ecx, edx);
-                currOffset = eax&0xFU;
+                currOffset = probes[i].leafB[level][0]&0xFU;
 
                 switch ( level ) {
                     case 0:  /* SMT thread */
@@ -628,12 +733,6 @@ cpuid_init_nodeTopology(cpu_set_t cpuSet)
                 for (uint32_t i=0; i<  cpuid_topology.numHWThreads; i++)
                 {
                     int id;
-                    CPU_ZERO(&set);
-                    CPU_SET(i,&set);
-                    sched_setaffinity(0, sizeof(cpu_set_t), &set);
-
-                    eax = 0x01;
-                    CPUID(eax, ebx, ecx, edx);
                     id = i;
                     hwThreadPool[id].apicId = i;//extractBitField(ebx,8,24);
 
@@ -680,14 +779,8 @@ cpuid_init_nodeTopology(cpu_set_t cpuSet)
                 for (uint32_t i=0; i<  cpuid_topology.numHWThreads; i++)
                 {
                     int id;
-                    CPU_ZERO(&set);
-                    CPU_SET(i,&set);
-                    sched_setaffinity(0, sizeof(cpu_set_t), &set);
-
-                    eax = 0x01;
-                    CPUID(eax, ebx, ecx, edx);
-                    id = extractBitField(ebx,8,24);
-                    hwThreadPool[id].apicId = extractBitField(ebx,8,24);
+                    id = extractBitField(probes[i].leaf1Ebx,8,24);
+                    hwThreadPool[id].apicId = extractBitField(probes[i].leaf1Ebx,8,24);
 
                     /* ThreadId is extracted from th apicId using the bit width
                      * of the number of logical processors
@@ -740,14 +833,8 @@ cpuid_init_nodeTopology(cpu_set_t cpuSet)
                 for (uint32_t i=0; i<  cpuid_topology.numHWThreads; i++)
                 {
                     int id;
-                    CPU_ZERO(&set);
-                    CPU_SET(i,&set);
-                    sched_setaffinity(0, sizeof(cpu_set_t), &set);
-
-                    eax = 0x01;
-                    CPUID(eax, ebx, ecx, edx);
-                    id = extractBitField(ebx,8,24);
-                    hwThreadPool[id].apicId = extractBitField(ebx,8,24);
+                    id = extractBitField(probes[i].leaf1Ebx,8,24);
+                    hwThreadPool[id].apicId = extractBitField(probes[i].leaf1Ebx,8,24);
                     /* AMD only knows cores */
                     hwThreadPool[id].threadId = 0;
 
@@ -765,6 +852,7 @@ cpuid_init_nodeTopology(cpu_set_t cpuSet)
                 break;
         }
     }
+    free(probes);
     cpuid_topology.threadPool = hwThreadPool;
     return;
 }
@@ -373,6 +373,7 @@ hwloc_close(void)
     if (hwloc_topology)
     {
         hwloc_topology_destroy(hwloc_topology);
+        hwloc_topology = NULL;
     }
 }
 #else
@@ -190,6 +190,69 @@ fail:
     return 0;
 }
 
+int test_topologyreinit()
+{
+    int i;
+    uint32_t numHWThreads, numSockets, numCacheLevels, numNodes;
+    uint32_t* apicIds = NULL;
+    char* osname = NULL;
+    CpuInfo_t cpuinfo;
+    CpuTopology_t cputopo;
+    NumaTopology_t numainfo;
+    /* The second initialization may be served by the topology cache */
+    if (topology_init() != 0)
+        goto fail;
+    if (numa_init() != 0)
+        goto fail;
+    cpuinfo = get_cpuInfo();
+    cputopo = get_cpuTopology();
+    numainfo = get_numaTopology();
+    numHWThreads = cputopo->numHWThreads;
+    numSockets = cputopo->numSockets;
+    numCacheLevels = cputopo->numCacheLevels;
+    numNodes = numainfo->numberOfNodes;
+    osname = strdup(cpuinfo->osname);
+    apicIds = (uint32_t*) malloc(numHWThreads * sizeof(uint32_t));
+    if ((!osname) || (!apicIds))
+        goto fail;
+    for (i = 0; i < numHWThreads; i++)
+        apicIds[i] = cputopo->threadPool[i].apicId;
+    numa_finalize();
+    topology_finalize();
+
+    if (topology_init() != 0)
+        goto fail;
+    if (numa_init() != 0)
+        goto fail;
+    cpuinfo = get_cpuInfo();
+    cputopo = get_cpuTopology();
+    numainfo = get_numaTopology();
+    if ((cputopo->numHWThreads != numHWThreads) || (cputopo->numSockets != numSockets) ||
+        (cputopo->numCacheLevels != numCacheLevels) || (numainfo->numberOfNodes != numNodes))
+    {
+        if (verbose) printf("Topology differs after reinitialization\n");
+        goto fail;
+    }
+    if ((cpuinfo->osname == NULL) || (strcmp(cpuinfo->osname, osname) != 0))
+        goto fail;
+    for (i = 0; i < numHWThreads; i++)
+    {
+        if (cputopo->threadPool[i].apicId != apicIds[i])
+            goto fail;
+    }
+    free(osname);
+    free(apicIds);
+    numa_finalize();
+    topology_finalize();
+    return 1;
+fail:
+    free(osname);
+    free(apicIds);
+    numa_finalize();
+    topology_finalize();
+    return 0;
+}
+
 int enable_topology()
 {
     topology_init();
@@ -427,6 +490,77 @@ int test_cpustring_combined()
     return 1;
 }
 
+int test_cpustring_placement()
+{
+    int i, j;
+    topology_init();
+    CpuTopology_t cputopo = get_cpuTopology();
+    int len = cputopo->activeHWThreads;
+    int *test = (int*) malloc(len * sizeof(int));
+    if (!test)
+    {
+        return 0;
+    }
+    int ret = cpustr_to_cpulist("P:cores_first:1", test, len);
+    if (ret != 1)
+    {
+        if (verbose) printf("Returned %d for a single CPU\n", ret);
+        goto fail;
+    }
+    ret = cpustr_to_cpulist("P:numa_balanced:1x1", test, len);
+    if (ret != 1)
+    {
+        if (verbose) printf("Returned %d for one rank with one thread\n", ret);
+        goto fail;
+    }
+    ret = cpustr_to_cpulist("P:compact_llc:0", test, len);
+    if (ret > 0)
+    {
+        if (verbose) printf("Returned %d for zero CPUs\n", ret);
+        goto fail;
+    }
+    ret = cpustr_to_cpulist("P:cores_first:x", test, len);
+    if (ret > 0)
+    {
+        if (verbose) printf("Returned %d for an invalid count\n", ret);
+        goto fail;
+    }
+    ret = cpustr_to_cpulist("P:unknown:1", test, len);
+    if (ret > 0)
+    {
+        if (verbose) printf("Returned %d for an unknown policy\n", ret);
+        goto fail;
+    }
+    ret = cpustr_to_cpulist("P:spread_mem:1", test, len);
+    if (ret != 1)
+    {
+        if (verbose) printf("Returned %d for spread_mem\n", ret);
+        goto fail;
+    }
+    /* All active HW threads, each of them once */
+    char expr[64];
+    snprintf(expr, sizeof(expr), "P:cores_first:%d", len);
+    ret = cpustr_to_cpulist(expr, test, len);
+    if (ret != len)
+    {
+        if (verbose) printf("Returned with %d not enough CPUs (%d)\n", ret, len);
+        goto fail;
+    }
+    for (i = 0; i < ret; i++)
+    {
+        for (j = i + 1; j < ret; j++)
+        {
+            if (test[i] == test[j])
+                goto fail;
+        }
+    }
+    free(test);
+    return 1;
+fail:
+    free(test);
+    return 0;
+}
+
 int test_perfmoninit_faulty()
 {
     int cpu = 0;
@@ -1520,6 +1654,68 @@ fail:
     return 0;
 }
 
+int test_perfmonresult_accumulate()
+{
+    CpuInfo_t cpuinfo;
+    int cpu = 0;
+    int group;
+    double first = 0;
+    double last = 0;
+    topology_init();
+    cpuinfo = get_cpuInfo();
+    if (cpuinfo->isIntel == 0)
+    {
+        topology_finalize();
+        return 1;
+    }
+    int ret = perfmon_init(1, &cpu);
+    if (ret != 0)
+        goto fail;
+    /* A rejected event set must not occupy a group */
+    ret = perfmon_addEventSet("NOT_AN_EVENT:PMC0");
+    if (ret >= 0)
+        goto fail;
+    ret = perfmon_addEventSet(eventset_ok);
+    if (ret != 0)
+        goto fail;
+    group = ret;
+    ret = perfmon_setupCounters(group);
+    if (ret != 0)
+        goto fail;
+
+    ret = perfmon_startCounters();
+    if (ret != 0)
+        goto fail;
+    sleep(1);
+    ret = perfmon_stopCounters();
+    if (ret != 0)
+        goto fail;
+    first = perfmon_getLastResult(group,0,0);
+    ret = perfmon_startCounters();
+    if (ret != 0)
+        goto fail;
+    sleep(1);
+    ret = perfmon_stopCounters();
+    if (ret != 0)
+        goto fail;
+    last = perfmon_getLastResult(group,0,0);
+    if ((first <= 0) || (last <= 0))
+        goto fail;
+    /* The full result sums the results of all measurements */
+    if (perfmon_getResult(group,0,0) != first + last)
+    {
+        if (verbose) printf("Result %f is not the sum of %f and %f\n", perfmon_getResult(group,0,0), first, last);
+        goto fail;
+    }
+    perfmon_finalize();
+    topology_finalize();
+    return 1;
+fail:
+    perfmon_finalize();
+    topology_finalize();
+    return 0;
+}
+
 int test_perfmonmetric_noinit()
 {
     double result = perfmon_getMetric(0,0,0);
@@ -2063,6 +2259,7 @@ static test testlist[] = {
     {"Disable configuration", disable_configuration, 1},
     {"Test perfmon initialization without topology information", test_perfmoninit_faulty, 1},
     {"Test topology module initialization", test_topologyinit, 1},
+    {"Test topology module reinitialization", test_topologyreinit, 1},
     {"Test NUMA module initialization", test_numainit, 1},
     {"Test affinity module initialization", test_affinityinit, 1},
     {"Test perfmon initialization with topology information", test_perfmoninit_valid, 1},
@@ -2097,6 +2294,7 @@ static test testlist[] = {
     {"Test perfmon last result without starting", test_perfmonlastresult_nostart, 1},
     {"Test perfmon last result without stopping", test_perfmonlastresult_nostop, 1},
     {"Test perfmon last result", test_perfmonlastresult, 1},
+    {"Test perfmon result of multiple measurements", test_perfmonresult_accumulate, 1},
     {"Test initialization of timer module", test_timerinit, 1},
     {"Test printing time without initialization", test_timerprint_noinit, 1},
     {"Test printing time", test_timerprint, 1},
@@ -2126,6 +2324,7 @@ static test testlist[] = {
     {"Test cpustring with expression input", test_cpustring_expression, 1},
     {"Test cpustring with scatter input", test_cpustring_scatter, 1},
     {"Test cpustring with combined input", test_cpustring_combined, 1},
+    {"Test cpustring with placement input", test_cpustring_placement, 1},
     {NULL, NULL, 0},
 };
 